@@ -29,6 +29,95 @@
 //    - Ratio: 100ns / 10ns = 10 system clocks per TCKC period (MEETS requirement >= 6)
 //    - TCKC toggle every 5 system clocks = 50ns high, 50ns low (MEETS requirement >= 30ns)
 //
+// ADAPTIVE CLOCKING (RTCK):
+//    rtck_o echoes the synchronized TCKC level once every action triggered by
+//    the last TCKC edge has completed: edge detected, state/bit_pos updated and
+//    any resulting TCK rise/fall issued to the TAP.  A host that waits for
+//    rtck_o == TCKC before driving the next edge runs at the fastest rate the
+//    bridge allows instead of assuming the worst case.  Escape sequences are
+//    TMSC-only and are not acknowledged; they keep the fixed timing above.
+//
+// VENDOR EXTENSIONS (opt-in, EC = 4'b1001):
+//    Activating with EC=1001 instead of 1000 selects OScan1 plus vendor
+//    command frames.  In OSCAN1, a TCKC-high period at a packet boundary
+//    (bit_pos=0) with exactly 2 TMSC toggles enters ST_VCMD: the host then
+//    sends an 8-bit opcode (LSB first, sampled on TCKC rising edges like the
+//    activation packet) and the bridge drives the response on TMSC from each
+//    TCKC falling edge, exactly like a TDO slot.  Every frame is a whole
+//    number of packets long and opcodes keep bits 1, 4 and 7 clear, so a
+//    frame whose entry was missed reads as TMS=0 packets (Exit1 -> Pause).
+//    The TAP clock is parked for the whole frame.
+//
+//    VCMD_CRC_READ (0x01): returns {crc_tms, crc_tdi} (32 bits, LSB first)
+//      and restarts both.  crc_tdi/crc_tms are CRC-16/CCITT (0x1021, init
+//      0xFFFF, MSB-first) over the raw nTDI and TMS slot bits sampled since
+//      activation or the last read, so the host can verify what the bridge
+//      actually received and re-shift data (or give up on a TMS error).
+//
+//    VCMD_POLL (0x04): 88 operand bits {limit[7:0], interval[7:0],
+//      offset[7:0], match[31:0], mask[31:0]} (sent mask first), then the
+//      bridge re-runs the last DR scan the host clocked (up to 64 TDI bits,
+//      recorded from the TAP mirror) under the current IR: walk to
+//      Capture-DR, shift the recorded bits, Update, Run-Test/Idle, `interval`
+//      idle TCKs, and again, until TDO bits [offset +: 32] of a scan match
+//      under the mask or `limit` scans have run.  TCKC edges are ignored and
+//      rtck_o is held back meanwhile.  Response: {scans[7:0], TDO window}
+//      (40 bits), so a busy-bit polling loop costs one 138-cycle frame.
+//      Opcode bits keep the missed-entry rule; the operands do not, so a host
+//      only sends POLL after an EC=1001 activation succeeded.
+//
+//    VCMD_VERIFY_ON (0x08): no response.  Starts a verify session: OScan1
+//      packets become 4 slots {nTDI, TMS, EXP, MASK}.  TCK still rises in
+//      slot 2, but the bridge keeps TMSC as an input there: the host drives
+//      the expected TDO bit instead of reading it, then the mask bit in slot
+//      3.  The bridge compares the TDO it would have driven in slot 2 and
+//      keeps a sticky mismatch flag and the index of the first mismatching
+//      packet.  Cleared with vendor extensions when going offline.
+//
+//    VCMD_VERIFY_END (0x0C): returns {mismatch, packets[15:0], first[15:0]}
+//      (33 bits; packets compared and first mismatching packet, both counted
+//      from VERIFY_ON) and ends the session, so verify-heavy flows never
+//      turn TMSC around.  Frame bits keep the 3-slot layout.
+//
+//    VCMD_LOOP_ECHO (0x20) / VCMD_LOOP_PRBS (0x21): no response.  Start a
+//      link loopback session for throughput and bit-error measurements: the
+//      TAP clock stays parked and the TDO slot of every packet returns the
+//      nTDI bit just received (ECHO) or the next bit of a PRBS-15 (x^15 +
+//      x^14 + 1, seeded with all ones; PRBS).  In PRBS mode the host also
+//      sends the same sequence in the nTDI slots and the bridge counts the
+//      slots that differ, so host->bridge and bridge->host errors are told
+//      apart.  TMS slots are ignored.  Ends a verify session (and
+//      VERIFY_ON ends a loopback session); cleared when going offline.
+//
+//    VCMD_LOOP_END (0x24): returns {errors[15:0], packets[23:0]} (40 bits;
+//      nTDI slots that missed the PRBS and packets since the session
+//      started, both saturating) and ends the session.  48-cycle frame.
+//
+// TAP NAVIGATION (vendor extension, same EC opt-in):
+//    The bridge mirrors the 16-state TAP controller from the TMS value of
+//    every TCK it issues.  With vendor extensions, exactly 3 TMSC toggles at
+//    a packet boundary enter ST_GOTO: a 2-packet frame carrying a target TAP
+//    state (jtag_tap.sv encoding, LSB first in frame bits 0, 2, 3 and 5; the
+//    TMS slots 1 and 4 are sent as 0).  After the last bit the bridge clocks
+//    the shortest TMS path to the target itself, one TCK pulse per 2 clk_i
+//    (target Test-Logic-Reset: always 5 x TMS=1), and returns to OSCAN1 at a
+//    packet boundary.  "Go to Shift-DR" or "Update and go to Run-Test/Idle"
+//    thus cost 6 TCKC cycles instead of 3 per TMS step.  The walk ends at
+//    most 18 clk_i cycles after the bridge sees the last rising edge (8
+//    pulses); TCKC edges are ignored until then, so the host holds TCKC high
+//    that long or waits for rtck_o, which is held back for the walk.
+//
+// CONTEXT RETENTION (opt-in, EC bit 1 = 4'b101x):
+//    Activating with EC=1010 (or 1011 with vendor extensions) asks the bridge
+//    to keep the validated activation across a deselection escape.  A later
+//    selection escape of exactly 7 toggles then resumes OSCAN1 directly at a
+//    packet boundary with the same EC, skipping the 12-bit OAC/EC/CP packet:
+//    a target switch costs 4 TCKC periods instead of 16.  6 toggles always
+//    start a full activation (which replaces the context), so hosts that do
+//    not use retention are unaffected.  Reset (8+) and invalid escapes, and
+//    any selection, discard the retained context.  The TAP is not clocked
+//    while deselected, so its state is kept as well.
+//
 // =============================================================================
 
 module cjtag_bridge (
@@ -49,9 +138,108 @@ module cjtag_bridge (
 
     // Status
     output logic online_o,  // 1=online, 0=offline
-    output logic nsp_o      // Standard Protocol indicator
+    output logic nsp_o,     // Standard Protocol indicator
+    output logic rtck_o     // Return clock: TCKC echoed once the edge is fully processed
 );
 
+    // =========================================================================
+    // Runtime Logging (see src/cjtag_log.svh; compiled out under SYNTHESIS)
+    // =========================================================================
+`include "cjtag_log.svh"
+
+`ifndef SYNTHESIS
+    /* verilator lint_off UNUSEDPARAM */
+    localparam int LOGID_TCKC_POSEDGE    = (LOG_CAT_BRIDGE << 8) | 8'h00;
+    localparam int LOGID_TCKC_NEGEDGE    = (LOG_CAT_BRIDGE << 8) | 8'h01;
+    localparam int LOGID_TMSC_TOGGLE     = (LOG_CAT_BRIDGE << 8) | 8'h02;
+    localparam int LOGID_OFFLINE_ESCAPE  = (LOG_CAT_BRIDGE << 8) | 8'h03;
+    localparam int LOGID_ESCAPE_EVAL     = (LOG_CAT_BRIDGE << 8) | 8'h04;
+    localparam int LOGID_ESCAPE_RESET    = (LOG_CAT_BRIDGE << 8) | 8'h05;
+    localparam int LOGID_ESCAPE_SELECT   = (LOG_CAT_BRIDGE << 8) | 8'h06;
+    localparam int LOGID_ESCAPE_DESELECT = (LOG_CAT_BRIDGE << 8) | 8'h07;
+    localparam int LOGID_ESCAPE_INVALID  = (LOG_CAT_BRIDGE << 8) | 8'h08;
+    localparam int LOGID_ACT_EDGE        = (LOG_CAT_BRIDGE << 8) | 8'h09;
+    localparam int LOGID_ACT_ESCAPE      = (LOG_CAT_BRIDGE << 8) | 8'h0A;
+    localparam int LOGID_ACT_BIT         = (LOG_CAT_BRIDGE << 8) | 8'h0B;
+    localparam int LOGID_ACT_PACKET      = (LOG_CAT_BRIDGE << 8) | 8'h0C;
+    localparam int LOGID_ACT_VALID       = (LOG_CAT_BRIDGE << 8) | 8'h0D;
+    localparam int LOGID_ACT_BAD_OAC     = (LOG_CAT_BRIDGE << 8) | 8'h0E;
+    localparam int LOGID_ACT_BAD_EC      = (LOG_CAT_BRIDGE << 8) | 8'h0F;
+    localparam int LOGID_ACT_BAD_CP      = (LOG_CAT_BRIDGE << 8) | 8'h10;
+    localparam int LOGID_OSCAN1_NEGEDGE  = (LOG_CAT_BRIDGE << 8) | 8'h11;
+    localparam int LOGID_OSCAN1_POSEDGE  = (LOG_CAT_BRIDGE << 8) | 8'h12;
+    localparam int LOGID_OSCAN1_ESCAPE   = (LOG_CAT_BRIDGE << 8) | 8'h13;
+    localparam int LOGID_OSCAN1_SAMPLE   = (LOG_CAT_BRIDGE << 8) | 8'h14;
+    localparam int LOGID_OSCAN1_TDI      = (LOG_CAT_BRIDGE << 8) | 8'h15;
+    localparam int LOGID_OSCAN1_TCK_FALL = (LOG_CAT_BRIDGE << 8) | 8'h16;
+    localparam int LOGID_OSCAN1_TCK_RISE = (LOG_CAT_BRIDGE << 8) | 8'h17;
+    localparam int LOGID_STATE_CHANGE    = (LOG_CAT_BRIDGE << 8) | 8'h18;
+    localparam int LOGID_VCMD_ENTER      = (LOG_CAT_BRIDGE << 8) | 8'h19;
+    localparam int LOGID_VCMD_OPCODE     = (LOG_CAT_BRIDGE << 8) | 8'h1A;
+    localparam int LOGID_VCMD_DONE       = (LOG_CAT_BRIDGE << 8) | 8'h1B;
+    localparam int LOGID_VCMD_ESCAPE     = (LOG_CAT_BRIDGE << 8) | 8'h1C;
+    localparam int LOGID_ESCAPE_RESUME   = (LOG_CAT_BRIDGE << 8) | 8'h1D;
+    localparam int LOGID_GOTO_ENTER      = (LOG_CAT_BRIDGE << 8) | 8'h1E;
+    localparam int LOGID_GOTO_WALK       = (LOG_CAT_BRIDGE << 8) | 8'h1F;
+    localparam int LOGID_GOTO_DONE       = (LOG_CAT_BRIDGE << 8) | 8'h20;
+    localparam int LOGID_GOTO_ESCAPE     = (LOG_CAT_BRIDGE << 8) | 8'h21;
+    localparam int LOGID_POLL_START      = (LOG_CAT_BRIDGE << 8) | 8'h22;
+    localparam int LOGID_POLL_DONE       = (LOG_CAT_BRIDGE << 8) | 8'h23;
+    localparam int LOGID_VERIFY_ON       = (LOG_CAT_BRIDGE << 8) | 8'h24;
+    localparam int LOGID_VERIFY_MISMATCH = (LOG_CAT_BRIDGE << 8) | 8'h25;
+    localparam int LOGID_VERIFY_END      = (LOG_CAT_BRIDGE << 8) | 8'h26;
+    localparam int LOGID_LOOP_START      = (LOG_CAT_BRIDGE << 8) | 8'h27;
+    localparam int LOGID_LOOP_END        = (LOG_CAT_BRIDGE << 8) | 8'h28;
+    /* verilator lint_on UNUSEDPARAM */
+
+    initial begin
+        cjtag_log_register(LOGID_TCKC_POSEDGE, LOG_CAT_BRIDGE, "TCKC posedge, toggle count reset");
+        cjtag_log_register(LOGID_TCKC_NEGEDGE, LOG_CAT_BRIDGE, "TCKC negedge, toggle count was %u");
+        cjtag_log_register(LOGID_TMSC_TOGGLE, LOG_CAT_BRIDGE, "Escape: TMSC toggle #%u");
+        cjtag_log_register(LOGID_OFFLINE_ESCAPE, LOG_CAT_BRIDGE, "OFFLINE -> ESCAPE (toggles=%u)");
+        cjtag_log_register(LOGID_ESCAPE_EVAL, LOG_CAT_BRIDGE, "ESCAPE: evaluating toggles=%u from return_state=%u");
+        cjtag_log_register(LOGID_ESCAPE_RESET, LOG_CAT_BRIDGE, "ESCAPE -> OFFLINE (reset: %u toggles)");
+        cjtag_log_register(LOGID_ESCAPE_SELECT, LOG_CAT_BRIDGE, "ESCAPE -> ONLINE_ACT (selection: %u toggles)");
+        cjtag_log_register(LOGID_ESCAPE_DESELECT, LOG_CAT_BRIDGE, "ESCAPE -> OFFLINE (deselection: %u toggles)");
+        cjtag_log_register(LOGID_ESCAPE_INVALID, LOG_CAT_BRIDGE, "ESCAPE -> OFFLINE (invalid sequence: %u toggles)");
+        cjtag_log_register(LOGID_ACT_EDGE, LOG_CAT_BRIDGE,
+                           "ONLINE_ACT: negedge=%u posedge=%u activation_count=%u tmsc_s=%u");
+        cjtag_log_register(LOGID_ACT_ESCAPE, LOG_CAT_BRIDGE, "ONLINE_ACT -> ESCAPE (toggles=%u)");
+        cjtag_log_register(LOGID_ACT_BIT, LOG_CAT_BRIDGE, "ONLINE_ACT: bit %u, tmsc_s=%u");
+        cjtag_log_register(LOGID_ACT_PACKET, LOG_CAT_BRIDGE,
+                           "Activation packet 0x%03x: OAC=0x%x (expect 0xc) EC=0x%x (expect 0x8-0xb) CP=0x%x");
+        cjtag_log_register(LOGID_ACT_VALID, LOG_CAT_BRIDGE, "ONLINE_ACT -> OSCAN1 (activation packet valid, EC=0x%x)");
+        cjtag_log_register(LOGID_ACT_BAD_OAC, LOG_CAT_BRIDGE, "ONLINE_ACT -> OFFLINE (invalid OAC: 0x%x)");
+        cjtag_log_register(LOGID_ACT_BAD_EC, LOG_CAT_BRIDGE, "ONLINE_ACT -> OFFLINE (invalid EC: 0x%x)");
+        cjtag_log_register(LOGID_ACT_BAD_CP, LOG_CAT_BRIDGE, "ONLINE_ACT -> OFFLINE (invalid CP: 0x%x, expected 0x%x)");
+        cjtag_log_register(LOGID_OSCAN1_NEGEDGE, LOG_CAT_BRIDGE, "OSCAN1 negedge: toggles=%u, bit_pos=%u");
+        cjtag_log_register(LOGID_OSCAN1_POSEDGE, LOG_CAT_BRIDGE, "OSCAN1 posedge: toggles=%u, bit_pos=%u");
+        cjtag_log_register(LOGID_OSCAN1_ESCAPE, LOG_CAT_BRIDGE, "OSCAN1 -> ESCAPE (toggles=%u)");
+        cjtag_log_register(LOGID_OSCAN1_SAMPLE, LOG_CAT_BRIDGE, "OSCAN1 sample: bit_pos=%u, tmsc_s=%u");
+        cjtag_log_register(LOGID_OSCAN1_TDI, LOG_CAT_BRIDGE, "OSCAN1 bit_pos=1: tdi_int=%u (inverted from %u)");
+        cjtag_log_register(LOGID_OSCAN1_TCK_FALL, LOG_CAT_BRIDGE, "OSCAN1 bit_pos=2: TCK fall scheduled, tms_int=%u");
+        cjtag_log_register(LOGID_OSCAN1_TCK_RISE, LOG_CAT_BRIDGE,
+                           "OSCAN1 bit_pos=2: tms_int->%u, TCK rise + TDO window open");
+        cjtag_log_register(LOGID_STATE_CHANGE, LOG_CAT_BRIDGE, "State change: %u -> %u");
+        cjtag_log_register(LOGID_VCMD_ENTER, LOG_CAT_BRIDGE, "OSCAN1 -> VCMD (2-toggle vendor escape)");
+        cjtag_log_register(LOGID_VCMD_OPCODE, LOG_CAT_BRIDGE, "VCMD opcode 0x%02x, response 0x%08x");
+        cjtag_log_register(LOGID_VCMD_DONE, LOG_CAT_BRIDGE, "VCMD -> OSCAN1 (opcode 0x%02x, %u frame bits)");
+        cjtag_log_register(LOGID_VCMD_ESCAPE, LOG_CAT_BRIDGE, "VCMD -> ESCAPE (toggles=%u)");
+        cjtag_log_register(LOGID_ESCAPE_RESUME, LOG_CAT_BRIDGE, "ESCAPE -> OSCAN1 (resumed retained context, EC=0x%x)");
+        cjtag_log_register(LOGID_GOTO_ENTER, LOG_CAT_BRIDGE, "OSCAN1 -> GOTO (3-toggle vendor escape)");
+        cjtag_log_register(LOGID_GOTO_WALK, LOG_CAT_BRIDGE, "GOTO target TAP state 0x%x from 0x%x");
+        cjtag_log_register(LOGID_GOTO_DONE, LOG_CAT_BRIDGE, "GOTO -> OSCAN1 (TAP state 0x%x after %u TCK pulses)");
+        cjtag_log_register(LOGID_GOTO_ESCAPE, LOG_CAT_BRIDGE, "GOTO -> ESCAPE (toggles=%u)");
+        cjtag_log_register(LOGID_POLL_START, LOG_CAT_BRIDGE, "VCMD POLL: %u-bit DR scan, limit %u, interval %u");
+        cjtag_log_register(LOGID_POLL_DONE, LOG_CAT_BRIDGE, "VCMD POLL done after %u scans, TDO window 0x%08x");
+        cjtag_log_register(LOGID_VERIFY_ON, LOG_CAT_BRIDGE, "VCMD VERIFY_ON: 4-slot verify packets");
+        cjtag_log_register(LOGID_VERIFY_MISMATCH, LOG_CAT_BRIDGE, "VERIFY mismatch at packet %u: TDO=%u, expected %u");
+        cjtag_log_register(LOGID_VERIFY_END, LOG_CAT_BRIDGE, "VCMD VERIFY_END: %u packets, mismatch=%u, first at %u");
+        cjtag_log_register(LOGID_LOOP_START, LOG_CAT_BRIDGE, "VCMD LOOP: loopback mode %u (1=echo, 2=PRBS-15)");
+        cjtag_log_register(LOGID_LOOP_END, LOG_CAT_BRIDGE, "VCMD LOOP_END: %u packets, %u PRBS errors");
+    end
+`endif
+
     // =========================================================================
     // State Machine States
     // =========================================================================
@@ -59,10 +247,13 @@ module cjtag_bridge (
         ST_OFFLINE    = 3'b000,
         ST_ESCAPE     = 3'b001,
         ST_ONLINE_ACT = 3'b010,
-        ST_OSCAN1     = 3'b011
+        ST_OSCAN1     = 3'b011,
+        ST_VCMD       = 3'b100,  // Vendor command frame (EC=1001 only)
+        ST_GOTO       = 3'b101   // TAP navigation frame (EC=1001 only)
     } state_t;
 
-    state_t        state;
+    // Signals tagged public_flat_rd are read-only probes for tb/cjtag_probe.h
+    state_t        state  /*verilator public_flat_rd*/;
 
     // =========================================================================
     // Input Synchronizers (2-stage for metastability)
@@ -82,14 +273,60 @@ module cjtag_bridge (
     // =========================================================================
     // State Machine and Control Registers
     // =========================================================================
-    logic   [ 4:0] tmsc_toggle_count;  // TMSC toggle counter for escape sequences
+    logic   [ 4:0] tmsc_toggle_count  /*verilator public_flat_rd*/;  // TMSC toggle counter for escape sequences
     logic          tckc_is_high;       // TCKC currently held high
-    state_t        return_state;       // State to evaluate after escape sequence
-
-    logic   [10:0] activation_shift;  // Activation packet shift register (11 bits, 12th bit in tmsc_s)
-    logic   [ 3:0] activation_count;  // Bit counter for activation packet (0-11)
-    logic   [ 1:0] bit_pos;           // Position in 3-bit OScan1 packet
-    logic          tmsc_sampled;      // TMSC sampled on TCKC negedge
+    state_t        return_state  /*verilator public_flat_rd*/;  // State to evaluate after escape sequence
+
+    logic   [10:0] activation_shift  /*verilator public_flat_rd*/;  // Activation packet shift register (11 bits, 12th bit in tmsc_s)
+    logic   [ 3:0] activation_count  /*verilator public_flat_rd*/;  // Bit counter for activation packet (0-11)
+    logic   [ 1:0] bit_pos           /*verilator public_flat_rd*/;  // Position in 3-bit OScan1 packet
+    logic          tmsc_sampled      /*verilator public_flat_rd*/;  // TMSC sampled on TCKC negedge
+
+    // Vendor extensions (EC=1001)
+    logic          vext_en     /*verilator public_flat_rd*/;  // Activated with EC=1001
+    logic   [ 7:0] vcmd_count  /*verilator public_flat_rd*/;  // TCKC cycles into the vendor frame
+    logic   [ 7:0] vcmd_op     /*verilator public_flat_rd*/;  // Opcode (LSB first)
+    logic   [39:0] vcmd_resp;         // Response shift register (LSB first)
+    logic   [15:0] crc_tdi     /*verilator public_flat_rd*/;  // CRC-16 of received nTDI bits
+    logic   [15:0] crc_tms     /*verilator public_flat_rd*/;  // CRC-16 of received TMS bits
+
+    // Context retention (EC bit 1)
+    logic          retain_en   /*verilator public_flat_rd*/;  // Activated with EC=101x
+    logic          ctx_valid   /*verilator public_flat_rd*/;  // Deselected with a retained context
+    logic          ctx_vext    /*verilator public_flat_rd*/;  // vext_en to restore on resume
+
+    // TAP navigation
+    logic   [ 3:0] tap_mirror  /*verilator public_flat_rd*/;  // TAP state as of the last TCK issued
+    logic   [ 2:0] goto_count  /*verilator public_flat_rd*/;  // Frame bit 0-5, 6 = walking
+    logic   [ 3:0] goto_tgt    /*verilator public_flat_rd*/;  // Target TAP state (LSB first)
+    logic   [ 3:0] goto_steps  /*verilator public_flat_rd*/;  // TCK pulses issued by this walk
+    logic          goto_done;      // Walk complete: TCK low and target reached
+
+    // DR polling (VCMD_POLL)
+    logic   [63:0] scan_tdi    /*verilator public_flat_rd*/;  // TDI bits of the last host DR scan
+    logic   [ 6:0] scan_len    /*verilator public_flat_rd*/;  // Bits recorded (65 = too long to replay)
+    logic   [87:0] poll_arg;       // Operands, LSB first: mask, match, offset, interval, limit
+    logic   [87:0] poll_arg_next;  // poll_arg with this cycle's TMSC bit shifted in
+    logic   [ 2:0] poll_phase  /*verilator public_flat_rd*/;  // POLL_OFF .. POLL_DONE
+    logic   [ 7:0] poll_cnt    /*verilator public_flat_rd*/;  // Shift bit / idle TCK counter
+    logic   [ 7:0] poll_tries  /*verilator public_flat_rd*/;  // Scans run so far
+    logic   [31:0] poll_tdo    /*verilator public_flat_rd*/;  // TDO bits [offset +: 32] of the last scan
+    logic          poll_done;      // Poll complete: TCK low, response ready
+
+    // TDO verification (VCMD_VERIFY_ON / VCMD_VERIFY_END)
+    logic          verify_en    /*verilator public_flat_rd*/;  // 4-slot verify packets
+    logic          verify_exp;                                 // Expected TDO from slot 2
+    logic          verify_tdo;                                 // TDO seen in slot 2
+    logic          verify_fail  /*verilator public_flat_rd*/;  // Sticky mismatch
+    logic   [15:0] verify_count /*verilator public_flat_rd*/;  // Packets compared
+    logic   [15:0] verify_first /*verilator public_flat_rd*/;  // First mismatching packet
+
+    // Link loopback (VCMD_LOOP_ECHO / VCMD_LOOP_PRBS / VCMD_LOOP_END)
+    logic   [ 1:0] loop_mode   /*verilator public_flat_rd*/;  // LOOP_OFF, LOOP_ECHO, LOOP_PRBS
+    logic   [14:0] loop_prbs   /*verilator public_flat_rd*/;  // PRBS-15 state, bit 14 is next
+    logic          loop_bit;       // Returned in this packet's TDO slot
+    logic   [23:0] loop_count  /*verilator public_flat_rd*/;  // Packets since the session started
+    logic   [15:0] loop_errors /*verilator public_flat_rd*/;  // nTDI slots that missed the PRBS
 
     // JTAG outputs (registered)
     logic          tck_int;
@@ -98,12 +335,166 @@ module cjtag_bridge (
     logic          tmsc_oen_int;  // TMSC output enable (registered)
     logic          tck_rise_req;  // One-cycle pulse: raise TCK next cycle
     logic          tck_fall_req;  // One-cycle pulse: lower TCK next cycle (after DTS samples TDO)
+    logic          rtck_int;      // Return clock (registered)
 
-`ifdef VERBOSE
-    // Debug state tracking
-    logic [2:0] prev_state;  // Previous state for change detection
+`ifndef SYNTHESIS
+    // State change monitor (runtime log only)
+    logic [2:0] prev_state;
 `endif
 
+    // =========================================================================
+    // Vendor Command Frames
+    // =========================================================================
+    localparam logic [7:0] VCMD_CRC_READ   = 8'h01;
+    localparam logic [7:0] VCMD_POLL       = 8'h04;
+    localparam logic [7:0] VCMD_VERIFY_ON  = 8'h08;
+    localparam logic [7:0] VCMD_VERIFY_END = 8'h0C;
+    localparam logic [7:0] VCMD_LOOP_ECHO  = 8'h20;
+    localparam logic [7:0] VCMD_LOOP_PRBS  = 8'h21;
+    localparam logic [7:0] VCMD_LOOP_END   = 8'h24;
+
+    localparam logic [1:0]  LOOP_OFF       = 2'd0;
+    localparam logic [1:0]  LOOP_ECHO      = 2'd1;
+    localparam logic [1:0]  LOOP_PRBS      = 2'd2;
+    localparam logic [14:0] LOOP_PRBS_SEED = 15'h7FFF;
+
+    localparam logic [15:0] CRC16_INIT = 16'hFFFF;
+    localparam logic [15:0] CRC16_POLY = 16'h1021;
+
+    function automatic logic [15:0] crc16_step(input logic [15:0] crc, input logic bit_in);
+        crc16_step = {crc[14:0], 1'b0} ^ ((crc[15] ^ bit_in) ? CRC16_POLY : 16'h0000);
+    endfunction
+
+    // Operand bits sent by the host after the opcode
+    function automatic logic [7:0] vcmd_arg_bits(input logic [7:0] op);
+        case (op)
+            VCMD_POLL: vcmd_arg_bits = 8'd88;
+            default:   vcmd_arg_bits = 8'd0;
+        endcase
+    endfunction
+
+    // Response bits driven by the bridge after the operands
+    function automatic logic [7:0] vcmd_resp_bits(input logic [7:0] op);
+        case (op)
+            VCMD_CRC_READ:   vcmd_resp_bits = 8'd32;
+            VCMD_POLL:       vcmd_resp_bits = 8'd40;
+            VCMD_VERIFY_END: vcmd_resp_bits = 8'd33;
+            VCMD_LOOP_END:   vcmd_resp_bits = 8'd40;
+            default:         vcmd_resp_bits = 8'd0;
+        endcase
+    endfunction
+
+    // Whole frame in TCKC cycles, padded to a multiple of 3 (one OScan1 packet)
+    function automatic logic [7:0] vcmd_frame_len(input logic [7:0] op);
+        case (op)
+            VCMD_CRC_READ:   vcmd_frame_len = 8'd42;   // 8 + 32, +2 pad
+            VCMD_POLL:       vcmd_frame_len = 8'd138;  // 8 + 88 + 40, +2 pad
+            VCMD_VERIFY_END: vcmd_frame_len = 8'd42;   // 8 + 33, +1 pad
+            VCMD_LOOP_END:   vcmd_frame_len = 8'd48;   // 8 + 40
+            default:         vcmd_frame_len = 8'd9;    // unknown: opcode + 1 pad
+        endcase
+    endfunction
+
+    // =========================================================================
+    // TAP Navigation
+    // =========================================================================
+    localparam logic [3:0] TAP_TEST_LOGIC_RESET = 4'h0;
+    localparam logic [2:0] GOTO_WALKING         = 3'd6;
+
+    // IEEE 1149.1 TAP next state (jtag_tap.sv encoding)
+    function automatic logic [3:0] tap_next(input logic [3:0] s, input logic tms);
+        case (s)
+            4'h0: tap_next = tms ? 4'h0 : 4'h1;  // TEST_LOGIC_RESET
+            4'h1: tap_next = tms ? 4'h2 : 4'h1;  // RUN_TEST_IDLE
+            4'h2: tap_next = tms ? 4'h9 : 4'h3;  // SELECT_DR_SCAN
+            4'h3: tap_next = tms ? 4'h5 : 4'h4;  // CAPTURE_DR
+            4'h4: tap_next = tms ? 4'h5 : 4'h4;  // SHIFT_DR
+            4'h5: tap_next = tms ? 4'h8 : 4'h6;  // EXIT1_DR
+            4'h6: tap_next = tms ? 4'h7 : 4'h6;  // PAUSE_DR
+            4'h7: tap_next = tms ? 4'h8 : 4'h4;  // EXIT2_DR
+            4'h8: tap_next = tms ? 4'h2 : 4'h1;  // UPDATE_DR
+            4'h9: tap_next = tms ? 4'h0 : 4'hA;  // SELECT_IR_SCAN
+            4'hA: tap_next = tms ? 4'hC : 4'hB;  // CAPTURE_IR
+            4'hB: tap_next = tms ? 4'hC : 4'hB;  // SHIFT_IR
+            4'hC: tap_next = tms ? 4'hF : 4'hD;  // EXIT1_IR
+            4'hD: tap_next = tms ? 4'hE : 4'hD;  // PAUSE_IR
+            4'hE: tap_next = tms ? 4'hF : 4'hB;  // EXIT2_IR
+            default: tap_next = tms ? 4'h2 : 4'h1;  // UPDATE_IR
+        endcase
+    endfunction
+
+    // TMS of the first step of the shortest path from s to tgt (no ties
+    // exist; at most 8 steps).  Bit tgt of each mask is the TMS value.
+    function automatic logic goto_tms(input logic [3:0] s, input logic [3:0] tgt);
+        logic [15:0] mask;
+        case (s)
+            4'h0: mask = 16'h0000;
+            4'h1: mask = 16'hFFFD;
+            4'h2: mask = 16'hFE03;
+            4'h3: mask = 16'hFFE7;
+            4'h4: mask = 16'hFFEF;
+            4'h5: mask = 16'hFF0F;
+            4'h6: mask = 16'hFFBF;
+            4'h7: mask = 16'hFF0F;
+            4'h8: mask = 16'hFEFD;
+            4'h9: mask = 16'h01FF;
+            4'hA: mask = 16'hF3FF;
+            4'hB: mask = 16'hF7FF;
+            4'hC: mask = 16'h87FF;
+            4'hD: mask = 16'hDFFF;
+            4'hE: mask = 16'h87FF;
+            default: mask = 16'h7FFD;
+        endcase
+        // Test-Logic-Reset is reached by 5 x TMS=1 whatever the mirror says
+        goto_tms = (tgt == TAP_TEST_LOGIC_RESET) ? 1'b1 : mask[tgt];
+    endfunction
+
+    assign goto_done = !tck_int && ((goto_tgt == TAP_TEST_LOGIC_RESET) ? (goto_steps == 4'd5)
+                                                                       : (tap_mirror == goto_tgt));
+
+    // =========================================================================
+    // DR Polling (VCMD_POLL)
+    // =========================================================================
+    // While vendor extensions are on, every host TCK in Shift-DR records its
+    // TDI bit; Capture-DR starts a new recording.  The poll engine in the
+    // output block replays it one TCK per 2 clk_i, like a GOTO walk:
+    //   NAV    shortest path to Capture-DR
+    //   SHIFT  capture, then scan_len shift TCKs (TMS=1 on the last); TDO is
+    //          sampled before each shift edge, as the host would
+    //   RETURN Exit1 -> Update -> Run-Test/Idle, then check the window
+    //   WAIT   `interval` TCKs in Run-Test/Idle, then NAV again
+    localparam logic [3:0] TAP_RUN_TEST_IDLE = 4'h1;
+    localparam logic [3:0] TAP_CAPTURE_DR    = 4'h3;
+    localparam logic [3:0] TAP_SHIFT_DR      = 4'h4;
+    localparam logic [6:0] POLL_SCAN_MAX     = 7'd64;
+    localparam logic [7:0] POLL_RUN_AT       = 8'd95;  // last operand bit
+
+    localparam logic [2:0] POLL_OFF    = 3'd0;
+    localparam logic [2:0] POLL_NAV    = 3'd1;
+    localparam logic [2:0] POLL_SHIFT  = 3'd2;
+    localparam logic [2:0] POLL_RETURN = 3'd3;
+    localparam logic [2:0] POLL_WAIT   = 3'd4;
+    localparam logic [2:0] POLL_DONE   = 3'd5;
+
+    logic [31:0] poll_mask, poll_match;
+    logic [ 7:0] poll_offset, poll_interval, poll_limit;
+    logic [ 7:0] poll_win_idx;  // TDO window bit of shift bit poll_cnt
+
+    assign {poll_limit, poll_interval, poll_offset, poll_match, poll_mask} = poll_arg;
+    assign poll_win_idx  = poll_cnt - poll_offset;
+    assign poll_arg_next = {tmsc_s, poll_arg[87:1]};
+    assign poll_done     = (poll_phase == POLL_DONE) && !tck_int;
+
+    // TMS for the next engine TCK, from the state after the last one
+    function automatic logic poll_tms(input logic [2:0] phase, input logic [3:0] s, input logic last);
+        case (phase)
+            POLL_NAV:    poll_tms = goto_tms(s, TAP_CAPTURE_DR);
+            POLL_SHIFT:  poll_tms = (s == TAP_SHIFT_DR) && last;
+            POLL_RETURN: poll_tms = goto_tms(s, TAP_RUN_TEST_IDLE);
+            default:     poll_tms = 1'b0;
+        endcase
+    endfunction
+
     // =========================================================================
     // Input Synchronizers - 2-stage for metastability protection
     // =========================================================================
@@ -164,26 +555,20 @@ module cjtag_bridge (
                 tckc_is_high      <= 1'b1;
                 tmsc_toggle_count <= 5'd0;  // Reset counter on TCKC rising edge
 
-`ifdef VERBOSE
-                $display("[%0t] TCKC POSEDGE detected! Resetting toggle count", $time);
-`endif
+                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_TRACE, LOGID_TCKC_POSEDGE, 0, 0, 0, 0);
             end
             // Track TCKC going low (escape sequence ends)
             else if (tckc_negedge) begin
                 tckc_is_high <= 1'b0;
 
-`ifdef VERBOSE
-                $display("[%0t] TCKC NEGEDGE detected! Toggle count was %0d", $time, tmsc_toggle_count);
-`endif
+                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_TRACE, LOGID_TCKC_NEGEDGE, tmsc_toggle_count, 0, 0, 0);
             end
             // TCKC is held high - monitor TMSC toggles
             else if (tckc_is_high && tckc_s && tmsc_edge) begin
                 // Count TMSC toggles while TCKC is high
                 tmsc_toggle_count <= tmsc_toggle_count + 5'd1;
 
-`ifdef VERBOSE
-                $display("[%0t] Escape: TMSC toggle #%0d detected", $time, tmsc_toggle_count + 5'd1);
-`endif
+                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_TMSC_TOGGLE, tmsc_toggle_count + 5'd1, 0, 0, 0);
             end
         end
     end
@@ -199,6 +584,29 @@ module cjtag_bridge (
             activation_count  <= 4'd0;
             bit_pos           <= 2'd0;
             tmsc_sampled      <= 1'b0;
+            vext_en           <= 1'b0;
+            vcmd_count        <= 8'd0;
+            vcmd_op           <= 8'd0;
+            vcmd_resp         <= 40'd0;
+            poll_arg          <= 88'd0;
+            crc_tdi           <= CRC16_INIT;
+            crc_tms           <= CRC16_INIT;
+            retain_en         <= 1'b0;
+            ctx_valid         <= 1'b0;
+            ctx_vext          <= 1'b0;
+            goto_count        <= 3'd0;
+            goto_tgt          <= 4'd0;
+            verify_en         <= 1'b0;
+            verify_exp        <= 1'b0;
+            verify_tdo        <= 1'b0;
+            verify_fail       <= 1'b0;
+            verify_count      <= 16'd0;
+            verify_first      <= 16'd0;
+            loop_mode         <= LOOP_OFF;
+            loop_prbs         <= 15'd0;
+            loop_bit          <= 1'b0;
+            loop_count        <= 24'd0;
+            loop_errors       <= 16'd0;
         end
         else begin
             case (state)
@@ -206,14 +614,17 @@ module cjtag_bridge (
                 // OFFLINE: Wait for escape sequence
                 // =============================================================
                 ST_OFFLINE: begin
+                    vext_en   <= 1'b0;
+                    retain_en <= 1'b0;
+                    verify_en <= 1'b0;
+                    loop_mode <= LOOP_OFF;
+
                     // Check for escape sequence on TCKC falling edge
                     if (tckc_negedge && tmsc_toggle_count >= 5'd4) begin
                         return_state <= ST_OFFLINE;
                         state        <= ST_ESCAPE;
 
-`ifdef VERBOSE
-                        $display("[%0t] OFFLINE -> ESCAPE (toggles=%0d)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_OFFLINE_ESCAPE, tmsc_toggle_count, 0, 0, 0);
                     end
                 end
 
@@ -221,10 +632,7 @@ module cjtag_bridge (
                 // ESCAPE: Evaluate escape sequence and transition
                 // =============================================================
                 ST_ESCAPE: begin
-`ifdef VERBOSE
-                    $display("[%0t] ESCAPE: Evaluating toggles=%0d from return_state=%0d", $time, tmsc_toggle_count,
-                             return_state);
-`endif
+                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_ESCAPE_EVAL, tmsc_toggle_count, return_state, 0, 0);
 
                     // Reset escape (8+ toggles) - always goes to OFFLINE
                     if (tmsc_toggle_count >= 5'd8) begin
@@ -232,20 +640,30 @@ module cjtag_bridge (
                         activation_shift <= 11'd0;
                         activation_count <= 4'd0;
                         bit_pos          <= 2'd0;
+                        ctx_valid        <= 1'b0;
 
-`ifdef VERBOSE
-                        $display("[%0t] ESCAPE -> OFFLINE (reset: %0d toggles)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ESCAPE_RESET, tmsc_toggle_count, 0, 0, 0);
+                    end
+                    // Resume (7 toggles with a retained context) - OFFLINE -> OSCAN1
+                    else if (tmsc_toggle_count == 5'd7 && return_state == ST_OFFLINE && ctx_valid) begin
+                        state     <= ST_OSCAN1;
+                        bit_pos   <= 2'd0;
+                        vext_en   <= ctx_vext;
+                        retain_en <= 1'b1;
+                        ctx_valid <= 1'b0;
+                        crc_tdi   <= CRC16_INIT;
+                        crc_tms   <= CRC16_INIT;
+
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ESCAPE_RESUME, {2'b10, 1'b1, ctx_vext}, 0, 0, 0);
                     end
                     // Selection escape (6-7 toggles) - OFFLINE -> ONLINE_ACT
                     else if (tmsc_toggle_count >= 5'd6 && tmsc_toggle_count <= 5'd7 && return_state == ST_OFFLINE) begin
                         state            <= ST_ONLINE_ACT;
                         activation_shift <= 11'd0;
                         activation_count <= 4'd0;
+                        ctx_valid        <= 1'b0;
 
-`ifdef VERBOSE
-                        $display("[%0t] ESCAPE -> ONLINE_ACT (selection: %0d toggles)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ESCAPE_SELECT, tmsc_toggle_count, 0, 0, 0);
                     end
                     // Deselection escape (4-5 toggles) - OSCAN1 -> OFFLINE
                     else if (tmsc_toggle_count >= 5'd4 && tmsc_toggle_count <= 5'd5 && return_state == ST_OSCAN1) begin
@@ -253,10 +671,10 @@ module cjtag_bridge (
                         activation_shift <= 11'd0;
                         activation_count <= 4'd0;
                         bit_pos          <= 2'd0;
+                        ctx_valid        <= retain_en;  // Keep the activation for a 7-toggle resume
+                        ctx_vext         <= vext_en;
 
-`ifdef VERBOSE
-                        $display("[%0t] ESCAPE -> OFFLINE (deselection: %0d toggles)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ESCAPE_DESELECT, tmsc_toggle_count, 0, 0, 0);
                     end
                     // Invalid escape sequence - force offline
                     else begin
@@ -264,10 +682,9 @@ module cjtag_bridge (
                         activation_shift <= 11'd0;
                         activation_count <= 4'd0;
                         bit_pos          <= 2'd0;
+                        ctx_valid        <= 1'b0;
 
-`ifdef VERBOSE
-                        $display("[%0t] ESCAPE -> OFFLINE (invalid sequence: %0d toggles)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ESCAPE_INVALID, tmsc_toggle_count, 0, 0, 0);
                     end
                 end
 
@@ -276,12 +693,10 @@ module cjtag_bridge (
                 // OAC = 0xC (1100 binary, LSB first: 0,0,1,1)
                 // =============================================================
                 ST_ONLINE_ACT: begin
-`ifdef VERBOSE
-                    // Debug every clock cycle in ONLINE_ACT
+`ifndef SYNTHESIS
+                    // Every TCKC edge in ONLINE_ACT
                     if (tckc_negedge || tckc_posedge) begin
-                        $display(
-                            "[%0t] ONLINE_ACT: tckc_negedge=%b tckc_posedge=%b activation_count=%0d tckc_s=%b tmsc_s=%b",
-                            $time, tckc_negedge, tckc_posedge, activation_count, tckc_s, tmsc_s);
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_TRACE, LOGID_ACT_EDGE, tckc_negedge, tckc_posedge, activation_count, tmsc_s);
                     end
 `endif
 
@@ -292,18 +707,14 @@ module cjtag_bridge (
                         activation_shift <= 11'd0;
                         activation_count <= 4'd0;
 
-`ifdef VERBOSE
-                        $display("[%0t] ONLINE_ACT -> ESCAPE (toggles=%0d)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ACT_ESCAPE, tmsc_toggle_count, 0, 0, 0);
                     end
                     // Sample TMSC on TCKC rising edge (data driven by DTS on falling,
                     // stable and valid on rising edge per IEEE 1149.7)
                     else if (tckc_posedge) begin
                         activation_shift <= {tmsc_s, activation_shift[10:1]};
 
-`ifdef VERBOSE
-                        $display("[%0t] ONLINE_ACT: bit %0d, tmsc_s=%b", $time, activation_count, tmsc_s);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_ACT_BIT, activation_count, tmsc_s, 0, 0);
 
                         // After 12 bits (count 0-11), check the full activation packet
                         // Format: OAC (4 bits) + EC (4 bits) + CP (4 bits) - all LSB first
@@ -313,21 +724,13 @@ module cjtag_bridge (
                             // Packet: {tmsc_s, activation_shift[10:0]}
                             // OAC: bits [3:0], EC: bits [7:4], CP: bits [11:8]
 
-`ifdef VERBOSE
-                            $display("[%0t] Checking activation packet:", $time);
-                            $display("    Full packet: %b", {tmsc_s, activation_shift[10:0]});
-                            $display("    OAC=%b (expected=1100), EC=%b (expected=1000), CP=%b",
-                                     activation_shift[3:0], activation_shift[7:4], {
-                                     tmsc_s, activation_shift[10:8]});
-                            $display("    Calculated CP=%b, CP valid=%b",
-                                     activation_shift[3:0] ^ activation_shift[7:4],
-                                     {tmsc_s, activation_shift[10:8]} == (activation_shift[3:0] ^ activation_shift[7:4]));
-`endif
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_ACT_PACKET, {tmsc_s, activation_shift[10:0]}, activation_shift[3:0], activation_shift[7:4], {tmsc_s, activation_shift[10:8]});
 
                             // Validate activation packet:
                             // - OAC must be 4'b1100 (select JTAG TAP)
-                            // - EC must be 4'b1000 (enable OScan1)
-                            // - CP should be OAC^EC = 4'b0100 per IEEE 1149.7
+                            // - EC must be 4'b10RV: OScan1, plus context retention (R)
+                            //   and vendor command frames (V), see header
+                            // - CP should be OAC^EC per IEEE 1149.7
                             //
                             // CP CHECK COMPATIBILITY:
                             // OpenOCD ftdi.c sends CP=0x0 (bug), but real ARM hardware accepts it.
@@ -335,44 +738,50 @@ module cjtag_bridge (
                             // Define CJTAG_STRICT_CP_CHECK to enable strict IEEE 1149.7 compliance.
 `ifdef CJTAG_STRICT_CP_CHECK
                             if (activation_shift[3:0] == 4'b1100 &&
-                                activation_shift[7:4] == 4'b1000 &&
+                                activation_shift[7:6] == 2'b10 &&
                                 {tmsc_s, activation_shift[10:8]} == (activation_shift[3:0] ^ activation_shift[7:4])) begin
 
-                                state   <= ST_OSCAN1;
-                                bit_pos <= 2'd0;
-`ifdef VERBOSE
-                                $display("[%0t] ONLINE_ACT -> OSCAN1 (activation packet valid!)", $time);
-`endif
+                                state     <= ST_OSCAN1;
+                                bit_pos   <= 2'd0;
+                                vext_en   <= activation_shift[4];  // EC=10x1: vendor extensions
+                                retain_en <= activation_shift[5];  // EC=101x: context retention
+                                crc_tdi <= CRC16_INIT;
+                                crc_tms <= CRC16_INIT;
+                                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ACT_VALID, activation_shift[7:4], 0, 0, 0);
                             end
                             else begin
                                 state <= ST_OFFLINE;
-`ifdef VERBOSE
+`ifndef SYNTHESIS
                                 if (activation_shift[3:0] != 4'b1100) begin
-                                     $display("[%0t] ONLINE_ACT -> OFFLINE (invalid OAC: %b)", $time,
-                                             activation_shift[3:0]);
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ACT_BAD_OAC, activation_shift[3:0], 0, 0, 0);
+                                end
+                                else if (activation_shift[7:6] != 2'b10) begin
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ACT_BAD_EC, activation_shift[7:4], 0, 0, 0);
                                 end
                                 else begin
-                                     $display("[%0t] ONLINE_ACT -> OFFLINE (invalid EC: %b)", $time, activation_shift[7:4]);
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ACT_BAD_CP, {tmsc_s, activation_shift[10:8]}, activation_shift[3:0] ^ activation_shift[7:4], 0, 0);
                                 end
 `endif
                             end
 `else
-                            if (activation_shift[3:0] == 4'b1100 && activation_shift[7:4] == 4'b1000) begin
-                                state   <= ST_OSCAN1;
-                                bit_pos <= 2'd0;
-`ifdef VERBOSE
-                                $display("[%0t] ONLINE_ACT -> OSCAN1 (activation packet valid!)", $time);
-`endif
+                            // EC=10RV: OScan1 with optional retention / vendor extensions
+                            if (activation_shift[3:0] == 4'b1100 && activation_shift[7:6] == 2'b10) begin
+                                state     <= ST_OSCAN1;
+                                bit_pos   <= 2'd0;
+                                vext_en   <= activation_shift[4];
+                                retain_en <= activation_shift[5];
+                                crc_tdi <= CRC16_INIT;
+                                crc_tms <= CRC16_INIT;
+                                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_ACT_VALID, activation_shift[7:4], 0, 0, 0);
                             end
                             else begin
                                 state <= ST_OFFLINE;
-`ifdef VERBOSE
+`ifndef SYNTHESIS
                                 if (activation_shift[3:0] != 4'b1100) begin
-                                    $display("[%0t] ONLINE_ACT -> OFFLINE (invalid OAC: %b)", $time,
-                                             activation_shift[3:0]);
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ACT_BAD_OAC, activation_shift[3:0], 0, 0, 0);
                                 end
                                 else begin
-                                    $display("[%0t] ONLINE_ACT -> OFFLINE (invalid EC: %b)", $time, activation_shift[7:4]);
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_ERROR, LOGID_ACT_BAD_EC, activation_shift[7:4], 0, 0, 0);
                                 end
 `endif
                             end
@@ -390,11 +799,13 @@ module cjtag_bridge (
                 // OSCAN1: Active mode with 3-bit scan packets
                 // =============================================================
                 ST_OSCAN1: begin
-`ifdef VERBOSE
-                    if (tckc_negedge)
-                        $display("[%0t] OSCAN1 negedge: toggles=%0d, bit_pos=%0d", $time, tmsc_toggle_count, bit_pos);
-                    if (tckc_posedge)
-                        $display("[%0t] OSCAN1 posedge: toggles=%0d, bit_pos=%0d", $time, tmsc_toggle_count, bit_pos);
+`ifndef SYNTHESIS
+                    if (tckc_negedge) begin
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_TRACE, LOGID_OSCAN1_NEGEDGE, tmsc_toggle_count, bit_pos, 0, 0);
+                    end
+                    if (tckc_posedge) begin
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_TRACE, LOGID_OSCAN1_POSEDGE, tmsc_toggle_count, bit_pos, 0, 0);
+                    end
 `endif
 
                     // Check for escape sequence on TCKC falling edge (takes priority)
@@ -402,9 +813,23 @@ module cjtag_bridge (
                         return_state <= ST_OSCAN1;
                         state        <= ST_ESCAPE;
 
-`ifdef VERBOSE
-                        $display("[%0t] OSCAN1 -> ESCAPE (toggles=%0d)", $time, tmsc_toggle_count);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_OSCAN1_ESCAPE, tmsc_toggle_count, 0, 0, 0);
+                    end
+                    // Vendor frame: exactly 2 toggles at a packet boundary (EC=1001 only)
+                    else if (tckc_negedge && vext_en && bit_pos == 2'd0 && tmsc_toggle_count == 5'd2) begin
+                        state      <= ST_VCMD;
+                        vcmd_count <= 8'd0;
+                        vcmd_op    <= 8'd0;
+
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_VCMD_ENTER, 0, 0, 0, 0);
+                    end
+                    // Navigation frame: exactly 3 toggles at a packet boundary (EC=1001 only)
+                    else if (tckc_negedge && vext_en && bit_pos == 2'd0 && tmsc_toggle_count == 5'd3) begin
+                        state      <= ST_GOTO;
+                        goto_count <= 3'd0;
+                        goto_tgt   <= 4'd0;
+
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_GOTO_ENTER, 0, 0, 0, 0);
                     end
                     // Sample TMSC on TCKC rising edge.
                     // DTS drives data on the falling edge; data is stable on the rising
@@ -412,17 +837,177 @@ module cjtag_bridge (
                     else if (tckc_posedge) begin
                         tmsc_sampled <= tmsc_s;
 
+                        // Link CRC over the raw nTDI and TMS slots
+                        if (vext_en && bit_pos == 2'd0) crc_tdi <= crc16_step(crc_tdi, tmsc_s);
+                        if (vext_en && bit_pos == 2'd1) crc_tms <= crc16_step(crc_tms, tmsc_s);
+
+                        // Verify packets: expected TDO in slot 2, mask in slot 3
+                        if (verify_en && bit_pos == 2'd2) begin
+                            verify_exp <= tmsc_s;
+                            verify_tdo <= tdo_i;
+                        end
+                        if (verify_en && bit_pos == 2'd3) begin
+                            if (tmsc_s && verify_tdo != verify_exp) begin
+                                verify_fail <= 1'b1;
+                                if (!verify_fail) verify_first <= verify_count;
+
+                                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_VERIFY_MISMATCH, verify_count, verify_tdo,
+                                          verify_exp, 0);
+                            end
+                            if (verify_count != 16'hFFFF) verify_count <= verify_count + 16'd1;
+                        end
+
+                        // Loopback: latch this packet's TDO slot bit from the nTDI slot
+                        if (loop_mode != LOOP_OFF && bit_pos == 2'd0) begin
+                            loop_bit <= (loop_mode == LOOP_ECHO) ? tmsc_s : loop_prbs[14];
+                            if (loop_mode == LOOP_PRBS) begin
+                                loop_prbs <= {loop_prbs[13:0], loop_prbs[14] ^ loop_prbs[13]};
+                                if (tmsc_s != loop_prbs[14] && loop_errors != 16'hFFFF) begin
+                                    loop_errors <= loop_errors + 16'd1;
+                                end
+                            end
+                            if (loop_count != 24'hFFFFFF) loop_count <= loop_count + 24'd1;
+                        end
+
                         // Advance to next bit position
                         case (bit_pos)
                             2'd0: bit_pos <= 2'd1;  // nTDI sampled
                             2'd1: bit_pos <= 2'd2;  // TMS sampled
-                            2'd2: bit_pos <= 2'd0;  // TDO bit slot complete
-                            default: bit_pos <= 2'd0;
+                            2'd2: bit_pos <= verify_en ? 2'd3 : 2'd0;  // TDO or EXP slot complete
+                            default: bit_pos <= 2'd0;  // MASK slot complete
                         endcase
 
-`ifdef VERBOSE
-                        $display("[%0t] OSCAN1 posedge (sample): bit_pos=%0d, tmsc_s=%b", $time, bit_pos, tmsc_s);
-`endif
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_OSCAN1_SAMPLE, bit_pos, tmsc_s, 0, 0);
+                    end
+                end
+
+                ST_VCMD: begin
+                    // Any real escape aborts the frame; deselect/reset are
+                    // then handled by ST_ESCAPE exactly as from OSCAN1
+                    if (tckc_negedge && tmsc_toggle_count >= 5'd4) begin
+                        return_state <= ST_OSCAN1;
+                        state        <= ST_ESCAPE;
+                        vcmd_count   <= 8'd0;
+
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_VCMD_ESCAPE, tmsc_toggle_count, 0, 0, 0);
+                    end
+                    else if (poll_phase != POLL_OFF) begin
+                        // TCKC edges are not taken while the poll engine owns TCK
+                        if (poll_done) begin
+                            vcmd_resp <= {poll_tries, poll_tdo};
+
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_POLL_DONE, poll_tries, poll_tdo, 0, 0);
+                        end
+                    end
+                    else if (tckc_posedge) begin
+                        if (vcmd_count < 8'd8) begin
+                            vcmd_op <= {tmsc_s, vcmd_op[7:1]};
+                        end
+                        else if (vcmd_count < 8'd8 + vcmd_arg_bits(vcmd_op)) begin
+                            poll_arg <= poll_arg_next;
+                        end
+                        else begin
+                            vcmd_resp <= {1'b0, vcmd_resp[39:1]};  // Bit 0 was just sampled by the host
+                        end
+
+                        // Opcode complete: latch the response
+                        if (vcmd_count == 8'd7) begin
+                            case ({tmsc_s, vcmd_op[7:1]})
+                                VCMD_CRC_READ: begin
+                                    vcmd_resp <= {8'd0, crc_tms, crc_tdi};
+                                    crc_tdi   <= CRC16_INIT;
+                                    crc_tms   <= CRC16_INIT;
+                                end
+                                VCMD_VERIFY_ON: begin
+                                    vcmd_resp    <= 40'd0;
+                                    verify_en    <= 1'b1;
+                                    verify_fail  <= 1'b0;
+                                    verify_count <= 16'd0;
+                                    verify_first <= 16'd0;
+                                    loop_mode    <= LOOP_OFF;
+
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_VERIFY_ON, 0, 0, 0, 0);
+                                end
+                                VCMD_VERIFY_END: begin
+                                    vcmd_resp <= {7'd0, verify_fail, verify_count, verify_first};
+                                    verify_en <= 1'b0;
+
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_VERIFY_END, verify_count, verify_fail,
+                                              verify_first, 0);
+                                end
+                                VCMD_LOOP_ECHO, VCMD_LOOP_PRBS: begin
+                                    vcmd_resp   <= 40'd0;
+                                    loop_mode   <= vcmd_op[1] ? LOOP_PRBS : LOOP_ECHO;  // opcode bit 0
+                                    loop_prbs   <= LOOP_PRBS_SEED;
+                                    loop_count  <= 24'd0;
+                                    loop_errors <= 16'd0;
+                                    verify_en   <= 1'b0;
+
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_LOOP_START,
+                                              vcmd_op[1] ? LOOP_PRBS : LOOP_ECHO, 0, 0, 0);
+                                end
+                                VCMD_LOOP_END: begin
+                                    vcmd_resp <= {loop_errors, loop_count};
+                                    loop_mode <= LOOP_OFF;
+
+                                    `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_LOOP_END, loop_count, loop_errors, 0, 0);
+                                end
+                                default: vcmd_resp <= 40'd0;
+                            endcase
+
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_VCMD_OPCODE, {tmsc_s, vcmd_op[7:1]},
+                                      ({tmsc_s, vcmd_op[7:1]} == VCMD_CRC_READ) ? {crc_tms, crc_tdi} : 32'd0, 0, 0);
+                        end
+
+                        if (vcmd_op == VCMD_POLL && vcmd_count == POLL_RUN_AT) begin
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_POLL_START, scan_len, poll_arg_next[87:80],
+                                      poll_arg_next[79:72], 0);
+                        end
+
+                        // Frame ends on a packet boundary; the next TCKC cycle is an nTDI slot
+                        if (vcmd_count >= 8'd8 && vcmd_count == vcmd_frame_len(vcmd_op) - 8'd1) begin
+                            state      <= ST_OSCAN1;
+                            bit_pos    <= 2'd0;
+                            vcmd_count <= 8'd0;
+
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_VCMD_DONE, vcmd_op, vcmd_frame_len(vcmd_op), 0, 0);
+                        end
+                        else begin
+                            vcmd_count <= vcmd_count + 8'd1;
+                        end
+                    end
+                end
+
+                ST_GOTO: begin
+                    // Escapes abort the frame (and a walk: the output block
+                    // parks TCK, the mirror already holds the last step)
+                    if (tckc_negedge && tmsc_toggle_count >= 5'd4) begin
+                        return_state <= ST_OSCAN1;
+                        state        <= ST_ESCAPE;
+                        goto_count   <= 3'd0;
+
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_GOTO_ESCAPE, tmsc_toggle_count, 0, 0, 0);
+                    end
+                    else if (goto_count == GOTO_WALKING) begin
+                        // TCKC edges are not taken while the bridge owns TCK
+                        if (goto_done) begin
+                            state      <= ST_OSCAN1;
+                            bit_pos    <= 2'd0;
+                            goto_count <= 3'd0;
+
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_GOTO_DONE, tap_mirror, goto_steps, 0, 0);
+                        end
+                    end
+                    else if (tckc_posedge) begin
+                        // Target bits in the nTDI/TDO slots; TMS slots are padding
+                        if (goto_count != 3'd1 && goto_count != 3'd4) begin
+                            goto_tgt <= {tmsc_s, goto_tgt[3:1]};
+                        end
+                        goto_count <= goto_count + 3'd1;  // 5 -> GOTO_WALKING
+
+                        if (goto_count == 3'd5) begin
+                            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_GOTO_WALK, {tmsc_s, goto_tgt[3:1]}, tap_mirror, 0, 0);
+                        end
                     end
                 end
 
@@ -444,6 +1029,14 @@ module cjtag_bridge (
             tmsc_oen_int <= 1'b1;  // Default to input mode
             tck_rise_req <= 1'b0;
             tck_fall_req <= 1'b0;
+            tap_mirror   <= TAP_TEST_LOGIC_RESET;  // jtag_tap shares nTRST
+            goto_steps   <= 4'd0;
+            scan_tdi     <= 64'd0;
+            scan_len     <= 7'd0;
+            poll_phase   <= POLL_OFF;
+            poll_cnt     <= 8'd0;
+            poll_tries   <= 8'd0;
+            poll_tdo     <= 32'd0;
         end
         else begin
             case (state)
@@ -455,6 +1048,7 @@ module cjtag_bridge (
                     tmsc_oen_int <= 1'b1;  // Input mode
                     tck_rise_req <= 1'b0;
                     tck_fall_req <= 1'b0;
+                    poll_phase   <= POLL_OFF;
                 end
 
                 ST_OSCAN1: begin
@@ -490,24 +1084,18 @@ module cjtag_bridge (
                                 tdi_int      <= ~tmsc_sampled;
                                 tmsc_oen_int <= 1'b1;  // Input mode for TMS
 
-`ifdef VERBOSE
-                                $display("[%0t] OSCAN1 posedge: bit_pos=1, tdi_int=%b (inverted from %b)", $time,
-                                         ~tmsc_sampled, tmsc_sampled);
-`endif
+                                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_OSCAN1_TDI, ~tmsc_sampled, tmsc_sampled, 0, 0);
                             end
 
                             2'd2: begin
-                                // DTS samples TDO on this TCKC rising edge.
+                                // DTS samples TDO (or drives EXP) on this TCKC rising edge.
                                 // End the TDO output window; schedule TCK fall for next cycle
                                 // so jtag_tap negedge (post-shift tdo_o update) occurs AFTER
                                 // DTS has already captured the pre-shift value.
                                 tck_fall_req <= 1'b1;  // Lower TCK next cycle
                                 tmsc_oen_int <= 1'b1;  // End TDO window; return to input
 
-`ifdef VERBOSE
-                                $display("[%0t] OSCAN1 posedge: bit_pos=2, scheduling TCK fall, tms_int=%b",
-                                         $time, tms_int);
-`endif
+                                `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_OSCAN1_TCK_FALL, tms_int, 0, 0, 0);
                             end
 
                             default: begin
@@ -521,19 +1109,31 @@ module cjtag_bridge (
                     // Also open the TDO output window: drive tdo_i on TMSC from this
                     // negedge until TCKC posedge so the DTS can sample the pre-shift
                     // TDO value on the TCKC rising edge (IEEE 1149.7 "rising edge sample").
+                    // Verify packets leave TMSC to the host (EXP slot); loopback
+                    // keeps the TAP clock parked and drives loop_bit instead.
                     if (tckc_negedge && bit_pos == 2'd2) begin
                         tms_int      <= tmsc_sampled;  // Commit TMS before TCK rises
-                        tck_rise_req <= 1'b1;          // Raise TCK next cycle
-                        tmsc_oen_int <= 1'b0;          // Open TDO window (pre-shift value)
-`ifdef VERBOSE
-                        $display("[%0t] OSCAN1 negedge: bit_pos=2, tms_int->%b, TCK rise + TDO window open", $time, tmsc_sampled);
-`endif
+                        if (loop_mode == LOOP_OFF) begin
+                            tck_rise_req <= 1'b1;      // Raise TCK next cycle
+                        end
+                        tmsc_oen_int <= verify_en;     // Open TDO window (pre-shift value)
+                        `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_DEBUG, LOGID_OSCAN1_TCK_RISE, tmsc_sampled, 0, 0, 0);
                     end
 
                     // Raise TCK one cycle after tms_int was committed
                     if (tck_rise_req) begin
                         tck_int      <= 1'b1;
                         tck_rise_req <= 1'b0;
+                        tap_mirror   <= tap_next(tap_mirror, tms_int);
+
+                        // Record the DR scan for VCMD_POLL
+                        if (vext_en && tap_mirror == TAP_CAPTURE_DR) begin
+                            scan_len <= 7'd0;
+                        end
+                        else if (vext_en && tap_mirror == TAP_SHIFT_DR && scan_len <= POLL_SCAN_MAX) begin
+                            if (scan_len < POLL_SCAN_MAX) scan_tdi[scan_len[5:0]] <= tdi_int;
+                            scan_len <= scan_len + 7'd1;
+                        end
                     end
 
                     // Lower TCK one cycle after TCKC posedge (after DTS sampled TDO)
@@ -544,6 +1144,132 @@ module cjtag_bridge (
 
                 end
 
+                ST_VCMD: begin
+                    // TAP clock parked low, TMS/TDI hold, except while the
+                    // poll engine runs.  Response bits use the TDO slot
+                    // timing: driven from TCKC negedge, released on the
+                    // posedge at which the host samples them.
+                    tck_rise_req <= 1'b0;
+                    tck_fall_req <= 1'b0;
+
+                    if (poll_phase == POLL_OFF) begin
+                        tck_int <= 1'b0;
+
+                        if (tckc_negedge && vcmd_count >= 8'd8 + vcmd_arg_bits(vcmd_op) &&
+                            vcmd_count < 8'd8 + vcmd_arg_bits(vcmd_op) + vcmd_resp_bits(vcmd_op)) begin
+                            tmsc_oen_int <= 1'b0;
+                        end
+                        else if (tckc_posedge) begin
+                            tmsc_oen_int <= 1'b1;
+                        end
+
+                        // Last operand bit: start the engine (nothing to run
+                        // without a recorded scan or with limit 0)
+                        if (tckc_posedge && vcmd_op == VCMD_POLL && vcmd_count == POLL_RUN_AT) begin
+                            poll_cnt   <= 8'd0;
+                            poll_tries <= 8'd0;
+                            poll_tdo   <= 32'd0;
+                            if (scan_len == 7'd0 || scan_len > POLL_SCAN_MAX || poll_arg_next[87:80] == 8'd0) begin
+                                poll_phase <= POLL_DONE;
+                            end
+                            else if (tap_mirror == TAP_CAPTURE_DR) begin
+                                poll_phase <= POLL_SHIFT;
+                                tms_int    <= 1'b0;
+                            end
+                            else begin
+                                poll_phase <= POLL_NAV;
+                                tms_int    <= goto_tms(tap_mirror, TAP_CAPTURE_DR);
+                            end
+                        end
+                    end
+                    else if (poll_done) begin
+                        poll_phase <= POLL_OFF;
+                    end
+                    else if (tck_int) begin
+                        // Falling edge: set up TMS/TDI for the next rise
+                        tck_int <= 1'b0;
+                        tms_int <= poll_tms(poll_phase, tap_mirror, poll_cnt[6:0] == scan_len - 7'd1);
+                        if (poll_phase == POLL_SHIFT && tap_mirror == TAP_SHIFT_DR) begin
+                            tdi_int <= scan_tdi[poll_cnt[5:0]];
+                        end
+                    end
+                    else if (poll_phase != POLL_DONE) begin
+                        tck_int    <= 1'b1;
+                        tap_mirror <= tap_next(tap_mirror, tms_int);
+
+                        case (poll_phase)
+                            POLL_NAV: begin
+                                if (tap_next(tap_mirror, tms_int) == TAP_CAPTURE_DR) begin
+                                    poll_phase <= POLL_SHIFT;
+                                    poll_cnt   <= 8'd0;
+                                    poll_tdo   <= 32'd0;
+                                end
+                            end
+
+                            POLL_SHIFT: begin
+                                // Pre-shift TDO is bit poll_cnt of the scan
+                                if (tap_mirror == TAP_SHIFT_DR) begin
+                                    if (poll_cnt >= poll_offset && poll_win_idx < 8'd32) begin
+                                        poll_tdo[poll_win_idx[4:0]] <= tdo_i;
+                                    end
+                                    poll_cnt <= poll_cnt + 8'd1;
+                                    if (tms_int) begin
+                                        poll_phase <= POLL_RETURN;
+                                        poll_tries <= poll_tries + 8'd1;
+                                    end
+                                end
+                            end
+
+                            POLL_RETURN: begin
+                                if (tap_next(tap_mirror, tms_int) == TAP_RUN_TEST_IDLE) begin
+                                    poll_cnt <= 8'd0;
+                                    if ((poll_tdo & poll_mask) == poll_match || poll_tries == poll_limit) begin
+                                        poll_phase <= POLL_DONE;
+                                    end
+                                    else if (poll_interval == 8'd0) begin
+                                        poll_phase <= POLL_NAV;
+                                    end
+                                    else begin
+                                        poll_phase <= POLL_WAIT;
+                                    end
+                                end
+                            end
+
+                            default: begin  // POLL_WAIT
+                                poll_cnt <= poll_cnt + 8'd1;
+                                if (poll_cnt + 8'd1 == poll_interval) begin
+                                    poll_phase <= POLL_NAV;
+                                end
+                            end
+                        endcase
+                    end
+                end
+
+                ST_GOTO: begin
+                    // The host drives TMSC for the whole frame.  On the last
+                    // frame bit, present the first TMS of the path; then
+                    // alternate TCK rise (mirror steps) and fall (next TMS).
+                    tmsc_oen_int <= 1'b1;
+                    tck_rise_req <= 1'b0;
+                    tck_fall_req <= 1'b0;
+
+                    if (goto_count == 3'd5 && tckc_posedge) begin
+                        tms_int    <= goto_tms(tap_mirror, {tmsc_s, goto_tgt[3:1]});
+                        goto_steps <= 4'd0;
+                    end
+                    else if (goto_count == GOTO_WALKING) begin
+                        if (tck_int) begin
+                            tck_int <= 1'b0;
+                            tms_int <= goto_tms(tap_mirror, goto_tgt);
+                        end
+                        else if (!goto_done) begin
+                            tck_int    <= 1'b1;
+                            tap_mirror <= tap_next(tap_mirror, tms_int);
+                            goto_steps <= goto_steps + 4'd1;
+                        end
+                    end
+                end
+
                 default: begin
                     tck_int      <= 1'b0;
                     tms_int      <= 1'b1;
@@ -556,6 +1282,26 @@ module cjtag_bridge (
         end
     end
 
+    // =========================================================================
+    // Return Clock (RTCK) - adaptive clocking acknowledgement
+    // =========================================================================
+    // Follows tckc_s only when the synchronizer has settled (tckc_prev ==
+    // tckc_s), no edge pulse is being consumed this cycle, no TCK rise/fall
+    // is still pending and no GOTO walk or poll is running.  tck_int has
+    // therefore already moved, so the TAP has seen its TCK edge by the time
+    // rtck_o changes.
+    always_ff @(posedge clk_i or negedge ntrst_i) begin
+        if (!ntrst_i) begin
+            rtck_int <= 1'b0;
+        end
+        else if (tckc_prev == tckc_s && !tckc_posedge && !tckc_negedge &&
+                 !tck_rise_req && !tck_fall_req &&
+                 !(state == ST_GOTO && goto_count == GOTO_WALKING) &&
+                 !(state == ST_VCMD && poll_phase != POLL_OFF)) begin
+            rtck_int <= tckc_s;
+        end
+    end
+
     // =========================================================================
     // Output Logic
     // =========================================================================
@@ -582,23 +1328,27 @@ module cjtag_bridge (
     // tdo_o does not update until the following TCK negedge, so tdo_i remains
     // stable throughout the entire TDO window until the probe samples on TCKC
     // posedge.  This matches IEEE 1149.1 shift-register output timing. ✓
-    assign tmsc_o   = !tmsc_oen_int ? tdo_i : 1'b0;
+    // In ST_VCMD the bridge drives its own response bits instead, and in a
+    // loopback session the bit latched from the nTDI slot or the PRBS.
+    assign tmsc_o   = !tmsc_oen_int ? ((state == ST_VCMD)      ? vcmd_resp[0] :
+                                       (loop_mode != LOOP_OFF) ? loop_bit : tdo_i) : 1'b0;
 
     // TMSC output enable: Registered, changes on rising edge
     assign tmsc_oen = tmsc_oen_int;
 
     // Status outputs
-    assign online_o = (state == ST_OSCAN1);
-    assign nsp_o    = (state != ST_OSCAN1);  // Standard Protocol active when not in OScan1
+    assign online_o = (state == ST_OSCAN1) || (state == ST_VCMD) || (state == ST_GOTO);
+    assign nsp_o    = !online_o;  // Standard Protocol active when not in OScan1
+    assign rtck_o   = rtck_int;
 
-`ifdef VERBOSE
+`ifndef SYNTHESIS
     // Monitor state changes
     always_ff @(posedge clk_i or negedge ntrst_i) begin
         if (!ntrst_i) begin
             prev_state <= 3'd0;
         end
         else if (state != prev_state) begin
-            $display("[%0t] STATE CHANGE: %0d -> %0d", $time, prev_state, state);
+            `CJTAG_LOG(LOG_CAT_BRIDGE, LOG_INFO, LOGID_STATE_CHANGE, prev_state, state, 0, 0);
             prev_state <= state;
         end
     end
@@ -618,7 +1368,8 @@ module cjtag_bridge (
     property valid_state;
         @(posedge clk_i) disable iff (!ntrst_i)
         (state == ST_OFFLINE) || (state == ST_ESCAPE) ||
-        (state == ST_ONLINE_ACT) || (state == ST_OSCAN1);
+        (state == ST_ONLINE_ACT) || (state == ST_OSCAN1) || (state == ST_VCMD) ||
+        (state == ST_GOTO);
     endproperty
     assert property (valid_state)
     else $error("[ASSERT] Invalid state detected: %0d", state);
@@ -640,11 +1391,18 @@ module cjtag_bridge (
     property legal_transition_from_escape;
         @(posedge clk_i) disable iff (!ntrst_i)
         (state == ST_ESCAPE) |=>
-            (state == ST_OFFLINE) || (state == ST_ONLINE_ACT);
+            (state == ST_OFFLINE) || (state == ST_ONLINE_ACT) || (state == ST_OSCAN1);
     endproperty
     assert property (legal_transition_from_escape)
     else $error("[ASSERT] Illegal transition from ESCAPE to %0d", state);
 
+    // Assert: ESCAPE skips activation only to resume a retained context
+    property resume_requires_context;
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_ESCAPE && !ctx_valid) |=> (state != ST_OSCAN1);
+    endproperty
+    assert property (resume_requires_context)
+    else $error("[ASSERT] OSCAN1 resumed without a retained context");
+
     property legal_transition_from_online_act;
         @(posedge clk_i) disable iff (!ntrst_i)
         (state == ST_ONLINE_ACT) |=>
@@ -657,11 +1415,77 @@ module cjtag_bridge (
     property legal_transition_from_oscan1;
         @(posedge clk_i) disable iff (!ntrst_i)
         (state == ST_OSCAN1) |=>
-            (state == ST_OSCAN1) || (state == ST_ESCAPE) || (state == ST_OFFLINE);
+            (state == ST_OSCAN1) || (state == ST_ESCAPE) || (state == ST_OFFLINE) ||
+            (state == ST_VCMD) || (state == ST_GOTO);
     endproperty
     assert property (legal_transition_from_oscan1)
     else $error("[ASSERT] Illegal transition from OSCAN1 to %0d", state);
 
+    property legal_transition_from_vcmd;
+        @(posedge clk_i) disable iff (!ntrst_i)
+        (state == ST_VCMD) |=>
+            (state == ST_VCMD) || (state == ST_OSCAN1) || (state == ST_ESCAPE);
+    endproperty
+    assert property (legal_transition_from_vcmd)
+    else $error("[ASSERT] Illegal transition from VCMD to %0d", state);
+
+    // Assert: Vendor frames only exist after an EC=1001 activation
+    property vcmd_requires_vext;
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_VCMD) |-> vext_en;
+    endproperty
+    assert property (vcmd_requires_vext)
+    else $error("[ASSERT] VCMD entered without vendor extensions enabled");
+
+    property legal_transition_from_goto;
+        @(posedge clk_i) disable iff (!ntrst_i)
+        (state == ST_GOTO) |=>
+            (state == ST_GOTO) || (state == ST_OSCAN1) || (state == ST_ESCAPE);
+    endproperty
+    assert property (legal_transition_from_goto)
+    else $error("[ASSERT] Illegal transition from GOTO to %0d", state);
+
+    property goto_requires_vext;
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_GOTO) |-> vext_en;
+    endproperty
+    assert property (goto_requires_vext)
+    else $error("[ASSERT] GOTO entered without vendor extensions enabled");
+
+    // Assert: A walk never needs more than 8 TCK pulses (5 for Test-Logic-Reset)
+    property goto_walk_bounded;
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_GOTO) |-> (goto_steps <= 4'd8);
+    endproperty
+    assert property (goto_walk_bounded)
+    else $error("[ASSERT] GOTO walk exceeded 8 TCK pulses: %0d", goto_steps);
+
+    // Assert: The walk returns to OSCAN1 with TCK parked low
+    property goto_exits_with_tck_low;
+        @(posedge clk_i) disable iff (!ntrst_i) ($past(state) == ST_GOTO && state == ST_OSCAN1) |-> !tck_o;
+    endproperty
+    assert property (goto_exits_with_tck_low)
+    else $error("[ASSERT] GOTO returned to OSCAN1 with TCK high");
+
+    // Assert: The poll engine only runs inside a POLL frame
+    property poll_only_in_vcmd;
+        @(posedge clk_i) disable iff (!ntrst_i)
+        (poll_phase != POLL_OFF) |-> ((state == ST_VCMD && vcmd_op == VCMD_POLL) || $past(state) == ST_VCMD);
+    endproperty
+    assert property (poll_only_in_vcmd)
+    else $error("[ASSERT] Poll engine running outside a POLL frame");
+
+    // Assert: A replay never shifts more bits than were recorded
+    property poll_shift_bounded;
+        @(posedge clk_i) disable iff (!ntrst_i) (poll_phase == POLL_SHIFT) |-> (poll_cnt[6:0] <= scan_len);
+    endproperty
+    assert property (poll_shift_bounded)
+    else $error("[ASSERT] Poll shifted %0d bits of a %0d-bit scan", poll_cnt, scan_len);
+
+    // Assert: Loopback packets never clock the TAP (GOTO and POLL still do)
+    property loop_parks_tck;
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_OSCAN1 && loop_mode != LOOP_OFF) |-> !tck_o;
+    endproperty
+    assert property (loop_parks_tck)
+    else $error("[ASSERT] TCK high in a loopback packet");
+
     // -------------------------------------------------------------------------
     // Counter Bounds Assertions
     // -------------------------------------------------------------------------
@@ -683,9 +1507,10 @@ module cjtag_bridge (
     assert property (activation_count_bounds)
     else $error("[ASSERT] Activation counter out of bounds: %0d", activation_count);
 
-    // Assert: Bit position must be 0, 1, or 2 in OSCAN1 state
+    // Assert: Bit position must be 0, 1, or 2 in OSCAN1 state (3: MASK slot
+    // of a verify packet)
     property bit_pos_bounds;
-        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_OSCAN1) |-> (bit_pos <= 2'd2);
+        @(posedge clk_i) disable iff (!ntrst_i) (state == ST_OSCAN1) |-> (bit_pos <= 2'd2 || verify_en);
     endproperty
     assert property (bit_pos_bounds)
     else $error("[ASSERT] Bit position out of bounds: %0d", bit_pos);
@@ -710,9 +1535,9 @@ module cjtag_bridge (
     // Status Signal Assertions
     // -------------------------------------------------------------------------
 
-    // Assert: online_o is high only in OSCAN1 state
+    // Assert: online_o is high only in OSCAN1 state (vendor frames included)
     property online_only_in_oscan1;
-        @(posedge clk_i) disable iff (!ntrst_i) online_o == (state == ST_OSCAN1);
+        @(posedge clk_i) disable iff (!ntrst_i) online_o == (state == ST_OSCAN1 || state == ST_VCMD || state == ST_GOTO);
     endproperty
     assert property (online_only_in_oscan1)
     else $error("[ASSERT] online_o mismatch: online_o=%b, state=%0d", online_o, state);
@@ -728,9 +1553,12 @@ module cjtag_bridge (
     // TCK Generation Assertions
     // -------------------------------------------------------------------------
 
-    // Assert: TCK should only go high in OSCAN1 state at bit position 2
+    // Assert: TCK should only go high in OSCAN1 state at bit position 2, or
+    // during a GOTO walk or a poll (an escape may end either with TCK high)
     property tck_only_in_oscan1;
-        @(posedge clk_i) disable iff (!ntrst_i) tck_o |-> (state == ST_OSCAN1);
+        @(posedge clk_i) disable iff (!ntrst_i)
+        tck_o |-> (state == ST_OSCAN1 || state == ST_GOTO || $past(state) == ST_GOTO ||
+                   state == ST_VCMD || $past(state) == ST_VCMD);
     endproperty
     assert property (tck_only_in_oscan1)
     else $error("[ASSERT] TCK high outside OSCAN1 state");
@@ -753,11 +1581,15 @@ module cjtag_bridge (
     else $error("[ASSERT] TCK rose at wrong bit position: past=%0d", $past(bit_pos));
 
     // Assert: TMS stays high when not in OSCAN1 (JTAG idle)
-    // Check with 1-cycle delay to account for pipeline
+    // Check with 1-cycle delay to account for pipeline; VCMD and GOTO hold TMS
     property tms_high_when_offline;
         @(posedge clk_i) disable iff (!ntrst_i) ($past(
             state
-        ) != ST_OSCAN1) |-> tms_o;
+        ) != ST_OSCAN1 && $past(
+            state
+        ) != ST_VCMD && $past(
+            state
+        ) != ST_GOTO) |-> tms_o;
     endproperty
     assert property (tms_high_when_offline)
     else $error("[ASSERT] TMS should be high when not in OSCAN1");
@@ -766,12 +1598,14 @@ module cjtag_bridge (
     // TMSC Bidirectional Control Assertions
     // -------------------------------------------------------------------------
 
-    // Assert: TMSC output enable low only in OSCAN1 (or 1 cycle after leaving)
+    // Assert: TMSC output enable low only in OSCAN1/VCMD (or 1 cycle after leaving)
     // Allow 1-cycle delay for pipeline
     property tmsc_oen_output_mode;
-        @(posedge clk_i) disable iff (!ntrst_i) !tmsc_oen |-> (state == ST_OSCAN1 || $past(
+        @(posedge clk_i) disable iff (!ntrst_i) !tmsc_oen |-> (state == ST_OSCAN1 || state == ST_VCMD || $past(
+            state
+        ) == ST_OSCAN1 || $past(
             state
-        ) == ST_OSCAN1);
+        ) == ST_VCMD);
     endproperty
     assert property (tmsc_oen_output_mode)
     else $error("[ASSERT] TMSC output enabled outside OSCAN1");
@@ -783,7 +1617,11 @@ module cjtag_bridge (
             state
         ) != ST_OSCAN1 && $past(
             state, 2
-        ) != ST_OSCAN1) |-> tmsc_oen;
+        ) != ST_OSCAN1 && $past(
+            state
+        ) != ST_VCMD && $past(
+            state, 2
+        ) != ST_VCMD) |-> tmsc_oen;
     endproperty
     assert property (tmsc_oen_input_when_offline)
     else $error("[ASSERT] TMSC should be in input mode when not in OSCAN1");
@@ -890,6 +1728,24 @@ module cjtag_bridge (
     assert property (negedge_detection_valid)
     else $error("[ASSERT] Invalid TCKC negedge detection");
 
+    // -------------------------------------------------------------------------
+    // Return Clock (RTCK) Assertions
+    // -------------------------------------------------------------------------
+
+    // Assert: RTCK does not acknowledge while a TCK edge is still pending
+    property rtck_waits_for_tck;
+        @(posedge clk_i) disable iff (!ntrst_i) (tck_rise_req || tck_fall_req) |=> $stable(rtck_int);
+    endproperty
+    assert property (rtck_waits_for_tck)
+    else $error("[ASSERT] RTCK changed while a TCK edge was pending");
+
+    // Assert: RTCK only ever moves to the synchronized TCKC level
+    property rtck_follows_tckc;
+        @(posedge clk_i) disable iff (!ntrst_i) !$stable(rtck_int) |-> (rtck_int == $past(tckc_s));
+    endproperty
+    assert property (rtck_follows_tckc)
+    else $error("[ASSERT] RTCK moved away from TCKC");
+
     // -------------------------------------------------------------------------
     // Coverage Properties
     // -------------------------------------------------------------------------
@@ -899,12 +1755,16 @@ module cjtag_bridge (
     cover property (@(posedge clk_i) state == ST_ESCAPE);
     cover property (@(posedge clk_i) state == ST_ONLINE_ACT);
     cover property (@(posedge clk_i) state == ST_OSCAN1);
+    cover property (@(posedge clk_i) state == ST_VCMD);
 
     // Cover: All state transitions
     cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_OFFLINE && state == ST_ESCAPE);
     cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_ESCAPE && state == ST_ONLINE_ACT);
     cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_ONLINE_ACT && state == ST_OSCAN1);
     cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_OSCAN1 && state == ST_ESCAPE);
+    cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_OSCAN1 && state == ST_VCMD);
+    cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_VCMD && state == ST_OSCAN1);
+    cover property (@(posedge clk_i) disable iff (!ntrst_i) $past(state) == ST_ESCAPE && state == ST_OSCAN1);
 
     // Cover: Escape sequences with different toggle counts
     cover property (@(posedge clk_i) disable iff (!ntrst_i) tmsc_toggle_count == 5'd4);
@@ -917,6 +1777,10 @@ module cjtag_bridge (
     cover property (@(posedge clk_i) disable iff (!ntrst_i) state == ST_OSCAN1 && bit_pos == 2'd1);
     cover property (@(posedge clk_i) disable iff (!ntrst_i) state == ST_OSCAN1 && bit_pos == 2'd2);
 
+    // Cover: Loopback TDO slots in both modes
+    cover property (@(posedge clk_i) disable iff (!ntrst_i) loop_mode == LOOP_ECHO && !tmsc_oen);
+    cover property (@(posedge clk_i) disable iff (!ntrst_i) loop_mode == LOOP_PRBS && !tmsc_oen);
+
 `endif  // SYNTHESIS
     /* verilator lint_on SYNCASYNCNET */
 
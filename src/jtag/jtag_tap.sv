@@ -18,6 +18,25 @@ module jtag_tap #(
     input  logic ntrst_i      // JTAG reset (active low)
 );
 
+    // =========================================================================
+    // Runtime Logging (see src/cjtag_log.svh; compiled out under SYNTHESIS)
+    // =========================================================================
+`include "cjtag_log.svh"
+
+`ifndef SYNTHESIS
+    localparam int LOGID_TCK_POSEDGE = (LOG_CAT_TAP << 8) | 8'h00;
+    localparam int LOGID_CAPTURE_IR  = (LOG_CAT_TAP << 8) | 8'h01;
+    localparam int LOGID_SHIFT_IR    = (LOG_CAT_TAP << 8) | 8'h02;
+    localparam int LOGID_UPDATE_IR   = (LOG_CAT_TAP << 8) | 8'h03;
+
+    initial begin
+        cjtag_log_register(LOGID_TCK_POSEDGE, LOG_CAT_TAP, "TAP: tck_i posedge, tms_i=%u, state=%u->%u");
+        cjtag_log_register(LOGID_CAPTURE_IR, LOG_CAT_TAP, "TAP: CAPTURE_IR, loading 0x%02x");
+        cjtag_log_register(LOGID_SHIFT_IR, LOG_CAT_TAP, "TAP: SHIFT_IR, tdi_i=%u, ir_shift=0x%02x -> 0x%02x");
+        cjtag_log_register(LOGID_UPDATE_IR, LOG_CAT_TAP, "TAP: UPDATE_IR, ir_reg=0x%02x -> 0x%02x");
+    end
+`endif
+
     // =========================================================================
     // TAP Controller States (IEEE 1149.1)
     // =========================================================================
@@ -40,7 +59,9 @@ module jtag_tap #(
         UPDATE_IR        = 4'hF
     } tap_state_t;
 
-    tap_state_t state, state_next;
+    // state and ir_reg are public_flat_rd: read-only probes for tb/cjtag_probe.h
+    tap_state_t state  /*verilator public_flat_rd*/;
+    tap_state_t state_next;
 
     // =========================================================================
     // Instruction Register
@@ -52,7 +73,7 @@ module jtag_tap #(
         DMI_INSTR    = 5'b10001   // RISC-V Debug Module Interface
     } instruction_t;
 
-    logic [IR_LEN-1:0] ir_reg;    // Instruction register
+    logic [IR_LEN-1:0] ir_reg     /*verilator public_flat_rd*/;  // Instruction register
     logic [IR_LEN-1:0] ir_shift;  // IR shift register
 
     // =========================================================================
@@ -69,9 +90,7 @@ module jtag_tap #(
         end
         else begin
             state <= state_next;
-`ifdef VERBOSE
-            $display("[%0t] TAP: tck_i posedge, tms_i=%b, state=%0d->%0d", $time, tms_i, state, state_next);
-`endif
+            `CJTAG_LOG(LOG_CAT_TAP, LOG_TRACE, LOGID_TCK_POSEDGE, tms_i, state, state_next, 0);
         end
     end
 
@@ -122,25 +141,17 @@ module jtag_tap #(
                     // for scan integrity checking by the host. Upper bits carry the
                     // current instruction for readback.
                     ir_shift <= {ir_reg[IR_LEN-1:2], 2'b01};
-`ifdef VERBOSE
-                    $display("[%0t] TAP: CAPTURE_IR, loading {ir_reg[%0d:2],2'b01} = %b (%h)", $time, IR_LEN - 1, {
-                             ir_reg[IR_LEN-1:2], 2'b01}, {ir_reg[IR_LEN-1:2], 2'b01});
-`endif
+                    `CJTAG_LOG(LOG_CAT_TAP, LOG_DEBUG, LOGID_CAPTURE_IR, {ir_reg[IR_LEN-1:2], 2'b01}, 0, 0, 0);
                 end
 
                 SHIFT_IR: begin
                     ir_shift <= {tdi_i, ir_shift[IR_LEN-1:1]};
-`ifdef VERBOSE
-                    $display("[%0t] TAP: SHIFT_IR, tdi_i=%b, ir_shift=%b -> %b", $time, tdi_i, ir_shift, {
-                             tdi_i, ir_shift[IR_LEN-1:1]});
-`endif
+                    `CJTAG_LOG(LOG_CAT_TAP, LOG_DEBUG, LOGID_SHIFT_IR, tdi_i, ir_shift, {tdi_i, ir_shift[IR_LEN-1:1]}, 0);
                 end
 
                 UPDATE_IR: begin
                     ir_reg <= ir_shift;
-`ifdef VERBOSE
-                    $display("[%0t] TAP: UPDATE_IR, ir_reg=%b -> %b (%h)", $time, ir_reg, ir_shift, ir_shift);
-`endif
+                    `CJTAG_LOG(LOG_CAT_TAP, LOG_INFO, LOGID_UPDATE_IR, ir_reg, ir_shift, 0, 0);
                 end
 
                 default: begin
@@ -242,7 +253,9 @@ module jtag_tap #(
     // =========================================================================
     // Debug Info (for simulation)
     // =========================================================================
-`ifdef VERBOSE
+    // Readable state name for waveform viewers; define CJTAG_STATE_NAMES to
+    // build it (costs a string assignment per evaluation, so off by default).
+`ifdef CJTAG_STATE_NAMES
     /* verilator lint_off UNUSED */
     string state_name;
     /* verilator lint_on UNUSED */
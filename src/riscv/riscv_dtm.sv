@@ -30,6 +30,21 @@ module riscv_dtm #(
     input logic ntrst_i  // JTAG reset (active low)
 );
 
+    // ========================================================================
+    // Runtime Logging (see src/cjtag_log.svh; compiled out under SYNTHESIS)
+    // ========================================================================
+`include "cjtag_log.svh"
+
+`ifndef SYNTHESIS
+    localparam int LOGID_CAPTURE_IDCODE = (LOG_CAT_DTM << 8) | 8'h00;
+    localparam int LOGID_SHIFT_IDCODE   = (LOG_CAT_DTM << 8) | 8'h01;
+
+    initial begin
+        cjtag_log_register(LOGID_CAPTURE_IDCODE, LOG_CAT_DTM, "DTM: CAPTURE_DR IDCODE, loading %08x");
+        cjtag_log_register(LOGID_SHIFT_IDCODE, LOG_CAT_DTM, "DTM: SHIFT_DR IDCODE, tdo=%u, idcode_shift=%08x -> %08x");
+    end
+`endif
+
     // ========================================================================
     // Instruction Opcodes
     // ========================================================================
@@ -135,9 +150,7 @@ module riscv_dtm #(
             case (ir_i)
                 IR_IDCODE: begin
                     idcode_shift <= IDCODE;
-`ifdef VERBOSE
-                    $display("[%0t] DTM: CAPTURE_DR IDCODE, loading %h", $time, IDCODE);
-`endif
+                    `CJTAG_LOG(LOG_CAT_DTM, LOG_DEBUG, LOGID_CAPTURE_IDCODE, IDCODE, 0, 0, 0);
                 end
                 IR_DTMCS:  dtmcs_shift <= DTMCS_VALUE;
                 IR_DMI: begin
@@ -159,10 +172,8 @@ module riscv_dtm #(
             case (ir_i)
                 IR_IDCODE: begin
                     idcode_shift <= {tdi_i, idcode_shift[31:1]};
-`ifdef VERBOSE
-                    $display("[%0t] DTM: SHIFT_DR IDCODE, tdo=%b, idcode_shift=%h -> %h", $time, idcode_shift[0],
-                             idcode_shift, {tdi_i, idcode_shift[31:1]});
-`endif
+                    `CJTAG_LOG(LOG_CAT_DTM, LOG_TRACE, LOGID_SHIFT_IDCODE, idcode_shift[0], idcode_shift,
+                               {tdi_i, idcode_shift[31:1]}, 0);
                 end
                 IR_DTMCS:  dtmcs_shift <= {tdi_i, dtmcs_shift[31:1]};
                 IR_DMI:    dmi_shift <= {tdi_i, dmi_shift[39:1]};
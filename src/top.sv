@@ -3,6 +3,10 @@
 // =============================================================================
 // Connects cJTAG bridge to JTAG TAP and provides VPI interface
 // Uses 100MHz system clock for cJTAG protocol detection
+//
+// A direct 4-wire injection path (jtag_sel_i=1) lets the testbench drive the
+// TAP's TCK/TMS/TDI itself, bypassing the bridge.  The same TAP/DTM can then
+// be exercised over plain JTAG and over OScan1 for A/B comparisons.
 // =============================================================================
 
 module top (
@@ -12,20 +16,44 @@ module top (
     input  logic tmsc_i,
     output logic tmsc_o,
     output logic tmsc_oen,
-    // Exposed internal signals for testing
+    // Direct 4-wire JTAG injection (bypasses cjtag_bridge when jtag_sel_i=1)
+    input  logic jtag_sel_i,  // 0=TAP driven by bridge, 1=TAP driven by jtag_*_i
+    input  logic jtag_tck_i,
+    input  logic jtag_tms_i,
+    input  logic jtag_tdi_i,
+    // Exposed internal signals for testing (TAP-side, after the mux)
     output logic tck_o,
     output logic tms_o,
     output logic tdi_o,
     output logic tdo_o,       // negedge-registered (valid when TCK low)
     output logic tdo_comb_o,  // combinatorial (what bridge actually samples)
     output logic online_o,
-    output logic nsp_o
+    output logic nsp_o,
+    output logic rtck_o       // Return clock (adaptive clocking ack; see cjtag_bridge)
 );
 
+    // ==========================================================================
+    // Runtime Logging (see src/cjtag_log.svh; compiled out under SYNTHESIS)
+    // ==========================================================================
+`include "cjtag_log.svh"
+
+`ifndef SYNTHESIS
+    localparam int LOGID_ONLINE_TCKC = (LOG_CAT_TOP << 8) | 8'h00;
+
+    initial begin
+        cjtag_log_register(LOGID_ONLINE_TCKC, LOG_CAT_TOP,
+                           "cJTAG ONLINE: TMSC_I=%u TMSC_O=%u TCK/TMS/TDI/TDO=%x");
+    end
+`endif
+
     // ==========================================================================
     // cJTAG Bridge Instance
     // ==========================================================================
     logic tdo_comb_w;  // Combinatorial TDO from TAP – used by bridge for OScan1 timing
+    logic bridge_tck;
+    logic bridge_tms;
+    logic bridge_tdi;
+    logic bridge_rtck;
 
     cjtag_bridge u_cjtag_bridge (
         .clk_i   (clk_i),
@@ -34,14 +62,26 @@ module top (
         .tmsc_i  (tmsc_i),
         .tmsc_o  (tmsc_o),
         .tmsc_oen(tmsc_oen),
-        .tck_o   (tck_o),
-        .tms_o   (tms_o),
-        .tdi_o   (tdi_o),
+        .tck_o   (bridge_tck),
+        .tms_o   (bridge_tms),
+        .tdi_o   (bridge_tdi),
         .tdo_i   (tdo_comb_w),
         .online_o(online_o),
-        .nsp_o   (nsp_o)
+        .nsp_o   (nsp_o),
+        .rtck_o  (bridge_rtck)
     );
 
+    // ==========================================================================
+    // TAP Input Mux - bridge (cJTAG) or direct 4-wire injection (JTAG)
+    // ==========================================================================
+    // jtag_sel_i is a static testbench strap; it is not switched mid-scan.
+    assign tck_o = jtag_sel_i ? jtag_tck_i : bridge_tck;
+    assign tms_o = jtag_sel_i ? jtag_tms_i : bridge_tms;
+    assign tdi_o = jtag_sel_i ? jtag_tdi_i : bridge_tdi;
+
+    // Direct TCK reaches the TAP combinationally, so it is its own return clock
+    assign rtck_o = jtag_sel_i ? jtag_tck_i : bridge_rtck;
+
     // ==========================================================================
     // JTAG TAP Instance
     // ==========================================================================
@@ -73,18 +113,15 @@ module top (
     end
 
     // ==========================================================================
-    // Debug Display
+    // Debug Log - pin snapshot on every TCKC rise while online
     // ==========================================================================
-`ifdef VERBOSE
     /* verilator lint_off SYNCASYNCNET */
     always @(posedge tckc_i) begin
         if (online_o) begin
-            $display("[%0t] cJTAG ONLINE: TCKC=%b TMSC_I=%b TMSC_O=%b TCK=%b TMS=%b TDI=%b TDO=%b", $time, tckc_i,
-                     tmsc_i, tmsc_o, tck_o, tms_o, tdi_o, tdo_o);
+            `CJTAG_LOG(LOG_CAT_TOP, LOG_TRACE, LOGID_ONLINE_TCKC, tmsc_i, tmsc_o, {tck_o, tms_o, tdi_o, tdo_o}, 0);
         end
     end
     /* verilator lint_on SYNCASYNCNET */
-`endif  // VERBOSE
 `endif  // SYNTHESIS
 
 endmodule
@@ -0,0 +1,414 @@
+// =============================================================================
+// Clock-Ratio Benchmark for the cJTAG Bridge
+// =============================================================================
+// Sweeps the probe TCKC frequency against clk_i at arbitrary (non-integer)
+// ratios on the event kernel in sim_kernel.h.  Each point builds a fresh
+// model, runs escape + activation, then reads IDCODE --reads times over
+// OScan1 with TCKC and clk_i on independent, optionally jittered and drifting
+// timelines.  Per point it reports correct reads, JTAG throughput in
+// simulated time, eval() calls and wall time; the lowest ratio from which
+// every faster-clk_i point passes is reported as the failure boundary.
+//
+// --switches N adds a target-switch benchmark at the highest ratio: N times
+// deselect + reselect + one IDCODE read, once with a full re-activation and
+// once with the 7-toggle resume of a retained context (EC=0xA, see
+// cjtag_bridge.sv), reporting the TCKC periods and time spent per switch.
+//
+// --loopback N adds a link loopback sweep over the same ratios: EC=0x9,
+// VCMD_LOOP_PRBS, N packets carrying a PRBS-15 in their nTDI slots, then
+// VCMD_LOOP_END.  The TAP is not clocked; the probe checks the PRBS the
+// bridge returns in the TDO slots and reads back the bridge's own error
+// count, giving payload throughput and bit-error rate per direction.
+//
+// Usage: bench_clock_ratio [--clk-mhz F] [--ratios r1,r2,...] [--reads N]
+//                          [--jitter PCT] [--clk-jitter-ps PS] [--ppm PPM]
+//                          [--seed N] [--switches N] [--loopback N]
+//                          [--stim-out FILE] [--trace]
+//   ratio  = clk_i frequency / TCKC frequency (clk_i cycles per TCKC period)
+//   jitter = RMS TCKC edge jitter in percent of the TCKC period
+//   --stim-out writes the first point's TCKC/TMSC timeline as a .stim file
+//   --trace dumps bench_clock_ratio.fst (single ratio only)
+// =============================================================================
+
+#include "Vtop.h"
+#include "cjtag_log.h"
+#include "link_ref.h"
+#include "sim_kernel.h"
+#include "verilated.h"
+#include "verilated_fst_c.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+static const uint32_t EXPECTED_IDCODE = 0x1DEAD3FF;
+
+static SimKernel* g_kernel = nullptr;
+
+// Verilator time callback - required for $time in SystemVerilog
+double sc_time_stamp() {
+    return g_kernel ? (double)g_kernel->now() : 0;
+}
+
+// ─── Options ─────────────────────────────────────────────────────────────────
+struct BenchOptions {
+    double              clk_mhz       = 100.0;
+    std::vector<double> ratios        = { 2.0, 2.5, 3.0, 3.3, 3.7, 4.0, 4.5, 5.0, 5.5, 6.25, 7.0, 8.0, 10.0, 13.3, 20.0 };
+    int                 reads         = 8;
+    double              jitter_pct    = 0.0;
+    double              clk_jitter_ps = 0.0;
+    double              ppm           = 0.0;
+    uint64_t            seed          = 1;
+    int                 switches      = 0;
+    int                 loopback      = 0;
+    const char*         stim_out      = nullptr;
+    bool                trace         = false;
+};
+
+struct PointResult {
+    double   ratio;
+    double   tckc_mhz;
+    bool     online;
+    int      good_reads;
+    sim_ps_t sim_ps;
+    uint64_t evals;
+    uint64_t events;
+    double   wall_ms;
+};
+
+static double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+// ─── Stimulus ────────────────────────────────────────────────────────────────
+// Same JTAG sequence as test_idcode.cpp: RESET -> RTI once, then per read
+// RTI -> SELECT_DR -> CAPTURE_DR -> SHIFT_DR (32 captured bits) -> RTI.
+static void idcode_read(Oscan1Timeline& tl) {
+    tl.packet(0, 1, false);  // -> SELECT_DR
+    tl.packet(0, 0, false);  // -> CAPTURE_DR
+    for (int i = 0; i < 32; ++i) {
+        tl.packet(0, i == 31 ? 1 : 0, true);  // SHIFT_DR, last bit -> EXIT1_DR
+    }
+    tl.packet(0, 1, false);  // -> UPDATE_DR
+    tl.packet(0, 0, false);  // -> RUN_TEST_IDLE
+}
+
+static void build_idcode_reads(Oscan1Timeline& tl, int reads) {
+    tl.escape(6);
+    tl.activation();
+    tl.packet(0, 0, false);  // TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    for (int r = 0; r < reads; ++r) idcode_read(tl);
+}
+
+// Target switching: activate with context retention, then per switch
+// deselect (4 toggles), reselect and read IDCODE from RUN_TEST_IDLE.
+// Returns the simulated time spent in deselect + reselect.
+static sim_ps_t build_switches(Oscan1Timeline& tl, int switches, bool resume) {
+    tl.escape(6);
+    tl.activation(0xC, 0xA);
+    tl.packet(0, 0, false);  // TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    sim_ps_t switch_ps = 0;
+    for (int n = 0; n < switches; ++n) {
+        const sim_ps_t t0 = tl.end_ps();
+        tl.escape(4);
+        if (resume) {
+            tl.escape(7);
+        } else {
+            tl.escape(6);
+            tl.activation(0xC, 0xA);
+        }
+        switch_ps += tl.end_ps() - t0;
+        idcode_read(tl);
+    }
+    return switch_ps;
+}
+
+static int count_idcodes(const std::vector<uint8_t>& tdo, int reads) {
+    int good = 0;
+    for (int r = 0; r < reads && (size_t)(r + 1) * 32 <= tdo.size(); ++r) {
+        uint32_t idcode = 0;
+        for (int i = 0; i < 32; ++i) idcode |= (uint32_t)tdo[r * 32 + i] << i;
+        if (idcode == EXPECTED_IDCODE) ++good;
+    }
+    return good;
+}
+
+// Link loopback: PRBS session from RUN_TEST_IDLE, `packets` packets with
+// the PRBS in the nTDI slot and TDO sampled, then LOOP_END (40 sampled
+// bits).  Returns the simulated time spent in the packets.
+static sim_ps_t build_loopback(Oscan1Timeline& tl, int packets) {
+    tl.escape(6);
+    tl.activation(0xC, 0x9);
+    tl.packet(0, 0, false);  // TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    tl.vendor(0x21, 0);      // VCMD_LOOP_PRBS
+    uint16_t lfsr = 0x7FFF;
+    const sim_ps_t t0 = tl.end_ps();
+    for (int i = 0; i < packets; ++i) tl.packet(!prbs15_next(lfsr), 0, true);
+    const sim_ps_t loop_ps = tl.end_ps() - t0;
+    tl.vendor(0x24, 40);     // VCMD_LOOP_END: {errors[15:0], packets[23:0]}
+    return loop_ps;
+}
+
+// ─── One model run ───────────────────────────────────────────────────────────
+// Builds a fresh model, plays the timeline filled in by `build` and returns
+// the TDO bits sampled by the probe.
+template <typename Build>
+static std::vector<uint8_t> run_timeline(const BenchOptions& opt, double ratio, bool trace, const char* stim_out,
+                                         PointResult& res, Build build) {
+    res.ratio    = ratio;
+    res.tckc_mhz = opt.clk_mhz / ratio;
+
+    Vtop* dut = new Vtop;
+    VerilatedFstC* tfp = nullptr;
+    if (trace) {
+        Verilated::traceEverOn(true);
+        tfp = new VerilatedFstC;
+        dut->trace(tfp, 99);
+        tfp->open("bench_clock_ratio.fst");
+    }
+
+    SimKernel k([dut] { dut->eval(); }, opt.seed);
+    g_kernel = &k;
+    cjtag_log_set_clock(k.clock());
+    if (tfp) k.set_dump([tfp](sim_ps_t t) { tfp->dump(t); });
+
+    // Reset exactly like the tick harnesses: TCKC low, TMSC high
+    dut->ntrst_i    = 0;
+    dut->tckc_i     = 0;
+    dut->tmsc_i     = 1;
+    dut->jtag_sel_i = 0;
+    dut->jtag_tck_i = 0;
+    dut->jtag_tms_i = 1;
+    dut->jtag_tdi_i = 0;
+    dut->clk_i      = 0;
+
+    const ClockSpec clk    = ClockSpec::from_mhz(opt.clk_mhz, opt.clk_jitter_ps);
+    const double    clk_ps = clk.period_ps;
+    k.add_clock(clk, [dut](bool level) { dut->clk_i = level; });
+    k.at((sim_ps_t)(100 * clk_ps), [dut] { dut->ntrst_i = 1; });
+    k.at((sim_ps_t)(120 * clk_ps), [dut] { dut->tckc_i = 1; });
+
+    // Probe timeline: its own clock, jitter and drift
+    const ClockSpec tckc  = ClockSpec::from_mhz(res.tckc_mhz, opt.jitter_pct / 100.0 * (ratio * clk_ps), opt.ppm);
+    const sim_ps_t  start = (sim_ps_t)(140 * clk_ps);
+    Oscan1Timeline tl(tckc, k.rng(), start);
+    build(tl);
+    if (stim_out) {
+        char note[128];
+        snprintf(note, sizeof(note), "bench_clock_ratio: clk_i %.3f MHz, TCKC %.3f MHz, %d IDCODE reads",
+                 opt.clk_mhz, res.tckc_mhz, opt.reads);
+        if (!stim_write(stim_out, tl.events(), note)) {
+            fprintf(stderr, "Cannot write %s\n", stim_out);
+        }
+    }
+
+    std::vector<uint8_t> tdo;
+    tdo.reserve(tl.samples());
+    bool online_seen = false;
+    stim_schedule(k, tl.events(), 0,
+                  [dut](uint8_t tckc_v, uint8_t tmsc_v) {
+                      dut->tckc_i = tckc_v;
+                      dut->tmsc_i = tmsc_v;
+                  },
+                  [dut, &tdo, &online_seen] {
+                      online_seen |= dut->online_o != 0;
+                      tdo.push_back(dut->tmsc_o & 1u);
+                  });
+
+    const double w0 = wall_ms();
+    k.run_until(tl.end_ps() + (sim_ps_t)(20 * clk_ps));
+    res.wall_ms = wall_ms() - w0;
+    res.sim_ps  = k.now() - start;
+    res.evals   = k.evals();
+    res.events  = k.events();
+    res.online  = online_seen;
+
+    g_kernel = nullptr;
+    if (tfp) {
+        tfp->close();
+        delete tfp;
+    }
+    dut->final();
+    delete dut;
+    return tdo;
+}
+
+// ─── One sweep point ─────────────────────────────────────────────────────────
+static PointResult run_point(const BenchOptions& opt, double ratio, bool first) {
+    PointResult res = {};
+    const std::vector<uint8_t> tdo = run_timeline(opt, ratio, opt.trace, first ? opt.stim_out : nullptr, res,
+                                                  [&opt](Oscan1Timeline& tl) { build_idcode_reads(tl, opt.reads); });
+    res.good_reads = count_idcodes(tdo, opt.reads);
+    return res;
+}
+
+// ─── Target-switch cost ──────────────────────────────────────────────────────
+static void run_switch_bench(const BenchOptions& opt, double ratio) {
+    const double period_ps = ratio * 1e6 / opt.clk_mhz;
+    printf("Target switch: deselect + reselect at ratio %.3f (TCKC %.3f MHz), %d switches, EC=0xA\n", ratio,
+           opt.clk_mhz / ratio, opt.switches);
+    printf("%-18s %16s %12s %7s\n", "reselect", "TCKC periods/sw", "us/switch", "reads");
+    double cost[2] = {};
+    for (int resume = 0; resume <= 1; ++resume) {
+        PointResult res       = {};
+        sim_ps_t    switch_ps = 0;
+        const std::vector<uint8_t> tdo = run_timeline(opt, ratio, false, nullptr, res, [&](Oscan1Timeline& tl) {
+            switch_ps = build_switches(tl, opt.switches, resume != 0);
+        });
+        const int good = count_idcodes(tdo, opt.switches);
+        cost[resume]   = (double)switch_ps / period_ps / opt.switches;
+        printf("%-18s %16.1f %12.3f %3d/%-3d %s\n", resume ? "7-toggle resume" : "full activation", cost[resume],
+               (double)switch_ps / 1e6 / opt.switches, good, opt.switches, good == opt.switches ? "✓" : "✗");
+    }
+    if (cost[0] > 0.0) {
+        printf("Resume saves %.1f TCKC periods per switch (%.0f%%)\n", cost[0] - cost[1],
+               100.0 * (cost[0] - cost[1]) / cost[0]);
+    }
+}
+
+// ─── Link loopback throughput and BER ────────────────────────────────────────
+static void run_loop_bench(const BenchOptions& opt) {
+    const int n = opt.loopback;
+    printf("Link loopback: VCMD_LOOP_PRBS (PRBS-15), %d packets/point, EC=0x9\n", n);
+    printf("%7s %10s %10s %9s %9s %9s %10s\n", "ratio", "TCKC MHz", "Mbit/s", "packets", "host->br", "br->host",
+           "BER");
+    for (double ratio : opt.ratios) {
+        PointResult res     = {};
+        sim_ps_t    loop_ps = 0;
+        const std::vector<uint8_t> tdo = run_timeline(opt, ratio, false, nullptr, res, [&](Oscan1Timeline& tl) {
+            loop_ps = build_loopback(tl, n);
+        });
+
+        // Bridge -> host: TDO slots against the PRBS
+        uint16_t lfsr    = 0x7FFF;
+        int      to_host = 0;
+        for (int i = 0; i < n; ++i) {
+            const int bit = prbs15_next(lfsr);
+            to_host += (size_t)i >= tdo.size() || tdo[i] != bit;
+        }
+        // Host -> bridge: the bridge's own count from LOOP_END
+        uint64_t resp = 0;
+        for (int i = 0; i < 40 && (size_t)(n + i) < tdo.size(); ++i) resp |= (uint64_t)tdo[n + i] << i;
+        const int counted   = (int)(resp & 0xFFFFFF);
+        const int to_bridge = (int)(resp >> 24);
+
+        const bool ok = res.online && counted == n && to_host == 0 && to_bridge == 0;
+        printf("%7.3f %10.3f %10.3f %9d %9d %9d %10.2e %s\n", ratio, res.tckc_mhz,
+               (double)n / ((double)loop_ps / 1e6), counted, to_bridge, to_host,
+               (double)(to_host + to_bridge) / (2.0 * n), ok ? "✓" : "✗");
+        fflush(stdout);
+    }
+}
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+static std::vector<double> parse_list(const char* s) {
+    std::vector<double> v;
+    while (s && *s) {
+        char* end = nullptr;
+        const double x = strtod(s, &end);
+        if (end == s) break;
+        v.push_back(x);
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return v;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    cjtag_log_init(argc, argv);
+
+    BenchOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--clk-mhz") == 0 && i + 1 < argc) {
+            opt.clk_mhz = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--ratios") == 0 && i + 1 < argc) {
+            opt.ratios = parse_list(argv[++i]);
+        } else if (strcmp(argv[i], "--reads") == 0 && i + 1 < argc) {
+            opt.reads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            opt.jitter_pct = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--clk-jitter-ps") == 0 && i + 1 < argc) {
+            opt.clk_jitter_ps = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--ppm") == 0 && i + 1 < argc) {
+            opt.ppm = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opt.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--switches") == 0 && i + 1 < argc) {
+            opt.switches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loopback") == 0 && i + 1 < argc) {
+            opt.loopback = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stim-out") == 0 && i + 1 < argc) {
+            opt.stim_out = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            opt.trace = true;
+        }
+    }
+    if (opt.ratios.empty() || opt.reads <= 0 || opt.clk_mhz <= 0.0) {
+        fprintf(stderr, "Invalid arguments (see header of bench_clock_ratio.cpp)\n");
+        return 1;
+    }
+    if (opt.trace && opt.ratios.size() != 1) {
+        fprintf(stderr, "--trace needs a single --ratios value\n");
+        return 1;
+    }
+
+    printf("========================================\n");
+    printf("cJTAG Clock-Ratio Benchmark (event kernel)\n");
+    printf("clk_i %.3f MHz, %d IDCODE reads/point, TCKC jitter %.1f%%, clk jitter %.0f ps, %+.0f ppm\n",
+           opt.clk_mhz, opt.reads, opt.jitter_pct, opt.clk_jitter_ps, opt.ppm);
+    printf("========================================\n");
+    printf("%7s %10s %7s %7s %10s %12s %10s %9s\n", "ratio", "TCKC MHz", "online", "reads", "Mbit/s",
+           "evals", "evals/bit", "wall ms");
+
+    std::vector<PointResult> results;
+    for (size_t i = 0; i < opt.ratios.size(); ++i) {
+        const PointResult r = run_point(opt, opt.ratios[i], i == 0);
+        results.push_back(r);
+        const double bits = 32.0 * opt.reads;
+        printf("%7.3f %10.3f %7s %3d/%-3d %10.3f %12llu %10.1f %9.1f %s\n", r.ratio, r.tckc_mhz,
+               r.online ? "yes" : "NO", r.good_reads, opt.reads, bits / ((double)r.sim_ps / 1e6),
+               (unsigned long long)r.evals, (double)r.evals / bits, r.wall_ms,
+               r.good_reads == opt.reads ? "✓" : "✗");
+        fflush(stdout);
+    }
+
+    // Boundary: lowest ratio such that it and every higher ratio passed
+    double boundary = 0.0;
+    bool   all_above = true;
+    std::vector<PointResult> sorted = results;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const PointResult& a, const PointResult& b) { return a.ratio > b.ratio; });
+    for (const PointResult& r : sorted) {
+        if (r.good_reads != opt.reads) {
+            all_above = false;
+            break;
+        }
+        boundary = r.ratio;
+    }
+
+    printf("========================================\n");
+    if (boundary > 0.0) {
+        printf("Failure boundary: passes at ratio >= %.3f (TCKC <= %.3f MHz at clk_i %.3f MHz)\n", boundary,
+               opt.clk_mhz / boundary, opt.clk_mhz);
+    } else {
+        printf("Failure boundary: no passing ratio in the sweep\n");
+    }
+    if (all_above) printf("(every point in the sweep passed)\n");
+    printf("========================================\n");
+    if (opt.switches > 0) {
+        // Escapes pack up to 8 toggles into one TCKC period: use the slowest TCKC
+        run_switch_bench(opt, *std::max_element(opt.ratios.begin(), opt.ratios.end()));
+        printf("========================================\n");
+    }
+    if (opt.loopback > 0) {
+        run_loop_bench(opt);
+        printf("========================================\n");
+    }
+    return boundary > 0.0 ? 0 : 1;
+}
@@ -0,0 +1,730 @@
+// =============================================================================
+// Bit-Sliced Reference Model of cjtag_bridge
+// =============================================================================
+// One independent bridge per bit of a lane word W: uint64_t holds 64 bridges,
+// the GCC vector types Lanes256 / Lanes512 hold 256 / 512 (AVX2 / AVX-512
+// registers when the target has them, pairs of 64-bit ops otherwise).
+//
+// Every register of src/cjtag/cjtag_bridge.sv is stored as bit planes
+// (plane i = bit i of that register in every lane), and step() evaluates one
+// clk_i rising edge for all lanes with bitwise operations only.  The model
+// covers the input synchronizers, edge detectors, escape toggle counter,
+// state machine, activation / CRC / vendor-frame datapath, TAP mirror and
+// GOTO walk, VCMD_POLL engine, loopback, output block and RTCK.  Each `if`
+// of the RTL becomes a lane mask, and each nonblocking assignment becomes a
+// masked write into the next-state copy, in RTL statement order (so the
+// last assignment wins).
+//
+// Scope: the default build (CP not checked, no CJTAG_STRICT_CP_CHECK) and no
+// TAP, so tmsc_o is only modelled inside vendor frames (vcmd_resp[0]) and
+// loopback sessions (loop_bit); in a TDO slot it is whatever the TAP drives.
+// The TAP's combinational TDO is an input of step(), sampled only by the
+// poll engine.  tb/fuzz_bitslice.cpp runs lanes of this model against the
+// Verilated RTL cycle by cycle (--check) and fails on the first register
+// that differs; any RTL change to the bridge must be mirrored here.
+// =============================================================================
+
+#ifndef BITSLICE_BRIDGE_H
+#define BITSLICE_BRIDGE_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint64_t Lanes64;
+typedef uint64_t Lanes256 __attribute__((vector_size(32)));
+typedef uint64_t Lanes512 __attribute__((vector_size(64)));
+
+// ─── Lane-word helpers ───────────────────────────────────────────────────────
+template <typename W> static inline W bs_zero() { return W{}; }
+template <typename W> static inline W bs_ones() { return ~W{}; }
+
+template <typename W> static inline int bs_words() { return (int)(sizeof(W) / 8); }
+
+template <typename W> static inline uint64_t bs_word(const W& v, int i) {
+    uint64_t w;
+    memcpy(&w, reinterpret_cast<const char*>(&v) + 8 * i, 8);
+    return w;
+}
+
+template <typename W> static inline void bs_set_word(W& v, int i, uint64_t w) {
+    memcpy(reinterpret_cast<char*>(&v) + 8 * i, &w, 8);
+}
+
+template <typename W> static inline bool bs_any(const W& v) {
+    for (int i = 0; i < bs_words<W>(); ++i) {
+        if (bs_word(v, i)) return true;
+    }
+    return false;
+}
+
+template <typename W> static inline unsigned bs_count(const W& v) {
+    unsigned n = 0;
+    for (int i = 0; i < bs_words<W>(); ++i) n += (unsigned)__builtin_popcountll(bs_word(v, i));
+    return n;
+}
+
+template <typename W> static inline bool bs_lane(const W& v, int lane) {
+    return (bs_word(v, lane >> 6) >> (lane & 63)) & 1;
+}
+
+template <typename W> static inline void bs_set_lane(W& v, int lane, bool b) {
+    uint64_t w = bs_word(v, lane >> 6);
+    const uint64_t bit = 1ull << (lane & 63);
+    bs_set_word(v, lane >> 6, b ? (w | bit) : (w & ~bit));
+}
+
+// ─── Multi-bit register helpers (n planes, LSB first) ────────────────────────
+// Lanes where the register equals / is below constant v
+template <typename W> static inline W bs_eq(const W* p, int n, unsigned v) {
+    W m = bs_ones<W>();
+    for (int i = 0; i < n; ++i) m &= ((v >> i) & 1) ? p[i] : ~p[i];
+    return m;
+}
+
+template <typename W> static inline W bs_lt(const W* p, int n, unsigned v) {
+    W lt = bs_zero<W>(), eq = bs_ones<W>();
+    for (int i = n - 1; i >= 0; --i) {
+        if ((v >> i) & 1) {
+            lt |= eq & ~p[i];
+            eq &= p[i];
+        } else {
+            eq &= ~p[i];
+        }
+    }
+    return lt;
+}
+
+// dst <= v in lanes m
+template <typename W> static inline void bs_set(W* dst, int n, unsigned v, W m) {
+    for (int i = 0; i < n; ++i) dst[i] = ((v >> i) & 1) ? (dst[i] | m) : (dst[i] & ~m);
+}
+
+// dst <= src in lanes m
+template <typename W> static inline void bs_mux(W* dst, const W* src, int n, W m) {
+    for (int i = 0; i < n; ++i) dst[i] = (dst[i] & ~m) | (src[i] & m);
+}
+
+template <typename W> static inline void bs_mux1(W& dst, W src, W m) { dst = (dst & ~m) | (src & m); }
+
+// Lanes where registers a and b are equal / a >= b
+template <typename W> static inline W bs_eq_reg(const W* a, const W* b, int n) {
+    W m = bs_ones<W>();
+    for (int i = 0; i < n; ++i) m &= ~(a[i] ^ b[i]);
+    return m;
+}
+
+template <typename W> static inline W bs_ge_reg(const W* a, const W* b, int n) {
+    W borrow = bs_zero<W>();
+    for (int i = 0; i < n; ++i) borrow = (~a[i] & (b[i] | borrow)) | (a[i] & b[i] & borrow);
+    return ~borrow;
+}
+
+// dst = a - b (wrapping), all lanes
+template <typename W> static inline void bs_sub(W* dst, const W* a, const W* b, int n) {
+    W borrow = bs_zero<W>();
+    for (int i = 0; i < n; ++i) {
+        dst[i] = a[i] ^ b[i] ^ borrow;
+        borrow = (~a[i] & (b[i] | borrow)) | (a[i] & b[i] & borrow);
+    }
+}
+
+// dst <= src + 1 (wrapping) in lanes m
+template <typename W> static inline void bs_inc(W* dst, const W* src, int n, W m) {
+    W carry = m;
+    for (int i = 0; i < n; ++i) {
+        dst[i] = (dst[i] & ~m) | ((src[i] ^ carry) & m);
+        carry &= src[i];
+    }
+}
+
+// dst <= crc16_step(crc, bit) in lanes m (CRC-16/CCITT 0x1021, MSB first)
+template <typename W> static inline void bs_crc16(W* dst, const W* crc, W bit, W m) {
+    const W fb = crc[15] ^ bit;
+    W next[16];
+    next[0] = fb;
+    for (int i = 1; i < 16; ++i) next[i] = (i == 5 || i == 12) ? (crc[i - 1] ^ fb) : crc[i - 1];
+    bs_mux(dst, next, 16, m);
+}
+
+// ─── TAP tables (tap_next() / goto_tms() of cjtag_bridge.sv) ─────────────────
+static const uint8_t BS_TAP_NEXT[16][2] = {  // [state][tms]
+    {0x1, 0x0}, {0x1, 0x2}, {0x3, 0x9}, {0x4, 0x5}, {0x4, 0x5}, {0x6, 0x8}, {0x6, 0x7}, {0x4, 0x8},
+    {0x1, 0x2}, {0xA, 0x0}, {0xB, 0xC}, {0xB, 0xC}, {0xD, 0xF}, {0xD, 0xE}, {0xB, 0xF}, {0x1, 0x2},
+};
+static const uint16_t BS_GOTO_TMS[16] = {  // bit tgt = first TMS from state
+    0x0000, 0xFFFD, 0xFE03, 0xFFE7, 0xFFEF, 0xFF0F, 0xFFBF, 0xFF0F,
+    0xFEFD, 0x01FF, 0xF3FF, 0xF7FF, 0x87FF, 0xDFFF, 0x87FF, 0x7FFD,
+};
+
+// dst <= tap_next(s, tms) in lanes m
+template <typename W> static inline void bs_tap_next(W* dst, const W* s, W tms, W m) {
+    W next[4] = {};
+    for (unsigned v = 0; v < 16; ++v) {
+        const W d = bs_eq(s, 4, v);
+        for (int i = 0; i < 4; ++i) {
+            const W hi = ((BS_TAP_NEXT[v][1] >> i) & 1) ? tms : bs_zero<W>();
+            const W lo = ((BS_TAP_NEXT[v][0] >> i) & 1) ? ~tms : bs_zero<W>();
+            next[i] |= d & (hi | lo);
+        }
+    }
+    bs_mux(dst, next, 4, m);
+}
+
+// goto_tms(s, tgt): Test-Logic-Reset is always TMS=1
+template <typename W> static inline W bs_goto_tms(const W* s, const W* tgt) {
+    W ds[16];
+    for (unsigned v = 0; v < 16; ++v) ds[v] = bs_eq(s, 4, v);
+    W tms = bs_eq(tgt, 4, 0);
+    for (unsigned t = 1; t < 16; ++t) {
+        W col = bs_zero<W>();
+        for (unsigned v = 0; v < 16; ++v) {
+            if ((BS_GOTO_TMS[v] >> t) & 1) col |= ds[v];
+        }
+        tms |= bs_eq(tgt, 4, t) & col;
+    }
+    return tms;
+}
+
+// goto_tms(s, tgt) for a constant target tgt != Test-Logic-Reset
+template <typename W> static inline W bs_goto_tms_to(const W* s, unsigned tgt) {
+    W tms = bs_zero<W>();
+    for (unsigned v = 0; v < 16; ++v) {
+        if ((BS_GOTO_TMS[v] >> tgt) & 1) tms |= bs_eq(s, 4, v);
+    }
+    return tms;
+}
+
+// Scalar value of an n-plane register in one lane
+template <typename W> static inline uint32_t bs_value(const W* p, int n, int lane) {
+    uint32_t v = 0;
+    for (int i = 0; i < n; ++i) v |= (uint32_t)bs_lane(p[i], lane) << i;
+    return v;
+}
+
+// ─── Registers ───────────────────────────────────────────────────────────────
+// Only W members, so the struct is also an array of planes (reset()).
+template <typename W>
+struct BitsliceRegs {
+    // Synchronizers and edge detection
+    W tckc_sync[2], tmsc_sync[2];
+    W tckc_prev, tmsc_prev, tckc_posedge, tckc_negedge, tmsc_edge;
+    // Escape detection
+    W tckc_is_high, tmsc_toggle_count[5];
+    // State machine
+    W state[3], return_state[3];
+    W activation_shift[11], activation_count[4], bit_pos[2], tmsc_sampled;
+    W vext_en, vcmd_count[8], vcmd_op[8], vcmd_resp[40], crc_tdi[16], crc_tms[16];
+    W retain_en, ctx_valid, ctx_vext;
+    W goto_count[3], goto_tgt[4];
+    W poll_arg[88];
+    W verify_en, verify_exp, verify_tdo, verify_fail, verify_count[16], verify_first[16];
+    W loop_mode[2], loop_prbs[15], loop_bit, loop_count[24], loop_errors[16];
+    // Output block and RTCK
+    W tck, tms, tdi, tmsc_oen, tck_rise_req, tck_fall_req, rtck;
+    W tap_mirror[4], goto_steps[4];
+    W scan_tdi[64], scan_len[7];
+    W poll_phase[3], poll_cnt[8], poll_tries[8], poll_tdo[32];
+};
+
+// Lane masks of what happened in the last step(), for coverage and checks
+template <typename W>
+struct BitsliceEvents {
+    W old_state[3];            // state before the edge
+    W escape_eval;             // ST_ESCAPE evaluated this cycle ...
+    W escape_toggles[5];       // ... with this toggle count
+    W escape_from[3];          // ... and this return_state
+    W select, resume, deselect, reset_escape, invalid_escape;
+    W ctx_saved;               // deselection that kept a context
+    W act_valid, act_invalid, act_escape;
+    W oscan1_escape, tdo_window;
+    W vcmd_enter, vcmd_crc_read, vcmd_done, vcmd_escape;
+    W goto_enter, goto_done, goto_escape;
+    W poll_start, poll_scan, poll_done, poll_escape;
+    W verify_on, verify_mismatch, verify_end;
+    W loop_start, loop_error, loop_end;
+    W toggle_wrap;             // toggle counter wrapped 31 -> 0
+};
+
+// ─── Model ───────────────────────────────────────────────────────────────────
+template <typename W>
+class BitsliceBridge {
+public:
+    static const int LANES = (int)sizeof(W) * 8;
+
+    // state_t encodings of cjtag_bridge.sv
+    enum { ST_OFFLINE = 0, ST_ESCAPE = 1, ST_ONLINE_ACT = 2, ST_OSCAN1 = 3, ST_VCMD = 4, ST_GOTO = 5 };
+    enum { POLL_OFF = 0, POLL_NAV = 1, POLL_SHIFT = 2, POLL_RETURN = 3, POLL_WAIT = 4, POLL_DONE = 5 };
+    enum { TAP_RTI = 0x1, TAP_CAPDR = 0x3, TAP_SHDR = 0x4 };
+    enum { LOOP_OFF = 0, LOOP_ECHO = 1, LOOP_PRBS = 2 };
+
+    BitsliceRegs<W>   r;
+    BitsliceEvents<W> ev;
+
+    BitsliceBridge() {
+        memset(&r, 0, sizeof r);
+        memset(&ev, 0, sizeof ev);
+        reset(bs_ones<W>());
+    }
+
+    // Asynchronous nTRST for lanes m: every register to its reset value
+    void reset(W m) {
+        W* p = reinterpret_cast<W*>(&r);
+        const int n = (int)(sizeof r / sizeof(W));
+        for (int i = 0; i < n; ++i) p[i] &= ~m;
+        r.tms |= m;
+        r.tmsc_oen |= m;
+        for (int i = 0; i < 16; ++i) {
+            r.crc_tdi[i] |= m;
+            r.crc_tms[i] |= m;
+        }
+    }
+
+    W in_state(unsigned s) const { return bs_eq(r.state, 3, s); }
+    W online() const { return in_state(ST_OSCAN1) | in_state(ST_VCMD) | in_state(ST_GOTO); }
+    W tmsc_o_vcmd() const { return ~r.tmsc_oen & in_state(ST_VCMD) & r.vcmd_resp[0]; }
+    W loop_on() const { return r.loop_mode[0] | r.loop_mode[1]; }
+    W tmsc_o_loop() const { return ~r.tmsc_oen & ~in_state(ST_VCMD) & loop_on() & r.loop_bit; }
+
+    // One clk_i rising edge with tckc_i / tmsc_i applied to every lane;
+    // tdo_i is the TAP's combinational TDO before the edge
+    void step(W tckc_i, W tmsc_i, W tdo_i = W{}) {
+        const BitsliceRegs<W> c = r;  // registers before the edge
+        BitsliceRegs<W>&      n = r;  // nonblocking targets
+
+        // ─── Synchronizers and edge detection ───
+        const W tckc_s = c.tckc_sync[1];
+        const W tmsc_s = c.tmsc_sync[1];
+        n.tckc_sync[0] = tckc_i;
+        n.tckc_sync[1] = c.tckc_sync[0];
+        n.tmsc_sync[0] = tmsc_i;
+        n.tmsc_sync[1] = c.tmsc_sync[0];
+        n.tckc_prev    = tckc_s;
+        n.tmsc_prev    = tmsc_s;
+        n.tckc_posedge = ~c.tckc_prev & tckc_s;
+        n.tckc_negedge = c.tckc_prev & ~tckc_s;
+        n.tmsc_edge    = c.tmsc_prev ^ tmsc_s;
+
+        const W pos = c.tckc_posedge;
+        const W neg = c.tckc_negedge;
+
+        // ─── Escape toggle counter ───
+        n.tckc_is_high |= pos;
+        bs_set(n.tmsc_toggle_count, 5, 0, pos);
+        n.tckc_is_high &= ~(neg & ~pos);
+        const W count_en = ~pos & ~neg & c.tckc_is_high & tckc_s & c.tmsc_edge;
+        bs_inc(n.tmsc_toggle_count, c.tmsc_toggle_count, 5, count_en);
+        ev.toggle_wrap = count_en & bs_eq(c.tmsc_toggle_count, 5, 31);
+
+        const W* t   = c.tmsc_toggle_count;
+        const W ge4  = t[4] | t[3] | t[2];
+        const W ge8  = t[4] | t[3];
+        const W lo8  = ~t[4] & ~t[3];
+        const W is2  = lo8 & ~t[2] & t[1] & ~t[0];
+        const W is3  = lo8 & ~t[2] & t[1] & t[0];
+        const W is45 = lo8 & t[2] & ~t[1];
+        const W is67 = lo8 & t[2] & t[1];
+        const W is7  = is67 & t[0];
+
+        // ─── State machine ───
+        const W st_off  = bs_eq(c.state, 3, ST_OFFLINE);
+        const W st_esc  = bs_eq(c.state, 3, ST_ESCAPE);
+        const W st_act  = bs_eq(c.state, 3, ST_ONLINE_ACT);
+        const W st_osc  = bs_eq(c.state, 3, ST_OSCAN1);
+        const W st_vcmd = bs_eq(c.state, 3, ST_VCMD);
+        const W st_goto = bs_eq(c.state, 3, ST_GOTO);
+        const W st_bad  = ~(st_off | st_esc | st_act | st_osc | st_vcmd | st_goto);
+        for (int i = 0; i < 3; ++i) ev.old_state[i] = c.state[i];
+
+        const W bp0 = bs_eq(c.bit_pos, 2, 0);
+        const W bp1 = bs_eq(c.bit_pos, 2, 1);
+        const W bp2 = bs_eq(c.bit_pos, 2, 2);
+        const W bp3 = bs_eq(c.bit_pos, 2, 3);
+
+        // OFFLINE
+        n.vext_en &= ~st_off;
+        n.retain_en &= ~st_off;
+        n.verify_en &= ~st_off;
+        bs_set(n.loop_mode, 2, LOOP_OFF, st_off);
+        const W off_esc = st_off & neg & ge4;
+        bs_set(n.return_state, 3, ST_OFFLINE, off_esc);
+        bs_set(n.state, 3, ST_ESCAPE, off_esc);
+
+        // ESCAPE
+        const W rs_off  = bs_eq(c.return_state, 3, ST_OFFLINE);
+        const W rs_osc  = bs_eq(c.return_state, 3, ST_OSCAN1);
+        const W e_reset = st_esc & ge8;
+        const W e_res   = st_esc & is7 & rs_off & c.ctx_valid;
+        const W e_sel   = st_esc & ~e_res & is67 & rs_off;
+        const W e_desel = st_esc & is45 & rs_osc;
+        const W e_inv   = st_esc & ~(e_reset | e_res | e_sel | e_desel);
+        const W e_off   = e_reset | e_desel | e_inv;
+        bs_set(n.state, 3, ST_OFFLINE, e_off);
+        bs_set(n.activation_shift, 11, 0, e_off | e_sel);
+        bs_set(n.activation_count, 4, 0, e_off | e_sel);
+        bs_set(n.bit_pos, 2, 0, e_off | e_res);
+        n.ctx_valid &= ~(e_reset | e_inv | e_sel | e_res);
+        bs_mux1(n.ctx_valid, c.retain_en, e_desel);
+        bs_mux1(n.ctx_vext, c.vext_en, e_desel);
+        bs_set(n.state, 3, ST_OSCAN1, e_res);
+        bs_mux1(n.vext_en, c.ctx_vext, e_res);
+        n.retain_en |= e_res;
+        bs_set(n.crc_tdi, 16, 0xFFFF, e_res);
+        bs_set(n.crc_tms, 16, 0xFFFF, e_res);
+        bs_set(n.state, 3, ST_ONLINE_ACT, e_sel);
+
+        ev.escape_eval = st_esc;
+        for (int i = 0; i < 5; ++i) ev.escape_toggles[i] = t[i];
+        for (int i = 0; i < 3; ++i) ev.escape_from[i] = c.return_state[i];
+        ev.select         = e_sel;
+        ev.resume         = e_res;
+        ev.deselect       = e_desel;
+        ev.reset_escape   = e_reset;
+        ev.invalid_escape = e_inv;
+        ev.ctx_saved      = e_desel & c.retain_en;
+
+        // ONLINE_ACT
+        const W a_esc = st_act & neg & ge4;
+        bs_set(n.return_state, 3, ST_ONLINE_ACT, a_esc);
+        bs_set(n.state, 3, ST_ESCAPE, a_esc);
+        const W a_pos = st_act & ~a_esc & pos;
+        for (int i = 0; i < 10; ++i) bs_mux1(n.activation_shift[i], c.activation_shift[i + 1], a_pos);
+        bs_mux1(n.activation_shift[10], tmsc_s, a_pos);
+        bs_set(n.activation_shift, 11, 0, a_esc);
+        const W a_last = a_pos & bs_eq(c.activation_count, 4, 11);
+        // OAC == 1100 and EC == 10RV; CP unchecked
+        const W a_ok   = bs_eq(c.activation_shift, 4, 0xC) & c.activation_shift[7] & ~c.activation_shift[6];
+        const W a_good = a_last & a_ok;
+        const W a_bad  = a_last & ~a_ok;
+        bs_set(n.state, 3, ST_OSCAN1, a_good);
+        bs_set(n.bit_pos, 2, 0, a_good);
+        bs_mux1(n.vext_en, c.activation_shift[4], a_good);
+        bs_mux1(n.retain_en, c.activation_shift[5], a_good);
+        bs_set(n.crc_tdi, 16, 0xFFFF, a_good);
+        bs_set(n.crc_tms, 16, 0xFFFF, a_good);
+        bs_set(n.state, 3, ST_OFFLINE, a_bad);
+        bs_set(n.activation_count, 4, 0, a_last | a_esc);
+        bs_inc(n.activation_count, c.activation_count, 4, a_pos & ~a_last);
+        ev.act_valid   = a_good;
+        ev.act_invalid = a_bad;
+        ev.act_escape  = a_esc;
+
+        // OSCAN1
+        const W o_esc = st_osc & neg & ge4;
+        bs_set(n.return_state, 3, ST_OSCAN1, o_esc);
+        bs_set(n.state, 3, ST_ESCAPE, o_esc);
+        const W o_vcmd = st_osc & ~o_esc & neg & c.vext_en & bp0 & is2;
+        bs_set(n.state, 3, ST_VCMD, o_vcmd);
+        bs_set(n.vcmd_count, 8, 0, o_vcmd);
+        bs_set(n.vcmd_op, 8, 0, o_vcmd);
+        const W o_goto = st_osc & ~o_esc & ~o_vcmd & neg & c.vext_en & bp0 & is3;
+        bs_set(n.state, 3, ST_GOTO, o_goto);
+        bs_set(n.goto_count, 3, 0, o_goto);
+        bs_set(n.goto_tgt, 4, 0, o_goto);
+        const W o_pos = st_osc & ~o_esc & ~o_vcmd & pos;
+        bs_mux1(n.tmsc_sampled, tmsc_s, o_pos);
+        bs_crc16(n.crc_tdi, c.crc_tdi, tmsc_s, o_pos & c.vext_en & bp0);
+        bs_crc16(n.crc_tms, c.crc_tms, tmsc_s, o_pos & c.vext_en & bp1);
+        // Verify packets: expected TDO in slot 2, mask in slot 3
+        const W o_exp = o_pos & c.verify_en & bp2;
+        bs_mux1(n.verify_exp, tmsc_s, o_exp);
+        bs_mux1(n.verify_tdo, tdo_i, o_exp);
+        const W o_mask = o_pos & c.verify_en & bp3;
+        const W o_bad  = o_mask & tmsc_s & (c.verify_tdo ^ c.verify_exp);
+        n.verify_fail |= o_bad;
+        bs_mux(n.verify_first, c.verify_count, 16, o_bad & ~c.verify_fail);
+        bs_inc(n.verify_count, c.verify_count, 16, o_mask & ~bs_eq(c.verify_count, 16, 0xFFFF));
+        // Loopback: latch this packet's TDO slot bit from the nTDI slot
+        const W l_echo = bs_eq(c.loop_mode, 2, LOOP_ECHO);
+        const W l_prbs = bs_eq(c.loop_mode, 2, LOOP_PRBS);
+        const W o_loop = o_pos & ~bs_eq(c.loop_mode, 2, LOOP_OFF) & bp0;
+        bs_mux1(n.loop_bit, (l_echo & tmsc_s) | (~l_echo & c.loop_prbs[14]), o_loop);
+        const W o_prbs = o_loop & l_prbs;
+        W prbs_next[15];
+        prbs_next[0] = c.loop_prbs[14] ^ c.loop_prbs[13];
+        for (int i = 1; i < 15; ++i) prbs_next[i] = c.loop_prbs[i - 1];
+        bs_mux(n.loop_prbs, prbs_next, 15, o_prbs);
+        const W o_lerr = o_prbs & (tmsc_s ^ c.loop_prbs[14]);
+        bs_inc(n.loop_errors, c.loop_errors, 16, o_lerr & ~bs_eq(c.loop_errors, 16, 0xFFFF));
+        bs_inc(n.loop_count, c.loop_count, 24, o_loop & ~bs_eq(c.loop_count, 24, 0xFFFFFF));
+        // 0 -> 1 -> 2 -> 0, or 2 -> 3 -> 0 in a verify session
+        const W bp_v       = bp2 & c.verify_en;
+        const W bp_next[2] = {(~c.bit_pos[1] & ~c.bit_pos[0]) | bp_v, (~c.bit_pos[1] & c.bit_pos[0]) | bp_v};
+        bs_mux(n.bit_pos, bp_next, 2, o_pos);
+        ev.oscan1_escape = o_esc;
+        ev.vcmd_enter    = o_vcmd;
+        ev.goto_enter    = o_goto;
+        ev.verify_mismatch = o_bad;
+        ev.loop_error      = o_lerr;
+
+        // VCMD
+        const W p_off     = bs_eq(c.poll_phase, 3, POLL_OFF);
+        const W poll_done = bs_eq(c.poll_phase, 3, POLL_DONE) & ~c.tck;
+        const W v_esc = st_vcmd & neg & ge4;
+        bs_set(n.return_state, 3, ST_OSCAN1, v_esc);
+        bs_set(n.state, 3, ST_ESCAPE, v_esc);
+        bs_set(n.vcmd_count, 8, 0, v_esc);
+        // TCKC edges are not taken while the poll engine owns TCK
+        const W v_load = st_vcmd & ~v_esc & ~p_off & poll_done;
+        bs_mux(n.vcmd_resp, c.poll_tdo, 32, v_load);
+        bs_mux(n.vcmd_resp + 32, c.poll_tries, 8, v_load);
+        const W v_pos     = st_vcmd & ~v_esc & p_off & pos;
+        const W v_lt8     = ~(c.vcmd_count[7] | c.vcmd_count[6] | c.vcmd_count[5] | c.vcmd_count[4] | c.vcmd_count[3]);
+        const W v_is_crc  = bs_eq(c.vcmd_op, 8, 0x01);
+        const W v_is_poll = bs_eq(c.vcmd_op, 8, 0x04);
+        const W v_is_vend = bs_eq(c.vcmd_op, 8, 0x0C);
+        const W v_is_lend = bs_eq(c.vcmd_op, 8, 0x24);
+        const W v_op      = v_pos & v_lt8;
+        const W v_arg     = v_pos & ~v_lt8 & v_is_poll & bs_lt(c.vcmd_count, 8, 96);
+        const W v_resp    = v_pos & ~v_lt8 & ~v_arg;
+        for (int i = 0; i < 7; ++i) bs_mux1(n.vcmd_op[i], c.vcmd_op[i + 1], v_op);
+        bs_mux1(n.vcmd_op[7], tmsc_s, v_op);
+        for (int i = 0; i < 87; ++i) bs_mux1(n.poll_arg[i], c.poll_arg[i + 1], v_arg);
+        bs_mux1(n.poll_arg[87], tmsc_s, v_arg);
+        for (int i = 0; i < 39; ++i) bs_mux1(n.vcmd_resp[i], c.vcmd_resp[i + 1], v_resp);
+        n.vcmd_resp[39] &= ~v_resp;
+        // Opcode complete on the 8th bit: {tmsc_s, vcmd_op[7:1]} == VCMD_CRC_READ?
+        const W v_c7       = v_pos & bs_eq(c.vcmd_count, 8, 7);
+        const W v_next_crc = bs_eq(c.vcmd_op + 1, 7, 0x01) & ~tmsc_s;
+        const W v_crc      = v_c7 & v_next_crc;
+        bs_mux(n.vcmd_resp, c.crc_tdi, 16, v_crc);
+        bs_mux(n.vcmd_resp + 16, c.crc_tms, 16, v_crc);
+        bs_set(n.vcmd_resp + 32, 8, 0, v_crc);
+        bs_set(n.vcmd_resp, 40, 0, v_c7 & ~v_next_crc);
+        bs_set(n.crc_tdi, 16, 0xFFFF, v_crc);
+        bs_set(n.crc_tms, 16, 0xFFFF, v_crc);
+        const W v_von  = v_c7 & bs_eq(c.vcmd_op + 1, 7, 0x08) & ~tmsc_s;
+        const W v_vend = v_c7 & bs_eq(c.vcmd_op + 1, 7, 0x0C) & ~tmsc_s;
+        n.verify_en |= v_von;
+        n.verify_fail &= ~v_von;
+        bs_set(n.verify_count, 16, 0, v_von);
+        bs_set(n.verify_first, 16, 0, v_von);
+        bs_mux(n.vcmd_resp, c.verify_first, 16, v_vend);
+        bs_mux(n.vcmd_resp + 16, c.verify_count, 16, v_vend);
+        bs_mux1(n.vcmd_resp[32], c.verify_fail, v_vend);
+        n.verify_en &= ~v_vend;
+        bs_set(n.loop_mode, 2, LOOP_OFF, v_von);
+        // LOOP_ECHO (0x20) / LOOP_PRBS (0x21): opcode bit 0 is vcmd_op[1]
+        const W v_lstart = v_c7 & bs_eq(c.vcmd_op + 2, 6, 0x10) & ~tmsc_s;
+        const W v_lend   = v_c7 & bs_eq(c.vcmd_op + 1, 7, 0x24) & ~tmsc_s;
+        bs_mux1(n.loop_mode[0], ~c.vcmd_op[1], v_lstart);
+        bs_mux1(n.loop_mode[1], c.vcmd_op[1], v_lstart);
+        bs_set(n.loop_prbs, 15, 0x7FFF, v_lstart);
+        bs_set(n.loop_count, 24, 0, v_lstart);
+        bs_set(n.loop_errors, 16, 0, v_lstart);
+        n.verify_en &= ~v_lstart;
+        bs_mux(n.vcmd_resp, c.loop_count, 24, v_lend);
+        bs_mux(n.vcmd_resp + 24, c.loop_errors, 16, v_lend);
+        bs_set(n.loop_mode, 2, LOOP_OFF, v_lend);
+        // Frame end: vcmd_count == vcmd_frame_len(vcmd_op) - 1
+        const W v_last = ((v_is_crc | v_is_vend) & bs_eq(c.vcmd_count, 8, 41)) |
+                         (v_is_poll & bs_eq(c.vcmd_count, 8, 137)) | (v_is_lend & bs_eq(c.vcmd_count, 8, 47)) |
+                         (~v_is_crc & ~v_is_poll & ~v_is_vend & ~v_is_lend & bs_eq(c.vcmd_count, 8, 8));
+        const W v_end  = v_pos & ~v_lt8 & v_last;
+        bs_set(n.state, 3, ST_OSCAN1, v_end);
+        bs_set(n.bit_pos, 2, 0, v_end);
+        bs_set(n.vcmd_count, 8, 0, v_end);
+        bs_inc(n.vcmd_count, c.vcmd_count, 8, v_pos & ~v_end);
+        const W v_run = v_pos & v_is_poll & bs_eq(c.vcmd_count, 8, 95);
+        ev.vcmd_crc_read = v_crc;
+        ev.vcmd_done     = v_end;
+        ev.vcmd_escape   = v_esc;
+        ev.poll_start    = v_run;
+        ev.poll_done     = v_load;
+        ev.poll_escape   = v_esc & ~p_off;
+        ev.poll_scan     = bs_zero<W>();
+        ev.verify_on     = v_von;
+        ev.verify_end    = v_vend;
+        ev.loop_start    = v_lstart;
+        ev.loop_end      = v_lend;
+
+        // GOTO
+        const W g_tlr  = bs_eq(c.goto_tgt, 4, 0);
+        W g_at = bs_ones<W>();
+        for (int i = 0; i < 4; ++i) g_at &= ~(c.tap_mirror[i] ^ c.goto_tgt[i]);
+        const W g_done = ~c.tck & ((g_tlr & bs_eq(c.goto_steps, 4, 5)) | (~g_tlr & g_at));
+        const W g_esc  = st_goto & neg & ge4;
+        bs_set(n.return_state, 3, ST_OSCAN1, g_esc);
+        bs_set(n.state, 3, ST_ESCAPE, g_esc);
+        bs_set(n.goto_count, 3, 0, g_esc);
+        const W g_walk = st_goto & ~g_esc & bs_eq(c.goto_count, 3, 6);
+        const W g_end  = g_walk & g_done;
+        bs_set(n.state, 3, ST_OSCAN1, g_end);
+        bs_set(n.bit_pos, 2, 0, g_end);
+        bs_set(n.goto_count, 3, 0, g_end);
+        const W g_pos = st_goto & ~g_esc & ~g_walk & pos;
+        const W g_bit = g_pos & ~bs_eq(c.goto_count, 3, 1) & ~bs_eq(c.goto_count, 3, 4);
+        for (int i = 0; i < 3; ++i) bs_mux1(n.goto_tgt[i], c.goto_tgt[i + 1], g_bit);
+        bs_mux1(n.goto_tgt[3], tmsc_s, g_bit);
+        bs_inc(n.goto_count, c.goto_count, 3, g_pos);
+        ev.goto_done   = g_end;
+        ev.goto_escape = g_esc;
+
+        // Undefined encodings
+        bs_set(n.state, 3, ST_OFFLINE, st_bad);
+
+        // ─── Output block (case on the old state) ───
+        const W idle = st_off | st_act | st_esc | st_bad;
+        n.tck &= ~idle;
+        n.tms |= idle;
+        n.tdi &= ~idle;
+        n.tmsc_oen |= idle;
+        n.tck_rise_req &= ~idle;
+        n.tck_fall_req &= ~idle;
+        bs_set(n.poll_phase, 3, POLL_OFF, idle);
+
+        const W op = st_osc & pos;
+        n.tck &= ~(op & bp0);
+        n.tmsc_oen |= op & (bp0 | bp1 | bp2 | bp3);
+        bs_mux1(n.tdi, ~c.tmsc_sampled, op & bp1);
+        n.tck_fall_req |= op & bp2;
+        const W tdo_open = st_osc & neg & bp2;
+        bs_mux1(n.tms, c.tmsc_sampled, tdo_open);
+        n.tck_rise_req |= tdo_open & bs_eq(c.loop_mode, 2, LOOP_OFF);  // loopback parks TCK
+        n.tmsc_oen &= ~(tdo_open & ~c.verify_en);  // EXP slot stays an input
+        const W rise = st_osc & c.tck_rise_req;
+        n.tck |= rise;
+        n.tck_rise_req &= ~rise;
+        bs_tap_next(n.tap_mirror, c.tap_mirror, c.tms, rise);
+        // Record the DR scan for VCMD_POLL
+        const W rec_cap = rise & c.vext_en & bs_eq(c.tap_mirror, 4, TAP_CAPDR);
+        const W rec_sh  = rise & c.vext_en & bs_eq(c.tap_mirror, 4, TAP_SHDR) & bs_lt(c.scan_len, 7, 65);
+        bs_set(n.scan_len, 7, 0, rec_cap);
+        if (bs_any(rec_sh)) {
+            for (unsigned i = 0; i < 64; ++i) bs_mux1(n.scan_tdi[i], c.tdi, rec_sh & bs_eq(c.scan_len, 7, i));
+            bs_inc(n.scan_len, c.scan_len, 7, rec_sh);
+        }
+        const W fall = st_osc & c.tck_fall_req;
+        n.tck &= ~fall;
+        n.tck_fall_req &= ~fall;
+        ev.tdo_window = tdo_open & ~c.verify_en;
+
+        n.tck_rise_req &= ~st_vcmd;
+        n.tck_fall_req &= ~st_vcmd;
+        const W pv      = st_vcmd & p_off;
+        n.tck &= ~pv;
+        const W v_drive = pv & neg &
+                          ((v_is_crc & ~v_lt8 & bs_lt(c.vcmd_count, 8, 40)) |
+                           (v_is_poll & ~bs_lt(c.vcmd_count, 8, 96) & bs_lt(c.vcmd_count, 8, 136)) |
+                           (v_is_vend & ~v_lt8 & bs_lt(c.vcmd_count, 8, 41)) |
+                           (v_is_lend & ~v_lt8 & bs_lt(c.vcmd_count, 8, 48)));
+        n.tmsc_oen &= ~v_drive;
+        n.tmsc_oen |= pv & ~v_drive & pos;
+        // Last operand bit: start the engine
+        const W p_start = pv & pos & v_is_poll & bs_eq(c.vcmd_count, 8, 95);
+        if (bs_any(p_start)) {
+            bs_set(n.poll_cnt, 8, 0, p_start);
+            bs_set(n.poll_tries, 8, 0, p_start);
+            bs_set(n.poll_tdo, 32, 0, p_start);
+            const W empty  = bs_eq(c.scan_len, 7, 0) | ~bs_lt(c.scan_len, 7, 65) |
+                             (~tmsc_s & bs_eq(c.poll_arg + 81, 7, 0));
+            const W at_cap = ~empty & bs_eq(c.tap_mirror, 4, TAP_CAPDR);
+            const W nav    = ~empty & ~at_cap;
+            bs_set(n.poll_phase, 3, POLL_DONE, p_start & empty);
+            bs_set(n.poll_phase, 3, POLL_SHIFT, p_start & at_cap);
+            n.tms &= ~(p_start & at_cap);
+            bs_set(n.poll_phase, 3, POLL_NAV, p_start & nav);
+            bs_mux1(n.tms, bs_goto_tms_to(c.tap_mirror, TAP_CAPDR), p_start & nav);
+        }
+        const W p_run = st_vcmd & ~p_off;
+        bs_set(n.poll_phase, 3, POLL_OFF, p_run & poll_done);
+        const W p_fall = p_run & ~poll_done & c.tck;
+        const W p_rise = p_run & ~poll_done & ~c.tck & ~bs_eq(c.poll_phase, 3, POLL_DONE);
+        if (bs_any(p_fall | p_rise)) {
+            const W ph_nav = bs_eq(c.poll_phase, 3, POLL_NAV);
+            const W ph_sh  = bs_eq(c.poll_phase, 3, POLL_SHIFT);
+            const W ph_ret = bs_eq(c.poll_phase, 3, POLL_RETURN);
+            const W m_sh   = bs_eq(c.tap_mirror, 4, TAP_SHDR);
+
+            // Falling edge: set up TMS/TDI for the next rise
+            const W one[7] = {bs_ones<W>()};
+            W last_idx[7];
+            bs_sub(last_idx, c.scan_len, one, 7);
+            const W last  = bs_eq_reg(c.poll_cnt, last_idx, 7);
+            const W p_tms = (ph_nav & bs_goto_tms_to(c.tap_mirror, TAP_CAPDR)) | (ph_sh & m_sh & last) |
+                            (ph_ret & bs_goto_tms_to(c.tap_mirror, TAP_RTI));
+            n.tck &= ~p_fall;
+            bs_mux1(n.tms, p_tms, p_fall);
+            const W p_tdi = p_fall & ph_sh & m_sh;
+            if (bs_any(p_tdi)) {
+                W bit = bs_zero<W>();
+                for (unsigned i = 0; i < 64; ++i) bit |= bs_eq(c.poll_cnt, 6, i) & c.scan_tdi[i];
+                bs_mux1(n.tdi, bit, p_tdi);
+            }
+
+            // Rising edge
+            n.tck |= p_rise;
+            W next[4] = {};
+            bs_tap_next(next, c.tap_mirror, c.tms, bs_ones<W>());
+            bs_mux(n.tap_mirror, next, 4, p_rise);
+
+            const W r_nav = p_rise & ph_nav & bs_eq(next, 4, TAP_CAPDR);
+            bs_set(n.poll_phase, 3, POLL_SHIFT, r_nav);
+            bs_set(n.poll_cnt, 8, 0, r_nav);
+            bs_set(n.poll_tdo, 32, 0, r_nav);
+
+            // Pre-shift TDO is bit poll_cnt of the scan
+            const W r_sh = p_rise & ph_sh & m_sh;
+            if (bs_any(r_sh)) {
+                W win[8];
+                bs_sub(win, c.poll_cnt, c.poll_arg + 64, 8);
+                const W in_win = r_sh & bs_ge_reg(c.poll_cnt, c.poll_arg + 64, 8) & bs_lt(win, 8, 32);
+                if (bs_any(in_win)) {
+                    for (unsigned i = 0; i < 32; ++i) bs_mux1(n.poll_tdo[i], tdo_i, in_win & bs_eq(win, 5, i));
+                }
+                bs_inc(n.poll_cnt, c.poll_cnt, 8, r_sh);
+                bs_set(n.poll_phase, 3, POLL_RETURN, r_sh & c.tms);
+                bs_inc(n.poll_tries, c.poll_tries, 8, r_sh & c.tms);
+                ev.poll_scan = r_sh & c.tms;
+            }
+
+            const W r_ret = p_rise & ph_ret & bs_eq(next, 4, TAP_RTI);
+            if (bs_any(r_ret)) {
+                W hit = bs_ones<W>();
+                for (int i = 0; i < 32; ++i) hit &= ~((c.poll_tdo[i] & c.poll_arg[i]) ^ c.poll_arg[32 + i]);
+                const W stop = hit | bs_eq_reg(c.poll_tries, c.poll_arg + 80, 8);
+                const W idle0 = bs_eq(c.poll_arg + 72, 8, 0);
+                bs_set(n.poll_cnt, 8, 0, r_ret);
+                bs_set(n.poll_phase, 3, POLL_DONE, r_ret & stop);
+                bs_set(n.poll_phase, 3, POLL_NAV, r_ret & ~stop & idle0);
+                bs_set(n.poll_phase, 3, POLL_WAIT, r_ret & ~stop & ~idle0);
+            }
+
+            const W r_wait = p_rise & ~ph_nav & ~ph_sh & ~ph_ret;
+            if (bs_any(r_wait)) {
+                W cnt1[8] = {};
+                bs_inc(cnt1, c.poll_cnt, 8, bs_ones<W>());
+                bs_inc(n.poll_cnt, c.poll_cnt, 8, r_wait);
+                bs_set(n.poll_phase, 3, POLL_NAV, r_wait & bs_eq_reg(cnt1, c.poll_arg + 72, 8));
+            }
+        }
+
+        n.tmsc_oen |= st_goto;
+        n.tck_rise_req &= ~st_goto;
+        n.tck_fall_req &= ~st_goto;
+        const W g_first = st_goto & bs_eq(c.goto_count, 3, 5) & pos;
+        if (bs_any(g_first)) {
+            W tgt_next[4] = {c.goto_tgt[1], c.goto_tgt[2], c.goto_tgt[3], tmsc_s};
+            bs_mux1(n.tms, bs_goto_tms(c.tap_mirror, tgt_next), g_first);
+            bs_set(n.goto_steps, 4, 0, g_first);
+        }
+        const W g_out  = st_goto & ~g_first & bs_eq(c.goto_count, 3, 6);
+        const W g_fall = g_out & c.tck;
+        const W g_rise = g_out & ~c.tck & ~g_done;
+        if (bs_any(g_fall)) {
+            n.tck &= ~g_fall;
+            bs_mux1(n.tms, bs_goto_tms(c.tap_mirror, c.goto_tgt), g_fall);
+        }
+        if (bs_any(g_rise)) {
+            n.tck |= g_rise;
+            bs_tap_next(n.tap_mirror, c.tap_mirror, c.tms, g_rise);
+            bs_inc(n.goto_steps, c.goto_steps, 4, g_rise);
+        }
+
+        // ─── RTCK ───
+        const W settled = ~(c.tckc_prev ^ tckc_s) & ~pos & ~neg & ~c.tck_rise_req & ~c.tck_fall_req &
+                          ~(st_goto & bs_eq(c.goto_count, 3, 6)) & ~(st_vcmd & ~p_off);
+        bs_mux1(n.rtck, tckc_s, settled);
+    }
+};
+
+#endif // BITSLICE_BRIDGE_H
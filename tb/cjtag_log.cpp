@@ -0,0 +1,177 @@
+// =============================================================================
+// Runtime Logging for the cJTAG Harnesses (see cjtag_log.h)
+// =============================================================================
+
+#include "cjtag_log.h"
+#include "Vtop__Dpi.h"  // DPI prototypes generated from src/cjtag_log.svh
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+uint8_t g_cjtag_log_level[LOG_CAT_COUNT] = { LOG_OFF, LOG_OFF, LOG_OFF, LOG_OFF, LOG_OFF };
+
+// ─── Ring buffer ─────────────────────────────────────────────────────────────
+struct log_event {
+    uint64_t time;
+    uint16_t id;
+    uint8_t  cat;
+    uint8_t  lvl;
+    uint16_t inst;  // model instance + 1 (0: untagged)
+    uint32_t arg[4];
+};
+
+static std::vector<log_event>   g_ring(1u << 16);
+static size_t                   g_ring_mask = (1u << 16) - 1;
+static std::atomic<uint64_t>    g_ring_head{0};  // total events recorded
+static size_t                   g_tail_n    = 200;
+static bool                     g_live      = false;
+static const uint64_t*          g_now       = nullptr;
+static std::vector<std::string> g_fmt(CJTAG_LOG_MAX_IDS);
+static std::mutex               g_fmt_mutex;  // models register formats from their own threads
+
+// A thread serving one of several models stamps events with that model's
+// clock and instance instead of the process-wide clock.
+static thread_local const uint64_t* t_now  = nullptr;
+static thread_local uint16_t        t_inst = 0;
+
+static const char* const CAT_NAMES[LOG_CAT_COUNT] = { "bridge", "tap", "dtm", "top", "vpi" };
+static const char* const LVL_NAMES[]              = { "off", "error", "info", "debug", "trace" };
+
+// ─── Formatting (dump / live only) ───────────────────────────────────────────
+static void print_event(FILE* out, const log_event& e) {
+    char msg[256];
+    const std::string& fmt = g_fmt[e.id % CJTAG_LOG_MAX_IDS];
+    if (fmt.empty()) {
+        snprintf(msg, sizeof(msg), "event 0x%03x args 0x%x 0x%x 0x%x 0x%x", e.id, e.arg[0], e.arg[1],
+                 e.arg[2], e.arg[3]);
+    } else {
+        snprintf(msg, sizeof(msg), fmt.c_str(), e.arg[0], e.arg[1], e.arg[2], e.arg[3]);
+    }
+    char inst[8] = "";
+    if (e.inst) snprintf(inst, sizeof(inst), "#%u ", e.inst - 1u);
+    fprintf(out, "[LOG] %12llu %s%-6s %-5s %s\n", (unsigned long long)e.time, inst,
+            e.cat < LOG_CAT_COUNT ? CAT_NAMES[e.cat] : "?", e.lvl <= LOG_TRACE ? LVL_NAMES[e.lvl] : "?",
+            msg);
+}
+
+// ─── Configuration ───────────────────────────────────────────────────────────
+static int parse_level(const char* s, size_t n) {
+    for (int l = LOG_OFF; l <= LOG_TRACE; ++l) {
+        if (strlen(LVL_NAMES[l]) == n && strncmp(s, LVL_NAMES[l], n) == 0) return l;
+    }
+    return -1;
+}
+
+static void resize_ring(size_t n) {
+    size_t cap = 1;
+    while (cap < n) cap <<= 1;
+    g_ring.assign(cap, log_event());
+    g_ring_mask = cap - 1;
+    g_ring_head = 0;
+}
+
+bool cjtag_log_configure(const char* spec) {
+    bool ok = true;
+    while (spec && *spec) {
+        const char* end = strchr(spec, ',');
+        const size_t len = end ? (size_t)(end - spec) : strlen(spec);
+        const char* colon = (const char*)memchr(spec, ':', len);
+        const size_t name_len = colon ? (size_t)(colon - spec) : len;
+
+        if (len == 4 && strncmp(spec, "live", 4) == 0) {
+            g_live = true;
+        } else if (len > 5 && strncmp(spec, "ring=", 5) == 0) {
+            resize_ring(strtoul(spec + 5, nullptr, 10));
+        } else if (len > 5 && strncmp(spec, "tail=", 5) == 0) {
+            g_tail_n = strtoul(spec + 5, nullptr, 10);
+        } else {
+            int lvl = LOG_DEBUG;
+            if (colon) lvl = parse_level(colon + 1, len - name_len - 1);
+            bool matched = false;
+            for (int c = 0; c < LOG_CAT_COUNT; ++c) {
+                const bool all = name_len == 3 && strncmp(spec, "all", 3) == 0;
+                if (all || (strlen(CAT_NAMES[c]) == name_len && strncmp(spec, CAT_NAMES[c], name_len) == 0)) {
+                    if (lvl >= 0) g_cjtag_log_level[c] = (uint8_t)lvl;
+                    matched = true;
+                }
+            }
+            if (!matched || lvl < 0) {
+                fprintf(stderr, "[LOG] Unknown log item '%.*s'\n", (int)len, spec);
+                ok = false;
+            }
+        }
+        spec = end ? end + 1 : nullptr;
+    }
+    return ok;
+}
+
+void cjtag_log_init(int argc, char** argv) {
+    if (const char* env = getenv("CJTAG_LOG")) cjtag_log_configure(env);
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "+log=", 5) == 0) {
+            cjtag_log_configure(argv[i] + 5);
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            cjtag_log_configure(argv[++i]);
+        }
+    }
+}
+
+void cjtag_log_set_clock(const uint64_t* now) { g_now = now; }
+
+void cjtag_log_set_thread(const uint64_t* now, int instance) {
+    t_now  = now;
+    t_inst = (uint16_t)(instance >= 0 ? instance + 1 : 0);
+}
+
+// ─── Recording ───────────────────────────────────────────────────────────────
+void cjtag_log_register_fmt(int id, int cat, const char* fmt) {
+    (void)cat;
+    std::lock_guard<std::mutex> lock(g_fmt_mutex);
+    if (id >= 0 && id < CJTAG_LOG_MAX_IDS && g_fmt[id].empty()) g_fmt[id] = fmt;
+}
+
+void cjtag_log_record(int cat, int lvl, int id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3) {
+    // fetch_add keeps concurrent producers (Verilator --threads) on distinct slots
+    const uint64_t n = g_ring_head.fetch_add(1, std::memory_order_relaxed);
+    log_event& e = g_ring[n & g_ring_mask];
+    const uint64_t* now = t_now ? t_now : g_now;
+    e.time   = now ? *now : 0;
+    e.id     = (uint16_t)id;
+    e.cat    = (uint8_t)cat;
+    e.lvl    = (uint8_t)lvl;
+    e.inst   = t_inst;
+    e.arg[0] = a0;
+    e.arg[1] = a1;
+    e.arg[2] = a2;
+    e.arg[3] = a3;
+    if (g_live) print_event(stdout, e);
+}
+
+// ─── Output ──────────────────────────────────────────────────────────────────
+void cjtag_log_dump(FILE* out, size_t last_n) {
+    const uint64_t head = g_ring_head.load();
+    uint64_t avail = head < g_ring.size() ? head : g_ring.size();
+    if (last_n != 0 && last_n < avail) avail = last_n;
+    if (avail == 0) return;
+    fprintf(out, "[LOG] ---- last %llu of %llu events ----\n", (unsigned long long)avail,
+            (unsigned long long)head);
+    for (uint64_t i = head - avail; i < head; ++i) print_event(out, g_ring[i & g_ring_mask]);
+    fprintf(out, "[LOG] ---- end of log ----\n");
+}
+
+void cjtag_log_dump_tail(FILE* out) { cjtag_log_dump(out, g_tail_n); }
+
+// ─── DPI entry points (src/cjtag_log.svh) ────────────────────────────────────
+int cjtag_log_on(int cat, int lvl) {
+    return (cat >= 0 && cat < LOG_CAT_COUNT && cjtag_log_enabled(cat, lvl)) ? 1 : 0;
+}
+
+void cjtag_log_event(int cat, int lvl, int id, int a0, int a1, int a2, int a3) {
+    cjtag_log_record(cat, lvl, id, (uint32_t)a0, (uint32_t)a1, (uint32_t)a2, (uint32_t)a3);
+}
+
+void cjtag_log_register(int id, int cat, const char* fmt) { cjtag_log_register_fmt(id, cat, fmt); }
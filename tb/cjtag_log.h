@@ -0,0 +1,80 @@
+// =============================================================================
+// Runtime Logging for the cJTAG Harnesses
+// =============================================================================
+// Replaces the compile-time VERBOSE switch.  Diagnostics from the RTL (via the
+// DPI hooks in src/cjtag_log.svh) and from the C++ harnesses are recorded as
+// small binary events {time, category, level, id, 4 x uint32} in an in-memory
+// ring buffer.  Nothing is formatted until the ring is dumped (on request or
+// when a test fails), so enabled logging stays cheap and disabled logging is
+// a single table lookup per call site.
+//
+// Configuration (CJTAG_LOG environment variable, then +log=SPEC or --log SPEC):
+//   SPEC   := item[,item...]
+//   item   := CAT[:LEVEL] | live | ring=N | tail=N
+//   CAT    := bridge | tap | dtm | top | vpi | all
+//   LEVEL  := off | error | info | debug | trace      (default: debug)
+//   live   : also print each event as it is recorded (old VERBOSE behaviour)
+//   ring=N : ring capacity in events (rounded up to a power of two)
+//   tail=N : events printed by cjtag_log_dump_tail() on failure (default 200)
+//
+// Example: CJTAG_LOG=bridge:trace,vpi:info,tail=500 build/Vtest_top
+//
+// Category and level encodings must match src/cjtag_log.svh.
+// =============================================================================
+
+#ifndef CJTAG_LOG_H
+#define CJTAG_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum CjtagLogCat : uint8_t {
+    LOG_CAT_BRIDGE = 0,
+    LOG_CAT_TAP    = 1,
+    LOG_CAT_DTM    = 2,
+    LOG_CAT_TOP    = 3,
+    LOG_CAT_VPI    = 4,
+    LOG_CAT_COUNT  = 5
+};
+
+enum CjtagLogLevel : uint8_t {
+    LOG_OFF   = 0,
+    LOG_ERROR = 1,
+    LOG_INFO  = 2,
+    LOG_DEBUG = 3,
+    LOG_TRACE = 4
+};
+
+// Message ids are global; each category owns a 256-id block (cat << 8).
+#define CJTAG_LOG_ID(cat, n) ((int)(((cat) << 8) | (n)))
+#define CJTAG_LOG_MAX_IDS    (LOG_CAT_COUNT << 8)
+
+extern uint8_t g_cjtag_log_level[LOG_CAT_COUNT];
+
+static inline bool cjtag_log_enabled(int cat, int lvl) {
+    return g_cjtag_log_level[cat] >= lvl;
+}
+
+// Configuration
+void cjtag_log_init(int argc, char** argv);      // CJTAG_LOG env, then +log=/--log args
+bool cjtag_log_configure(const char* spec);      // false on an unknown item
+void cjtag_log_set_clock(const uint64_t* now);   // timestamp source (harness time units)
+void cjtag_log_set_thread(const uint64_t* now, int instance);  // per-thread source + tag (multi-model)
+
+// Recording
+void cjtag_log_register_fmt(int id, int cat, const char* fmt);
+void cjtag_log_record(int cat, int lvl, int id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+// Output
+void cjtag_log_dump(FILE* out, size_t last_n);   // last_n = 0: whole ring
+void cjtag_log_dump_tail(FILE* out);             // configured tail (on failure)
+
+#define CJTAG_LOG(cat, lvl, id, a0, a1, a2, a3)                                  \
+    do {                                                                         \
+        if (cjtag_log_enabled(cat, lvl))                                         \
+            cjtag_log_record(cat, lvl, id, (uint32_t)(a0), (uint32_t)(a1),       \
+                             (uint32_t)(a2), (uint32_t)(a3));                    \
+    } while (0)
+
+#endif // CJTAG_LOG_H
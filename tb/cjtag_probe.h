@@ -0,0 +1,240 @@
+// =============================================================================
+// cJTAG Internal-State Probes
+// =============================================================================
+// Named, read-only accessors over internal bridge/TAP state for the Verilator
+// harnesses.  The RTL marks the probed signals /*verilator public_flat_rd*/,
+// so no ports are added and the accessors compile to a plain member load.
+//
+// Only read these after dut->eval() (i.e. after a tick); they reflect the
+// registered value at the last evaluated clock edge.
+//
+// Probed signals:
+//   cjtag_bridge: state, return_state, bit_pos, tmsc_toggle_count,
+//                 activation_count, activation_shift, tmsc_sampled, vext_en,
+//                 vcmd_count, vcmd_op, crc_tdi, crc_tms,
+//                 retain_en, ctx_valid, ctx_vext,
+//                 tap_mirror, goto_count, goto_tgt, goto_steps,
+//                 scan_tdi, scan_len, poll_phase, poll_cnt, poll_tries, poll_tdo,
+//                 verify_en, verify_fail, verify_count, verify_first,
+//                 loop_mode, loop_prbs, loop_count, loop_errors
+//   jtag_tap:     state, ir_reg
+// =============================================================================
+
+#ifndef CJTAG_PROBE_H
+#define CJTAG_PROBE_H
+
+#include "Vtop.h"
+#include "Vtop___024root.h"
+
+#include <stdint.h>
+
+// ─── Encodings (must match cjtag_bridge.sv state_t / jtag_tap.sv tap_state_t)
+enum BridgeState : uint8_t {
+    BRIDGE_OFFLINE    = 0,
+    BRIDGE_ESCAPE     = 1,
+    BRIDGE_ONLINE_ACT = 2,
+    BRIDGE_OSCAN1     = 3,
+    BRIDGE_VCMD       = 4,
+    BRIDGE_GOTO       = 5
+};
+
+enum PollPhase : uint8_t {
+    POLL_OFF    = 0,
+    POLL_NAV    = 1,
+    POLL_SHIFT  = 2,
+    POLL_RETURN = 3,
+    POLL_WAIT   = 4,
+    POLL_DONE   = 5
+};
+
+enum LoopMode : uint8_t {
+    LOOP_OFF  = 0,
+    LOOP_ECHO = 1,
+    LOOP_PRBS = 2
+};
+
+enum TapState : uint8_t {
+    TAP_TEST_LOGIC_RESET = 0x0,
+    TAP_RUN_TEST_IDLE    = 0x1,
+    TAP_SELECT_DR_SCAN   = 0x2,
+    TAP_CAPTURE_DR       = 0x3,
+    TAP_SHIFT_DR         = 0x4,
+    TAP_EXIT1_DR         = 0x5,
+    TAP_PAUSE_DR         = 0x6,
+    TAP_EXIT2_DR         = 0x7,
+    TAP_UPDATE_DR        = 0x8,
+    TAP_SELECT_IR_SCAN   = 0x9,
+    TAP_CAPTURE_IR       = 0xA,
+    TAP_SHIFT_IR         = 0xB,
+    TAP_EXIT1_IR         = 0xC,
+    TAP_PAUSE_IR         = 0xD,
+    TAP_EXIT2_IR         = 0xE,
+    TAP_UPDATE_IR        = 0xF
+};
+
+// ─── cjtag_bridge ────────────────────────────────────────────────────────────
+static inline uint8_t probe_bridge_state(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__state;
+}
+
+static inline uint8_t probe_return_state(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__return_state;
+}
+
+static inline uint8_t probe_bit_pos(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__bit_pos;
+}
+
+static inline uint8_t probe_tmsc_toggle_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__tmsc_toggle_count;
+}
+
+static inline uint8_t probe_activation_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__activation_count;
+}
+
+static inline uint16_t probe_activation_shift(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__activation_shift;
+}
+
+static inline uint8_t probe_tmsc_sampled(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__tmsc_sampled;
+}
+
+static inline uint8_t probe_vext_en(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__vext_en;
+}
+
+static inline uint8_t probe_vcmd_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__vcmd_count;
+}
+
+static inline uint8_t probe_vcmd_op(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__vcmd_op;
+}
+
+static inline uint16_t probe_crc_tdi(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__crc_tdi;
+}
+
+static inline uint16_t probe_crc_tms(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__crc_tms;
+}
+
+static inline uint8_t probe_retain_en(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__retain_en;
+}
+
+static inline uint8_t probe_ctx_valid(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__ctx_valid;
+}
+
+static inline uint8_t probe_ctx_vext(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__ctx_vext;
+}
+
+static inline uint8_t probe_tap_mirror(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__tap_mirror;
+}
+
+static inline uint8_t probe_goto_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__goto_count;
+}
+
+static inline uint8_t probe_goto_tgt(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__goto_tgt;
+}
+
+static inline uint8_t probe_goto_steps(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__goto_steps;
+}
+
+static inline uint64_t probe_scan_tdi(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__scan_tdi;
+}
+
+static inline uint8_t probe_scan_len(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__scan_len;
+}
+
+static inline uint8_t probe_poll_phase(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__poll_phase;
+}
+
+static inline uint8_t probe_poll_cnt(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__poll_cnt;
+}
+
+static inline uint8_t probe_poll_tries(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__poll_tries;
+}
+
+static inline uint32_t probe_poll_tdo(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__poll_tdo;
+}
+
+static inline uint8_t probe_verify_en(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__verify_en;
+}
+
+static inline uint8_t probe_verify_fail(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__verify_fail;
+}
+
+static inline uint16_t probe_verify_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__verify_count;
+}
+
+static inline uint16_t probe_verify_first(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__verify_first;
+}
+
+static inline uint8_t probe_loop_mode(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__loop_mode;
+}
+
+static inline uint16_t probe_loop_prbs(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__loop_prbs;
+}
+
+static inline uint32_t probe_loop_count(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__loop_count;
+}
+
+static inline uint16_t probe_loop_errors(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_cjtag_bridge__DOT__loop_errors;
+}
+
+// ─── jtag_tap ────────────────────────────────────────────────────────────────
+static inline uint8_t probe_tap_state(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_jtag_tap__DOT__state;
+}
+
+static inline uint8_t probe_ir_reg(const Vtop* dut) {
+    return dut->rootp->top__DOT__u_jtag_tap__DOT__ir_reg;
+}
+
+// ─── Names for diagnostics ───────────────────────────────────────────────────
+static inline const char* bridge_state_name(uint8_t s) {
+    switch (s) {
+    case BRIDGE_OFFLINE:    return "OFFLINE";
+    case BRIDGE_ESCAPE:     return "ESCAPE";
+    case BRIDGE_ONLINE_ACT: return "ONLINE_ACT";
+    case BRIDGE_OSCAN1:     return "OSCAN1";
+    case BRIDGE_VCMD:       return "VCMD";
+    case BRIDGE_GOTO:       return "GOTO";
+    default:                return "UNKNOWN";
+    }
+}
+
+static inline const char* tap_state_name(uint8_t s) {
+    static const char* const names[16] = {
+        "TEST_LOGIC_RESET", "RUN_TEST_IDLE", "SELECT_DR_SCAN", "CAPTURE_DR",
+        "SHIFT_DR",         "EXIT1_DR",      "PAUSE_DR",       "EXIT2_DR",
+        "UPDATE_DR",        "SELECT_IR_SCAN", "CAPTURE_IR",    "SHIFT_IR",
+        "EXIT1_IR",         "PAUSE_IR",      "EXIT2_IR",       "UPDATE_IR"
+    };
+    return s < 16 ? names[s] : "UNKNOWN";
+}
+
+#endif // CJTAG_PROBE_H
@@ -0,0 +1,585 @@
+// =============================================================================
+// Exhaustive Wire-Input Explorer for the cJTAG Bridge
+// =============================================================================
+// Enumerates every TCKC/TMSC input choice from checkpoints in each bridge
+// state and checks the escape rules and output invariants on every clk_i
+// cycle.  The model is snapshotted with fork(): each explored edge is a child
+// process that inherits the parent's Verilated state, applies one step and
+// either recurses or exits, so no input prefix is ever re-simulated.
+//
+// One step is one TCKC period, starting and ending with TCKC high and all
+// synchronisers settled:
+//   k TMSC toggles, each held GAP clk_i cycles   (k = 0..31, escapes)
+//   TCKC falls with TMSC = v, low SETTLE cycles  (escape evaluated here)
+//   TCKC rises, high SETTLE cycles               (v sampled here)
+// Choices per step: k x GAP x v.  A TMSC change that coincides with the TCKC
+// fall (v differs from the post-toggle level) is part of the space.
+//
+// Pruning: after each step the reachable control state (bridge state
+// registers, TAP state/IR, output pins, TMSC level) is hashed into a table
+// in shared memory.  A state is expanded again only if reached with more
+// remaining depth than before.  DR contents, the link CRCs and the vendor
+// response word are data, not control, and are left out of the key unless
+// --exact, which hashes the entire model state instead.
+//
+// Invariants (a violation prints the start checkpoint and input path):
+//   every cycle: state encoding, bit_pos <= 2 (3 in verify packets),
+//                activation_count <= 11, online_o/nsp_o match the
+//                state, VCMD/GOTO only with vext_en, TCK high only
+//                one cycle behind OSCAN1/GOTO, never in loopback packets,
+//                TMSC driven only one cycle behind OSCAN1/VCMD,
+//                TMS high and TCK low behind OFFLINE/ONLINE_ACT/ESCAPE
+//   every step:  k >= 8 -> OFFLINE; k = 6-7 -> ONLINE_ACT from OFFLINE
+//                (k = 7 with a retained context -> OSCAN1), else OFFLINE;
+//                k = 4-5 -> OFFLINE; k < 4 -> no change, except
+//                OSCAN1 -> VCMD / GOTO on k = 2 / 3 at a packet boundary
+//                (EC=10x1) and GOTO -> OSCAN1 when a walk completes
+//
+// Usage: explore_cjtag [--depth N] [--jobs N] [--toggles A-B] [--gaps g1,g2]
+//                      [--settle N] [--start LIST] [--exact] [--table-bits N]
+//   --depth   steps explored below each checkpoint (default 4)
+//   --jobs    concurrent worker processes (default: online CPUs)
+//   --toggles toggle counts per step (default 0-31; up to 63 exposes the
+//             5-bit counter wrapping)
+//   --gaps    TMSC toggle spacing in clk_i cycles (default 1,4)
+//   --start   checkpoints: offline,online_act,oscan1,oscan1_vext,vcmd,
+//             goto,offline_ctx (all)
+//   --table-bits  log2 of visited-table slots (default 22, 64 MiB shared)
+// Exit status is non-zero if any invariant failed or a worker crashed.
+// =============================================================================
+
+#include "Vtop.h"
+#include "cjtag_log.h"
+#include "cjtag_probe.h"
+#include "verilated.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+static Vtop*    g_dut  = nullptr;
+static uint64_t g_time = 0;
+
+// Verilator time callback - required for $time in SystemVerilog
+double sc_time_stamp() {
+    return (double)g_time;
+}
+
+// ─── Options ─────────────────────────────────────────────────────────────────
+struct ExploreOptions {
+    int              depth      = 4;
+    int              jobs       = 1;
+    int              kmin       = 0;
+    int              kmax       = 31;
+    std::vector<int> gaps       = { 1, 4 };
+    int              settle     = 4;
+    bool             exact      = false;
+    int              table_bits = 22;
+    std::string      starts     = "offline,online_act,oscan1,oscan1_vext,vcmd,goto,offline_ctx";
+};
+
+struct Choice {
+    uint8_t k;    // TMSC toggles while TCKC high
+    uint8_t gap;  // clk_i cycles per toggle
+    uint8_t v;    // TMSC level driven with the TCKC fall
+};
+
+// ─── Shared state (MAP_SHARED, visible to every worker) ──────────────────────
+static const int NUM_STATES = 6;  // BridgeState encodings
+static const int MAX_K      = 64;
+
+struct VisitSlot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint32_t> budget;  // best remaining depth seen + 1
+};
+
+struct SharedStats {
+    std::atomic<uint64_t> states;      // distinct keys
+    std::atomic<uint64_t> edges;       // steps simulated
+    std::atomic<uint64_t> pruned;      // steps ending in an already-covered state
+    std::atomic<uint64_t> violations;
+    std::atomic<uint64_t> crashed;
+    std::atomic<uint64_t> table_full;
+    std::atomic<int>      running;     // asynchronous workers alive
+    std::atomic<int>      reports;     // counterexamples printed
+    std::atomic<uint8_t>  trans[NUM_STATES][MAX_K];  // bit per end state
+};
+
+static SharedStats* g_stats      = nullptr;
+static VisitSlot*   g_table      = nullptr;
+static uint64_t     g_table_mask = 0;
+
+static const int MAX_REPORTS = 8;
+
+// Anonymous mappings are zero-filled, which is the initial value of every
+// counter and slot; pages of the visited table are only touched on insert.
+template <typename T>
+static T* shared_alloc(size_t count) {
+    void* p = mmap(nullptr, sizeof(T) * count, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : static_cast<T*>(p);
+}
+
+// Returns true if the caller should expand a state reached with `remaining`
+// steps to go: it is new, or was only seen with less depth left.
+static bool visit(uint64_t key, int remaining) {
+    if (key == 0) key = 1;  // 0 marks an empty slot
+    const uint32_t want = (uint32_t)remaining + 1;
+    uint64_t i = key & g_table_mask;
+    for (uint64_t probe = 0; probe <= g_table_mask; ++probe, i = (i + 1) & g_table_mask) {
+        VisitSlot& s = g_table[i];
+        uint64_t   k = s.key.load(std::memory_order_acquire);
+        if (k == 0) {
+            if (s.key.compare_exchange_strong(k, key, std::memory_order_acq_rel)) {
+                g_stats->states.fetch_add(1, std::memory_order_relaxed);
+                s.budget.store(want, std::memory_order_release);
+                return true;
+            }
+            // k now holds the winner's key
+        }
+        if (k != key) continue;
+        uint32_t have = s.budget.load(std::memory_order_acquire);
+        while (have < want) {
+            if (s.budget.compare_exchange_weak(have, want, std::memory_order_acq_rel)) return true;
+        }
+        return false;
+    }
+    g_stats->table_full.fetch_add(1, std::memory_order_relaxed);
+    return true;  // no pruning once full; exploration stays exhaustive
+}
+
+// ─── State key ───────────────────────────────────────────────────────────────
+static inline uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 29);
+}
+
+static uint64_t state_key(const ExploreOptions& opt) {
+    const Vtop* d = g_dut;
+    uint64_t    h = 0xCBF29CE484222325ull;
+    if (opt.exact) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(d->rootp);
+        for (size_t i = 0; i < sizeof(*d->rootp); ++i) h = mix(h, p[i]);
+        return mix(h, d->tmsc_i);
+    }
+    h = mix(h, probe_bridge_state(d) | (uint64_t)probe_return_state(d) << 8 | (uint64_t)probe_bit_pos(d) << 16 |
+                   (uint64_t)probe_activation_count(d) << 24 | (uint64_t)probe_tmsc_toggle_count(d) << 32 |
+                   (uint64_t)probe_tmsc_sampled(d) << 40 | (uint64_t)probe_vext_en(d) << 48);
+    h = mix(h, probe_activation_shift(d) | (uint64_t)probe_vcmd_count(d) << 16 | (uint64_t)probe_vcmd_op(d) << 24 |
+                   (uint64_t)probe_tap_state(d) << 32 | (uint64_t)probe_ir_reg(d) << 40 |
+                   (uint64_t)probe_retain_en(d) << 48 | (uint64_t)probe_ctx_valid(d) << 49 |
+                   (uint64_t)probe_ctx_vext(d) << 50);
+    h = mix(h, probe_tap_mirror(d) | (uint64_t)probe_goto_count(d) << 8 | (uint64_t)probe_goto_tgt(d) << 16 |
+                   (uint64_t)probe_goto_steps(d) << 24);
+    h = mix(h, probe_scan_len(d) | (uint64_t)probe_poll_phase(d) << 8 | (uint64_t)probe_poll_cnt(d) << 16 |
+                   (uint64_t)probe_poll_tries(d) << 24 | (uint64_t)probe_verify_en(d) << 32 |
+                   (uint64_t)probe_verify_fail(d) << 33 | (uint64_t)probe_loop_mode(d) << 34);
+    h = mix(h, d->tck_o | d->tms_o << 1 | d->tdi_o << 2 | d->tmsc_oen << 3 | d->rtck_o << 4 | d->tmsc_i << 5);
+    return h;
+}
+
+// ─── Simulation and per-cycle invariants ─────────────────────────────────────
+static const char* g_fail      = nullptr;  // first violation in this process
+static uint8_t     g_prev_state = BRIDGE_OFFLINE;
+
+static void check_cycle() {
+    const Vtop*   d    = g_dut;
+    const uint8_t s    = probe_bridge_state(d);
+    const uint8_t prev = g_prev_state;
+    g_prev_state       = s;
+    if (g_fail) return;
+
+    const bool online = (s == BRIDGE_OSCAN1) || (s == BRIDGE_VCMD) || (s == BRIDGE_GOTO);
+    const bool idle   = (prev == BRIDGE_OFFLINE) || (prev == BRIDGE_ONLINE_ACT) || (prev == BRIDGE_ESCAPE);
+    if (s >= NUM_STATES) {
+        g_fail = "bridge state outside the encoding";
+    } else if (probe_bit_pos(d) > 2 && !probe_verify_en(d)) {
+        g_fail = "bit_pos > 2 outside a verify session";
+    } else if (probe_activation_count(d) > 11) {
+        g_fail = "activation_count > 11";
+    } else if ((d->online_o != 0) != online || (d->nsp_o != 0) == online) {
+        g_fail = "online_o/nsp_o disagree with the bridge state";
+    } else if (s == BRIDGE_VCMD && !probe_vext_en(d)) {
+        g_fail = "VCMD entered without EC=1001";
+    } else if (s == BRIDGE_GOTO && !probe_vext_en(d)) {
+        g_fail = "GOTO entered without EC=1001";
+    } else if (d->tck_o && prev != BRIDGE_OSCAN1 && prev != BRIDGE_GOTO) {
+        g_fail = "TCK high outside OSCAN1";
+    } else if (d->tck_o && s == BRIDGE_OSCAN1 && probe_loop_mode(d) != LOOP_OFF) {
+        g_fail = "TCK high in a loopback packet";
+    } else if (!d->tmsc_oen && prev != BRIDGE_OSCAN1 && prev != BRIDGE_VCMD) {
+        g_fail = "TMSC driven while not online";
+    } else if (idle && (!d->tms_o || d->tck_o || !d->tmsc_oen)) {
+        g_fail = "JTAG side not idle while offline";
+    }
+}
+
+static void run(int cycles) {
+    for (int i = 0; i < cycles; ++i) {
+        g_dut->clk_i = 1;
+        g_dut->eval();
+        g_dut->clk_i = 0;
+        g_dut->eval();
+        ++g_time;
+        check_cycle();
+    }
+}
+
+// One TCKC period (see header).  Returns false on a violation.
+static bool apply(const ExploreOptions& opt, const Choice& c) {
+    Vtop*         d      = g_dut;
+    const uint8_t from   = probe_bridge_state(d);
+    const bool    at_pkt = probe_bit_pos(d) == 0 && probe_vext_en(d);
+    const bool    ctx    = probe_ctx_valid(d) != 0;
+
+    for (int i = 0; i < c.k; ++i) {
+        d->tmsc_i ^= 1;
+        run(c.gap);
+    }
+    d->tckc_i = 0;
+    d->tmsc_i = c.v;
+    run(opt.settle);
+    const uint8_t mid = probe_bridge_state(d);
+    d->tckc_i = 1;
+    run(opt.settle);
+    const uint8_t to = probe_bridge_state(d);
+
+    if (from < NUM_STATES && to < NUM_STATES) {
+        g_stats->trans[from][c.k].fetch_or((uint8_t)(1u << to), std::memory_order_relaxed);
+    }
+    if (g_fail) return false;
+
+    // Escape rules, evaluated once the fall has settled
+    if (c.k >= 8) {
+        if (mid != BRIDGE_OFFLINE) g_fail = "reset escape (8+ toggles) did not reach OFFLINE";
+    } else if (c.k >= 6) {
+        const uint8_t want = (from != BRIDGE_OFFLINE) ? BRIDGE_OFFLINE
+                           : (c.k == 7 && ctx)        ? BRIDGE_OSCAN1
+                                                      : BRIDGE_ONLINE_ACT;
+        if (mid != want) g_fail = "selection escape (6-7 toggles) took the wrong branch";
+    } else if (c.k >= 4) {
+        if (mid != BRIDGE_OFFLINE) g_fail = "deselect/invalid escape (4-5 toggles) did not reach OFFLINE";
+    } else if (mid != from && !(from == BRIDGE_OSCAN1 && mid == BRIDGE_VCMD && c.k == 2 && at_pkt) &&
+               !(from == BRIDGE_OSCAN1 && mid == BRIDGE_GOTO && c.k == 3 && at_pkt) &&
+               !(from == BRIDGE_GOTO && mid == BRIDGE_OSCAN1)) {
+        g_fail = "state changed on a TCKC fall without an escape";
+    }
+    return g_fail == nullptr;
+}
+
+// ─── Checkpoints ─────────────────────────────────────────────────────────────
+// Built from reset with the same step primitive (gap 4), so every counter-
+// example replays as one flat input path.
+static std::vector<Choice> activation_prefix(int ec) {
+    const int oac = 0xC;
+    const int cp  = oac ^ ec;
+    const int pkt = oac | ec << 4 | cp << 8;  // 12 bits, LSB first
+    std::vector<Choice> p;
+    for (int i = 0; i < 12; ++i) p.push_back({ (uint8_t)(i == 0 ? 6 : 0), 4, (uint8_t)((pkt >> i) & 1) });
+    return p;
+}
+
+static bool checkpoint(const std::string& name, std::vector<Choice>& prefix) {
+    prefix.clear();
+    if (name == "offline") return true;
+    if (name == "online_act") {
+        prefix.push_back({ 6, 4, 0 });  // select escape + first OAC bit
+        return true;
+    }
+    if (name == "oscan1") {
+        prefix = activation_prefix(0x8);
+        return true;
+    }
+    if (name == "oscan1_vext" || name == "vcmd" || name == "goto") {
+        prefix = activation_prefix(0x9);
+        if (name == "vcmd") prefix.push_back({ 2, 4, 1 });  // frame entry + opcode bit 0
+        if (name == "goto") prefix.push_back({ 3, 4, 0 });  // frame entry + target bit 0
+        return true;
+    }
+    if (name == "offline_ctx") {
+        prefix = activation_prefix(0xA);
+        prefix.push_back({ 4, 4, 1 });  // deselect, context retained
+        return true;
+    }
+    return false;
+}
+
+// ─── Exploration ─────────────────────────────────────────────────────────────
+static std::string         g_start;
+static std::vector<Choice> g_path;  // this process' inputs since reset
+static bool                g_async = false;
+
+static void report(const char* why) {
+    g_stats->violations.fetch_add(1, std::memory_order_relaxed);
+    if (g_stats->reports.fetch_add(1, std::memory_order_relaxed) >= MAX_REPORTS) return;
+    std::string s = "❌ " + std::string(why) + "\n   start " + g_start + ", path (k/gap/v):";
+    char buf[32];
+    for (const Choice& c : g_path) {
+        snprintf(buf, sizeof(buf), " %u/%u/%u", c.k, c.gap, c.v);
+        s += buf;
+    }
+    snprintf(buf, sizeof(buf), "\n   ends in %s\n", bridge_state_name(probe_bridge_state(g_dut)));
+    s += buf;
+    fputs(s.c_str(), stdout);
+    fflush(stdout);
+}
+
+static void worker_exit(int status) {
+    if (g_async) g_stats->running.fetch_sub(1, std::memory_order_acq_rel);
+    _exit(status);
+}
+
+static bool try_acquire(int jobs) {
+    int n = g_stats->running.load(std::memory_order_relaxed);
+    while (n < jobs) {
+        if (g_stats->running.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel)) return true;
+    }
+    return false;
+}
+
+// A worker killed by a signal never reaches worker_exit(), so an async one
+// gives its job slot back here.
+static void reap(pid_t pid, bool async = false) {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (WIFSIGNALED(status)) {
+        if (async) g_stats->running.fetch_sub(1, std::memory_order_acq_rel);
+        g_stats->crashed.fetch_add(1, std::memory_order_relaxed);
+        fprintf(stderr, "worker %d died with signal %d (start %s, depth %zu)\n", (int)pid, WTERMSIG(status),
+                g_start.c_str(), g_path.size());
+    }
+}
+
+// Explore all choices below the current model state (remaining > 0 steps).
+static void explore(const ExploreOptions& opt, int remaining) {
+    std::vector<pid_t> async;
+    for (int k = opt.kmin; k <= opt.kmax; ++k) {
+        for (int gap : opt.gaps) {
+            if (k == 0 && gap != opt.gaps[0]) continue;  // gap is irrelevant without toggles
+            for (int v = 0; v <= 1; ++v) {
+                const Choice c  = { (uint8_t)k, (uint8_t)gap, (uint8_t)v };
+                const bool   as = try_acquire(opt.jobs);
+                const pid_t  pid = fork();
+                if (pid == 0) {
+                    g_async = as;
+                    g_path.push_back(c);
+                    g_stats->edges.fetch_add(1, std::memory_order_relaxed);
+                    if (!apply(opt, c)) {
+                        report(g_fail);
+                        worker_exit(1);
+                    }
+                    if (!visit(state_key(opt), remaining - 1)) {
+                        g_stats->pruned.fetch_add(1, std::memory_order_relaxed);
+                    } else if (remaining > 1) {
+                        explore(opt, remaining - 1);
+                    }
+                    worker_exit(0);
+                }
+                if (pid < 0) {
+                    perror("fork");
+                    if (as) g_stats->running.fetch_sub(1, std::memory_order_acq_rel);
+                    continue;
+                }
+                if (as) {
+                    async.push_back(pid);
+                } else {
+                    reap(pid);
+                }
+            }
+        }
+    }
+    for (pid_t pid : async) reap(pid, true);
+}
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+static double wall_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static std::vector<int> parse_ints(const char* s) {
+    std::vector<int> v;
+    while (s && *s) {
+        char*      end = nullptr;
+        const long x   = strtol(s, &end, 10);
+        if (end == s) break;
+        v.push_back((int)x);
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return v;
+}
+
+static void print_matrix(const ExploreOptions& opt) {
+    static const char code[NUM_STATES] = { 'O', 'E', 'A', 'S', 'V', 'G' };
+    printf("End state per start state and toggle count (O=OFFLINE A=ONLINE_ACT S=OSCAN1 V=VCMD G=GOTO, *=several):\n");
+    printf("  %-11s k ", "");
+    for (int k = opt.kmin; k <= opt.kmax; ++k) printf("%d", k % 10);
+    printf("\n");
+    for (int f = 0; f < NUM_STATES; ++f) {
+        bool any = false;
+        for (int k = opt.kmin; k <= opt.kmax; ++k) any |= g_stats->trans[f][k].load() != 0;
+        if (!any) continue;
+        printf("  %-11s   ", bridge_state_name((uint8_t)f));
+        for (int k = opt.kmin; k <= opt.kmax; ++k) {
+            const uint8_t m = g_stats->trans[f][k].load();
+            char          ch = '.';
+            for (int t = 0; t < NUM_STATES; ++t) {
+                if (m & (1u << t)) ch = (ch == '.') ? code[t] : '*';
+            }
+            putchar(ch);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    cjtag_log_init(argc, argv);
+
+    ExploreOptions opt;
+    const long     ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    opt.jobs            = ncpu > 0 ? (int)ncpu : 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            opt.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            opt.jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--toggles") == 0 && i + 1 < argc) {
+            const char* s = argv[++i];
+            opt.kmin      = atoi(s);
+            const char* dash = strchr(s, '-');
+            opt.kmax      = dash ? atoi(dash + 1) : opt.kmin;
+        } else if (strcmp(argv[i], "--gaps") == 0 && i + 1 < argc) {
+            opt.gaps = parse_ints(argv[++i]);
+        } else if (strcmp(argv[i], "--settle") == 0 && i + 1 < argc) {
+            opt.settle = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            opt.starts = argv[++i];
+        } else if (strcmp(argv[i], "--exact") == 0) {
+            opt.exact = true;
+        } else if (strcmp(argv[i], "--table-bits") == 0 && i + 1 < argc) {
+            opt.table_bits = atoi(argv[++i]);
+        }
+    }
+    bool gaps_ok = !opt.gaps.empty();
+    for (int g : opt.gaps) gaps_ok &= g >= 1 && g <= 255;
+    // settle >= 4: synchronisers, edge flags and ESCAPE must be quiescent at
+    // step boundaries or the state key would miss in-flight edges
+    if (opt.depth < 1 || opt.jobs < 1 || opt.kmin < 0 || opt.kmax >= MAX_K || opt.kmin > opt.kmax || !gaps_ok ||
+        opt.settle < 4 || opt.table_bits < 10 || opt.table_bits > 30) {
+        fprintf(stderr, "usage: explore_cjtag [--depth N] [--jobs N] [--toggles A-B] [--gaps g1,g2] [--settle N]\n"
+                        "                     [--start LIST] [--exact] [--table-bits N]\n");
+        return 1;
+    }
+
+    std::vector<std::string> starts;
+    for (size_t pos = 0; pos <= opt.starts.size();) {
+        const size_t comma = opt.starts.find(',', pos);
+        const size_t end   = comma == std::string::npos ? opt.starts.size() : comma;
+        if (end > pos) starts.push_back(opt.starts.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    std::vector<Choice> prefix;
+    for (const std::string& s : starts) {
+        if (!checkpoint(s, prefix)) {
+            fprintf(stderr, "Unknown checkpoint '%s'\n", s.c_str());
+            return 1;
+        }
+    }
+
+    g_stats = shared_alloc<SharedStats>(1);
+    g_table = shared_alloc<VisitSlot>((size_t)1 << opt.table_bits);
+    if (!g_stats || !g_table) {
+        fprintf(stderr, "Cannot map the shared visited table\n");
+        return 1;
+    }
+    g_table_mask = ((uint64_t)1 << opt.table_bits) - 1;
+
+    size_t per_step = 0;
+    for (int k = opt.kmin; k <= opt.kmax; ++k) per_step += (k == 0) ? 2 : 2 * opt.gaps.size();
+    printf("========================================\n");
+    printf("cJTAG Input-Space Explorer\n");
+    printf("depth %d, %zu choices/step (toggles %d-%d, %zu gap(s), settle %d), %d jobs, %s key\n", opt.depth,
+           per_step, opt.kmin, opt.kmax, opt.gaps.size(), opt.settle, opt.jobs, opt.exact ? "exact" : "control");
+    printf("========================================\n");
+    fflush(stdout);  // children inherit stdio buffers
+
+    // Reset as the tick harnesses do, then raise TCKC: steps start from TCKC high
+    g_dut             = new Vtop;
+    g_dut->ntrst_i    = 0;
+    g_dut->tckc_i     = 0;
+    g_dut->tmsc_i     = 1;
+    g_dut->jtag_sel_i = 0;
+    g_dut->jtag_tck_i = 0;
+    g_dut->jtag_tms_i = 1;
+    g_dut->jtag_tdi_i = 0;
+    g_dut->clk_i      = 0;
+    cjtag_log_set_clock(&g_time);
+    for (int i = 0; i < 50; ++i) run(1);
+    g_dut->ntrst_i = 1;
+    run(10);
+    g_dut->tckc_i = 1;
+    run(opt.settle);
+
+    const double w0 = wall_s();
+    std::vector<pid_t> workers;
+    for (const std::string& s : starts) {
+        checkpoint(s, prefix);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            g_start = s;
+            for (const Choice& c : prefix) {
+                g_path.push_back(c);
+                if (!apply(opt, c)) {
+                    report(g_fail);
+                    _exit(1);
+                }
+            }
+            printf("start %-12s %s (TAP %s)\n", s.c_str(), bridge_state_name(probe_bridge_state(g_dut)),
+                   tap_state_name(probe_tap_state(g_dut)));
+            fflush(stdout);
+            if (visit(state_key(opt), opt.depth)) explore(opt, opt.depth);
+            _exit(0);
+        }
+        if (pid > 0) workers.push_back(pid);
+    }
+    for (pid_t pid : workers) reap(pid);
+    const double wall = wall_s() - w0;
+
+    const uint64_t edges = g_stats->edges.load();
+    printf("========================================\n");
+    printf("States:      %llu distinct (%s key)\n", (unsigned long long)g_stats->states.load(),
+           opt.exact ? "exact" : "control");
+    printf("Edges:       %llu simulated, %llu pruned as revisits\n", (unsigned long long)edges,
+           (unsigned long long)g_stats->pruned.load());
+    printf("Wall time:   %.2f s (%.0f edges/s)\n", wall, wall > 0.0 ? (double)edges / wall : 0.0);
+    if (g_stats->table_full.load()) {
+        printf("Table full:  %llu inserts unpruned (raise --table-bits)\n",
+               (unsigned long long)g_stats->table_full.load());
+    }
+    print_matrix(opt);
+    printf("========================================\n");
+
+    const uint64_t bad = g_stats->violations.load() + g_stats->crashed.load();
+    if (bad) {
+        printf("❌ %llu invariant violation(s), %llu crashed worker(s)\n",
+               (unsigned long long)g_stats->violations.load(), (unsigned long long)g_stats->crashed.load());
+    } else {
+        printf("✅ No invariant violations\n");
+    }
+    g_dut->final();
+    delete g_dut;
+    return bad ? 1 : 0;
+}
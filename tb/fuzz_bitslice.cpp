@@ -0,0 +1,874 @@
+// =============================================================================
+// Bit-Sliced Protocol Fuzzer for the cJTAG Bridge
+// =============================================================================
+// Runs 64, 256 or 512 bridges of tb/bitslice_bridge.h side by side, one per
+// lane.  Each lane has its own random stimulus stream of OScan1-shaped
+// traffic: selects with random OAC/EC, packets, escapes of 0-40 toggles,
+// vendor, GOTO, POLL, verify and loopback frames, glitches and long holds, all with random
+// TCKC phase lengths.  Per lane the fuzzer records:
+//   - protocol invariant violations (bridge drives TMSC or clocks TCK while
+//     offline, illegal transitions, counter bounds, VCMD or GOTO without
+//     EC=0x9, poll engine outside VCMD, TCK in a loopback session, ...)
+//   - coverage points, with the first lane that reached each one
+//   - the outcome of every escape by toggle count and return state
+//
+// Interesting lanes (each violation, the first hit of each coverage point)
+// are then confirmed on the Verilated RTL.  The lane's stimulus is
+// regenerated from its seed and replayed on Vtop in lockstep with a one-lane
+// model, and every bridge register is compared each cycle.  --check N also
+// replays N random whole lanes.  A divergence means the model no longer
+// matches cjtag_bridge.sv and fails the run, as does a violation that the
+// RTL confirms.
+//
+// Usage: fuzz_bitslice [--lanes 64|256|512] [--batches N] [--cycles N]
+//                      [--seed S] [--half A-B] [--check N]
+//                      [--seeds-dir DIR] [+log=SPEC]
+//   --lanes      bridges per model word (default 64)
+//   --batches    fresh lane sets to run (default 64)
+//   --cycles     clk_i cycles per batch (default 20000)
+//   --half A-B   TCKC phase length range in clk_i cycles (default 2-8;
+//                the bridge needs >= 3, shorter phases probe the synchronizer)
+//   --check      random whole lanes replayed on the RTL (default 2)
+//   --seeds-dir  write each confirmed finding as DIR/<name>.stim (100 MHz
+//                clk_i; replay with make replay STIM=...)
+// =============================================================================
+
+#include "Vtop.h"
+#include "bitslice_bridge.h"
+#include "cjtag_log.h"
+#include "cjtag_probe.h"
+#include "sim_kernel.h"
+#include "verilated.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+static uint64_t g_rtl_time = 0;
+
+// Verilator time callback - required for $time in SystemVerilog
+double sc_time_stamp() {
+    return (double)g_rtl_time;
+}
+
+static double wall_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct Options {
+    int         lanes     = 64;
+    uint64_t    batches   = 64;
+    uint64_t    cycles    = 20000;
+    uint64_t    seed      = 1;
+    int         half_min  = 2;
+    int         half_max  = 8;
+    int         check     = 2;
+    const char* seeds_dir = nullptr;
+};
+
+static uint64_t lane_seed(const Options& opt, uint64_t batch, int lane) {
+    return splitmix64(opt.seed * 0x100000001B3ull ^ (batch << 16) ^ (uint64_t)lane);
+}
+
+// ─── Per-lane stimulus ───────────────────────────────────────────────────────
+// A stream of segments (pin levels held for `hold` clk_i cycles), generated
+// one protocol operation at a time.  Deterministic in the seed, so any lane
+// can be regenerated on its own for RTL confirmation.
+struct Segment {
+    uint8_t tckc;
+    uint8_t tmsc;
+    uint8_t hold;  // 1-63 cycles
+};
+
+class LaneGen {
+public:
+    void init(uint64_t seed, int half_min, int half_max) {
+        s_        = seed ? seed : 1;
+        half_min_ = half_min;
+        half_max_ = half_max;
+        head_ = tail_ = 0;
+        tckc_ = 0;
+        tmsc_ = 1;
+    }
+
+    Segment next() {
+        if (head_ == tail_) refill();
+        return buf_[head_++ & (CAP - 1)];
+    }
+
+private:
+    static const unsigned CAP = 512;  // longest operation: DR scan + POLL frame, ~480 segments
+
+    uint64_t rnd() {
+        s_ ^= s_ >> 12;
+        s_ ^= s_ << 25;
+        s_ ^= s_ >> 27;
+        return s_ * 0x2545F4914F6CDD1Dull;
+    }
+    unsigned rnd(unsigned n) { return (unsigned)((rnd() >> 32) % n); }
+
+    void push(int tckc, int tmsc, int hold) {
+        if (hold < 1) hold = 1;
+        if (hold > 63) hold = 63;
+        tckc_ = (uint8_t)tckc;
+        tmsc_ = (uint8_t)tmsc;
+        buf_[tail_++ & (CAP - 1)] = Segment{tckc_, tmsc_, (uint8_t)hold};
+    }
+
+    int phase() {
+        int h = lo_;
+        if (rnd(10) == 0) h += (int)rnd(3) - 1;  // occasional edge jitter
+        return h;
+    }
+
+    void cycle(int tmsc) {
+        push(0, tmsc, phase());
+        push(1, tmsc, phase());
+    }
+
+    // TCKC low, high, `toggles` TMSC toggles while high, then low
+    void escape(int toggles) {
+        const int spacing = 1 + (int)rnd(4);
+        push(0, tmsc_, phase());
+        push(1, tmsc_, phase());
+        for (int i = 0; i < toggles; ++i) push(1, !tmsc_, spacing);
+        push(0, tmsc_, phase());
+    }
+
+    void activation() {
+        const int ec  = rnd(10) < 6 ? 0x8 + (int)rnd(4) : (int)rnd(16);
+        const int oac = rnd(10) < 9 ? 0xC : (int)rnd(16);
+        const int cp  = oac ^ ec;
+        const int pkt = oac | (ec << 4) | (cp << 8);
+        for (int i = 0; i < 12; ++i) cycle((pkt >> i) & 1);
+    }
+
+    void packet(int tdi, int tms) {
+        cycle(!tdi);
+        cycle(tms);
+        cycle(0);
+    }
+
+    void packets(int n) {
+        for (int i = 0; i < n; ++i) {
+            cycle(!(int)rnd(2));
+            cycle(rnd(10) < 3);
+            cycle(0);
+        }
+    }
+
+    // 2 toggles with TCKC high, opcode, then pad cycles
+    void vendor_frame(int op, int len) {
+        if (!tckc_) push(1, tmsc_, phase());
+        push(1, !tmsc_, 1 + (int)rnd(4));
+        push(1, !tmsc_, 1 + (int)rnd(4));
+        for (int i = 0; i < len; ++i) cycle(i < 8 ? (op >> i) & 1 : 0);
+    }
+
+    void vendor_frame() {
+        const int op = rnd(10) < 6 ? 0x01 : (int)rnd(256);
+        vendor_frame(op, op == 0x01 || op == 0x0C ? 42 : op == 0x24 ? 48 : 9);
+    }
+
+    // VERIFY_ON, 4-slot packets {nTDI, TMS, EXP, MASK}, then VERIFY_END
+    // (sometimes left out, or cut by an escape mid-packet)
+    void verify_session() {
+        vendor_frame(0x08, 9);
+        const int n = 1 + (int)rnd(40);
+        for (int i = 0; i < n; ++i) {
+            cycle(!(int)rnd(2));
+            cycle(rnd(10) < 3);
+            cycle((int)rnd(2));
+            cycle(rnd(4) != 0);
+        }
+        const unsigned k = rnd(8);
+        if (k == 0) {
+            cycle(!(int)rnd(2));
+            escape(4 + (int)rnd(4));
+        } else if (k > 1) {
+            vendor_frame(0x0C, 42);
+        }
+    }
+
+    // LOOP_ECHO or LOOP_PRBS, packets with random nTDI (mostly the PRBS in
+    // PRBS mode), then LOOP_END (sometimes left out, or cut by an escape)
+    void loop_session() {
+        const bool prbs = rnd(2) != 0;
+        vendor_frame(prbs ? 0x21 : 0x20, 9);
+        unsigned lfsr = 0x7FFF;
+        const int n = 1 + (int)rnd(60);
+        for (int i = 0; i < n; ++i) {
+            const int bit = (lfsr >> 14) & 1;
+            lfsr = ((lfsr << 1) | (((lfsr >> 14) ^ (lfsr >> 13)) & 1)) & 0x7FFF;
+            cycle(prbs && rnd(8) ? bit : (int)rnd(2));
+            cycle((int)rnd(2));
+            cycle(0);
+        }
+        const unsigned k = rnd(8);
+        if (k == 0) {
+            cycle((int)rnd(2));
+            escape(4 + (int)rnd(4));
+        } else if (k > 1) {
+            vendor_frame(0x24, 48);
+        }
+    }
+
+    // 3 toggles with TCKC high, target in frame bits 0, 2, 3, 5 (the TMS
+    // slots are don't-care), then TCKC held high for the walk
+    void goto_frame() {
+        const int tgt = (int)rnd(16);
+        const int frame[6] = {tgt & 1, (int)rnd(2), (tgt >> 1) & 1, (tgt >> 2) & 1, (int)rnd(2), (tgt >> 3) & 1};
+        if (!tckc_) push(1, tmsc_, phase());
+        for (int i = 0; i < 3; ++i) push(1, !tmsc_, 1 + (int)rnd(4));
+        for (int i = 0; i < 6; ++i) cycle(frame[i]);
+        push(1, tmsc_, 18 + (int)rnd(8));
+    }
+
+    // Optionally a DR scan (from Test-Logic-Reset) for the engine to record, then
+    // 2 toggles, opcode 0x04, 88 operand bits and TCKC held high while the
+    // engine runs (sometimes too briefly, so the host clocks into it, or
+    // cut short by an escape)
+    void poll_frame() {
+        if (rnd(2)) {
+            const int n = 1 + (int)rnd(rnd(4) ? 40 : 70);
+            for (int i = 0; i < 5; ++i) packet(0, 1);
+            packet(0, 0);
+            packet(0, 1);
+            packet(0, 0);
+            for (int i = 0; i < n; ++i) packet((int)rnd(2), i == n - 1);
+            packet(0, 1);
+            packet(0, 0);
+        }
+        const uint32_t mask  = (uint32_t)rnd() & (uint32_t)rnd();
+        const uint32_t match = rnd(3) ? 0 : (uint32_t)rnd() & mask;
+        const uint64_t hi    = (uint64_t)rnd(8) | (uint64_t)rnd(4) << 8 | (uint64_t)rnd(4) << 16;
+        if (!tckc_) push(1, tmsc_, phase());
+        push(1, !tmsc_, 1 + (int)rnd(4));
+        push(1, !tmsc_, 1 + (int)rnd(4));
+        for (int i = 0; i < 96; ++i) {
+            const int bit = i < 8 ? (0x04 >> i) & 1
+                          : i < 40 ? (int)(mask >> (i - 8)) & 1
+                          : i < 72 ? (int)(match >> (i - 40)) & 1
+                                   : (int)(hi >> (i - 72)) & 1;
+            cycle(bit);
+        }
+        const unsigned k = rnd(8);
+        if (k == 0) {
+            escape(4 + (int)rnd(4));  // abort the engine
+            return;
+        }
+        const int holds = k == 1 ? 1 : 4 + (int)rnd(6);
+        for (int i = 0; i < holds; ++i) push(1, tmsc_, 63);
+        for (int i = 96; i < 138; ++i) cycle(0);
+    }
+
+    void glitch() {
+        const int w = 1 + (int)rnd(2);
+        if (rnd(2)) {
+            push(tckc_, !tmsc_, w);
+            push(tckc_, !tmsc_, phase());
+        } else {
+            const int level = tckc_;
+            push(!level, tmsc_, w);
+            push(level, tmsc_, phase());
+        }
+    }
+
+    void refill() {
+        lo_ = half_min_ + (int)rnd((unsigned)(half_max_ - half_min_ + 1));
+        const unsigned r = rnd(100);
+        if (r < 25) {
+            escape(6 + (int)rnd(2));
+            activation();
+        } else if (r < 55) {
+            packets(1 + (int)rnd(32));
+        } else if (r < 63) {
+            escape(4 + (int)rnd(2));
+        } else if (r < 72) {
+            const unsigned k = rnd(10);
+            escape(k < 4 ? (int)rnd(12) : k < 7 ? 8 + (int)rnd(4) : (int)rnd(41));
+        } else if (r < 78) {
+            vendor_frame();
+        } else if (r < 84) {
+            goto_frame();
+        } else if (r < 87) {
+            poll_frame();
+        } else if (r < 90) {
+            verify_session();
+        } else if (r < 93) {
+            loop_session();
+        } else if (r < 96) {
+            glitch();
+        } else {
+            push((int)rnd(2), tmsc_, 10 + (int)rnd(54));
+        }
+    }
+
+    Segment  buf_[CAP];
+    unsigned head_ = 0, tail_ = 0;
+    uint64_t s_    = 1;
+    int      half_min_ = 2, half_max_ = 8, lo_ = 5;
+    uint8_t  tckc_ = 0, tmsc_ = 1;
+};
+
+// ─── Invariants and coverage ─────────────────────────────────────────────────
+enum Violation {
+    V_BAD_STATE,
+    V_ILLEGAL_TRANSITION,
+    V_ESCAPE_HELD,
+    V_RESUME_NO_CTX,
+    V_VCMD_NO_VEXT,
+    V_GOTO_NO_VEXT,
+    V_POLL_OUTSIDE_VCMD,
+    V_BIT_POS,
+    V_ACT_COUNT,
+    V_DRIVE_OFFLINE,
+    V_TCK_OFFLINE,
+    V_TCK_LOOPBACK,
+    V_COUNT
+};
+
+static const char* const violation_names[V_COUNT] = {
+    "bad_state",     "illegal_transition", "escape_held",    "resume_without_context",
+    "vcmd_without_vext", "goto_without_vext", "poll_outside_vcmd", "bit_pos_3",  "activation_count",
+    "tmsc_driven_offline", "tck_offline", "tck_in_loopback",
+};
+
+enum Cover {
+    C_SELECT,
+    C_ACT_VALID,
+    C_ACT_INVALID,
+    C_ACT_ESCAPE,
+    C_OSCAN1_ESCAPE,
+    C_DESELECT,
+    C_CTX_SAVED,
+    C_RESUME,
+    C_RESET_ESCAPE,
+    C_INVALID_ESCAPE,
+    C_TDO_WINDOW,
+    C_VCMD_ENTER,
+    C_VCMD_CRC_READ,
+    C_VCMD_DONE,
+    C_VCMD_ESCAPE,
+    C_GOTO_ENTER,
+    C_GOTO_DONE,
+    C_GOTO_ESCAPE,
+    C_POLL_START,
+    C_POLL_SCAN,
+    C_POLL_DONE,
+    C_POLL_ESCAPE,
+    C_VERIFY_ON,
+    C_VERIFY_MISMATCH,
+    C_VERIFY_END,
+    C_LOOP_START,
+    C_LOOP_ERROR,
+    C_LOOP_END,
+    C_TOGGLE_WRAP,
+    C_ESCAPE_DRIVING,
+    C_COUNT
+};
+
+static const char* const cover_names[C_COUNT] = {
+    "select",        "activation_valid", "activation_invalid", "activation_escape",
+    "oscan1_escape", "deselect",         "context_saved",      "context_resume",
+    "reset_escape",  "invalid_escape",   "tdo_window",         "vcmd_enter",
+    "vcmd_crc_read", "vcmd_done",        "vcmd_escape",        "goto_enter",
+    "goto_done",     "goto_escape",      "poll_start",         "poll_scan",
+    "poll_done",     "poll_escape",      "verify_on",          "verify_mismatch",
+    "verify_end",    "loop_start",       "loop_prbs_error",    "loop_end",
+    "toggle_count_wrap", "escape_while_driving",
+};
+
+struct Hit {
+    uint64_t count = 0;
+    bool     seen  = false;
+    uint64_t batch = 0;
+    int      lane  = 0;
+    uint64_t cycle = 0;
+};
+
+struct FuzzStats {
+    Hit      viol[V_COUNT];
+    Hit      cover[C_COUNT];
+    uint64_t escapes[3][32][5] = {};  // [return OFFLINE/ONLINE_ACT/OSCAN1][toggles][next state]
+    uint64_t lane_cycles       = 0;
+    double   wall              = 0.0;
+};
+
+template <typename W>
+static void record(Hit& h, const W& m, uint64_t batch, uint64_t cycle) {
+    if (!bs_any(m)) return;
+    h.count += bs_count(m);
+    if (h.seen) return;
+    for (int w = 0; w < bs_words<W>(); ++w) {
+        const uint64_t bits = bs_word(m, w);
+        if (bits) {
+            h.seen  = true;
+            h.batch = batch;
+            h.lane  = w * 64 + __builtin_ctzll(bits);
+            h.cycle = cycle;
+            return;
+        }
+    }
+}
+
+template <typename W>
+static void check_cycle(const BitsliceBridge<W>& m, FuzzStats& st, uint64_t batch, uint64_t cycle) {
+    typedef BitsliceBridge<W> M;
+    const BitsliceRegs<W>&   r  = m.r;
+    const BitsliceEvents<W>& ev = m.ev;
+
+    const W was_off  = bs_eq(ev.old_state, 3, M::ST_OFFLINE);
+    const W was_esc  = bs_eq(ev.old_state, 3, M::ST_ESCAPE);
+    const W was_act  = bs_eq(ev.old_state, 3, M::ST_ONLINE_ACT);
+    const W was_osc  = bs_eq(ev.old_state, 3, M::ST_OSCAN1);
+    const W was_vcmd = bs_eq(ev.old_state, 3, M::ST_VCMD);
+    const W was_goto = bs_eq(ev.old_state, 3, M::ST_GOTO);
+    const W is_off   = m.in_state(M::ST_OFFLINE);
+    const W is_esc   = m.in_state(M::ST_ESCAPE);
+    const W is_act   = m.in_state(M::ST_ONLINE_ACT);
+    const W is_osc   = m.in_state(M::ST_OSCAN1);
+    const W is_vcmd  = m.in_state(M::ST_VCMD);
+    const W is_goto  = m.in_state(M::ST_GOTO);
+    const W was_on   = was_osc | was_vcmd | was_goto;
+    const W is_on    = is_osc | is_vcmd | is_goto;
+
+    // Mirrors the SVA in cjtag_bridge.sv (Verilator builds run without --assert)
+    record(st.viol[V_BAD_STATE], ~(is_off | is_esc | is_act | is_osc | is_vcmd | is_goto), batch, cycle);
+    const W legal = (was_off & (is_off | is_esc)) | (was_esc & (is_off | is_act | is_osc)) |
+                    (was_act & (is_act | is_esc | is_osc | is_off)) |
+                    (was_osc & (is_osc | is_esc | is_off | is_vcmd | is_goto)) |
+                    (was_vcmd & (is_vcmd | is_osc | is_esc)) | (was_goto & (is_goto | is_osc | is_esc));
+    record(st.viol[V_ILLEGAL_TRANSITION], ~legal, batch, cycle);
+    record(st.viol[V_ESCAPE_HELD], was_esc & is_esc, batch, cycle);
+    record(st.viol[V_RESUME_NO_CTX], was_esc & is_osc & ~ev.resume, batch, cycle);
+    record(st.viol[V_VCMD_NO_VEXT], is_vcmd & ~r.vext_en, batch, cycle);
+    record(st.viol[V_GOTO_NO_VEXT], is_goto & ~r.vext_en, batch, cycle);
+    record(st.viol[V_POLL_OUTSIDE_VCMD], ~bs_eq(r.poll_phase, 3, M::POLL_OFF) & ~is_vcmd & ~was_vcmd, batch, cycle);
+    record(st.viol[V_BIT_POS], is_osc & r.bit_pos[1] & r.bit_pos[0] & ~r.verify_en, batch, cycle);
+    record(st.viol[V_ACT_COUNT], is_act & ~bs_lt(r.activation_count, 4, 12), batch, cycle);
+    // Protocol: TMSC and TCK belong to the host while the bridge is offline
+    // (the escape cycle itself may still close an open TDO window)
+    record(st.viol[V_DRIVE_OFFLINE], ~r.tmsc_oen & ~is_on & ~was_on, batch, cycle);
+    record(st.viol[V_TCK_OFFLINE], r.tck & ~is_on & ~was_on, batch, cycle);
+    // Loopback parks TCK for packets; GOTO and POLL still clock the TAP
+    record(st.viol[V_TCK_LOOPBACK], r.tck & m.loop_on() & is_osc, batch, cycle);
+
+    record(st.cover[C_SELECT], ev.select, batch, cycle);
+    record(st.cover[C_ACT_VALID], ev.act_valid, batch, cycle);
+    record(st.cover[C_ACT_INVALID], ev.act_invalid, batch, cycle);
+    record(st.cover[C_ACT_ESCAPE], ev.act_escape, batch, cycle);
+    record(st.cover[C_OSCAN1_ESCAPE], ev.oscan1_escape, batch, cycle);
+    record(st.cover[C_DESELECT], ev.deselect, batch, cycle);
+    record(st.cover[C_CTX_SAVED], ev.ctx_saved, batch, cycle);
+    record(st.cover[C_RESUME], ev.resume, batch, cycle);
+    record(st.cover[C_RESET_ESCAPE], ev.reset_escape, batch, cycle);
+    record(st.cover[C_INVALID_ESCAPE], ev.invalid_escape, batch, cycle);
+    record(st.cover[C_TDO_WINDOW], ev.tdo_window, batch, cycle);
+    record(st.cover[C_VCMD_ENTER], ev.vcmd_enter, batch, cycle);
+    record(st.cover[C_VCMD_CRC_READ], ev.vcmd_crc_read, batch, cycle);
+    record(st.cover[C_VCMD_DONE], ev.vcmd_done, batch, cycle);
+    record(st.cover[C_VCMD_ESCAPE], ev.vcmd_escape, batch, cycle);
+    record(st.cover[C_GOTO_ENTER], ev.goto_enter, batch, cycle);
+    record(st.cover[C_GOTO_DONE], ev.goto_done, batch, cycle);
+    record(st.cover[C_GOTO_ESCAPE], ev.goto_escape, batch, cycle);
+    record(st.cover[C_POLL_START], ev.poll_start, batch, cycle);
+    record(st.cover[C_POLL_SCAN], ev.poll_scan, batch, cycle);
+    record(st.cover[C_POLL_DONE], ev.poll_done, batch, cycle);
+    record(st.cover[C_POLL_ESCAPE], ev.poll_escape, batch, cycle);
+    record(st.cover[C_VERIFY_ON], ev.verify_on, batch, cycle);
+    record(st.cover[C_VERIFY_MISMATCH], ev.verify_mismatch, batch, cycle);
+    record(st.cover[C_VERIFY_END], ev.verify_end, batch, cycle);
+    record(st.cover[C_LOOP_START], ev.loop_start, batch, cycle);
+    record(st.cover[C_LOOP_ERROR], ev.loop_error, batch, cycle);
+    record(st.cover[C_LOOP_END], ev.loop_end, batch, cycle);
+    record(st.cover[C_TOGGLE_WRAP], ev.toggle_wrap, batch, cycle);
+    record(st.cover[C_ESCAPE_DRIVING], is_esc & ~r.tmsc_oen, batch, cycle);
+
+    // Escape outcomes (rare: only when some lane evaluated one)
+    if (!bs_any(ev.escape_eval)) return;
+    static const unsigned from[3] = {M::ST_OFFLINE, M::ST_ONLINE_ACT, M::ST_OSCAN1};
+    for (int f = 0; f < 3; ++f) {
+        const W mf = ev.escape_eval & bs_eq(ev.escape_from, 3, from[f]);
+        if (!bs_any(mf)) continue;
+        for (unsigned t = 0; t < 32; ++t) {
+            const W mt = mf & bs_eq(ev.escape_toggles, 5, t);
+            if (!bs_any(mt)) continue;
+            for (unsigned s = 0; s < 5; ++s) st.escapes[f][t][s] += bs_count(mt & m.in_state(s));
+        }
+    }
+}
+
+// ─── Bit-sliced run ──────────────────────────────────────────────────────────
+// Segment boundaries are scheduled on a 64-slot timing wheel of lane masks,
+// so a cycle only touches the lanes whose pins change.
+template <typename W>
+static void run_batches(const Options& opt, FuzzStats& st) {
+    const int LANES = BitsliceBridge<W>::LANES;
+    const int WORDS = LANES / 64;
+    std::vector<LaneGen> gen((size_t)LANES);
+    std::vector<uint64_t> wheel((size_t)64 * WORDS);
+    std::vector<uint64_t> tckc((size_t)WORDS), tmsc((size_t)WORDS);
+
+    const double w0 = wall_s();
+    for (uint64_t b = 0; b < opt.batches; ++b) {
+        for (int l = 0; l < LANES; ++l) gen[(size_t)l].init(lane_seed(opt, b, l), opt.half_min, opt.half_max);
+        std::fill(wheel.begin(), wheel.end(), 0);
+        for (int w = 0; w < WORDS; ++w) {
+            wheel[(size_t)w] = ~0ull;  // every lane starts a segment at cycle 0
+            tckc[(size_t)w]  = 0;
+            tmsc[(size_t)w]  = ~0ull;
+        }
+        BitsliceBridge<W> m;
+        uint64_t tdo_s = lane_seed(opt, b, -1);
+
+        for (uint64_t c = 0; c < opt.cycles; ++c) {
+            uint64_t* due = &wheel[(size_t)(c & 63) * WORDS];
+            for (int w = 0; w < WORDS; ++w) {
+                uint64_t bits = due[w];
+                due[w] = 0;
+                while (bits) {
+                    const int     bit = __builtin_ctzll(bits);
+                    const uint64_t mask = 1ull << bit;
+                    bits &= bits - 1;
+                    const Segment s = gen[(size_t)(w * 64 + bit)].next();
+                    tckc[(size_t)w] = s.tckc ? (tckc[(size_t)w] | mask) : (tckc[(size_t)w] & ~mask);
+                    tmsc[(size_t)w] = s.tmsc ? (tmsc[(size_t)w] | mask) : (tmsc[(size_t)w] & ~mask);
+                    wheel[(size_t)((c + s.hold) & 63) * WORDS + w] |= mask;
+                }
+            }
+            W in_tckc, in_tmsc, in_tdo;
+            memcpy(&in_tckc, tckc.data(), sizeof(W));
+            memcpy(&in_tmsc, tmsc.data(), sizeof(W));
+            // No TAP here: the poll engine samples noise
+            for (int w = 0; w < WORDS; ++w) bs_set_word(in_tdo, w, tdo_s = splitmix64(tdo_s));
+            m.step(in_tckc, in_tmsc, in_tdo);
+            check_cycle(m, st, b, c);
+        }
+        st.lane_cycles += opt.cycles * (uint64_t)LANES;
+    }
+    st.wall = wall_s() - w0;
+}
+
+// ─── RTL confirmation ────────────────────────────────────────────────────────
+struct RtlRun {
+    uint64_t cycles = 0;
+    double   wall   = 0.0;
+};
+
+static void rtl_cycle(Vtop* dut) {
+    dut->clk_i = 1;
+    dut->eval();
+    ++g_rtl_time;
+    dut->clk_i = 0;
+    dut->eval();
+    ++g_rtl_time;
+}
+
+// Compare lane 0 of a one-lane model with the RTL; name of the first
+// differing signal, or nullptr
+static const char* rtl_diff(const BitsliceBridge<uint64_t>& m, Vtop* dut, uint32_t* mv, uint32_t* rv) {
+    const BitsliceRegs<uint64_t>& r = m.r;
+#define CMP(name, model, rtl) do { \
+        *mv = (uint32_t)(model); \
+        *rv = (uint32_t)(rtl); \
+        if (*mv != *rv) return name; \
+    } while (0)
+    CMP("state", bs_value(r.state, 3, 0), probe_bridge_state(dut));
+    CMP("return_state", bs_value(r.return_state, 3, 0), probe_return_state(dut));
+    CMP("tmsc_toggle_count", bs_value(r.tmsc_toggle_count, 5, 0), probe_tmsc_toggle_count(dut));
+    CMP("bit_pos", bs_value(r.bit_pos, 2, 0), probe_bit_pos(dut));
+    CMP("activation_count", bs_value(r.activation_count, 4, 0), probe_activation_count(dut));
+    CMP("activation_shift", bs_value(r.activation_shift, 11, 0), probe_activation_shift(dut));
+    CMP("tmsc_sampled", bs_value(&r.tmsc_sampled, 1, 0), probe_tmsc_sampled(dut));
+    CMP("vext_en", bs_value(&r.vext_en, 1, 0), probe_vext_en(dut));
+    CMP("vcmd_count", bs_value(r.vcmd_count, 8, 0), probe_vcmd_count(dut));
+    CMP("vcmd_op", bs_value(r.vcmd_op, 8, 0), probe_vcmd_op(dut));
+    CMP("crc_tdi", bs_value(r.crc_tdi, 16, 0), probe_crc_tdi(dut));
+    CMP("crc_tms", bs_value(r.crc_tms, 16, 0), probe_crc_tms(dut));
+    CMP("retain_en", bs_value(&r.retain_en, 1, 0), probe_retain_en(dut));
+    CMP("ctx_valid", bs_value(&r.ctx_valid, 1, 0), probe_ctx_valid(dut));
+    CMP("ctx_vext", bs_value(&r.ctx_vext, 1, 0), probe_ctx_vext(dut));
+    CMP("tap_mirror", bs_value(r.tap_mirror, 4, 0), probe_tap_mirror(dut));
+    CMP("goto_count", bs_value(r.goto_count, 3, 0), probe_goto_count(dut));
+    CMP("goto_tgt", bs_value(r.goto_tgt, 4, 0), probe_goto_tgt(dut));
+    CMP("goto_steps", bs_value(r.goto_steps, 4, 0), probe_goto_steps(dut));
+    CMP("scan_len", bs_value(r.scan_len, 7, 0), probe_scan_len(dut));
+    CMP("scan_tdi[31:0]", bs_value(r.scan_tdi, 32, 0), probe_scan_tdi(dut));
+    CMP("scan_tdi[63:32]", bs_value(r.scan_tdi + 32, 32, 0), probe_scan_tdi(dut) >> 32);
+    CMP("poll_phase", bs_value(r.poll_phase, 3, 0), probe_poll_phase(dut));
+    CMP("poll_cnt", bs_value(r.poll_cnt, 8, 0), probe_poll_cnt(dut));
+    CMP("poll_tries", bs_value(r.poll_tries, 8, 0), probe_poll_tries(dut));
+    CMP("poll_tdo", bs_value(r.poll_tdo, 32, 0), probe_poll_tdo(dut));
+    CMP("verify_en", bs_value(&r.verify_en, 1, 0), probe_verify_en(dut));
+    CMP("verify_fail", bs_value(&r.verify_fail, 1, 0), probe_verify_fail(dut));
+    CMP("verify_count", bs_value(r.verify_count, 16, 0), probe_verify_count(dut));
+    CMP("verify_first", bs_value(r.verify_first, 16, 0), probe_verify_first(dut));
+    CMP("loop_mode", bs_value(r.loop_mode, 2, 0), probe_loop_mode(dut));
+    CMP("loop_prbs", bs_value(r.loop_prbs, 15, 0), probe_loop_prbs(dut));
+    CMP("loop_count", bs_value(r.loop_count, 24, 0), probe_loop_count(dut));
+    CMP("loop_errors", bs_value(r.loop_errors, 16, 0), probe_loop_errors(dut));
+    CMP("online_o", m.online() & 1, dut->online_o);
+    CMP("tmsc_oen", r.tmsc_oen & 1, dut->tmsc_oen);
+    CMP("tck_o", r.tck & 1, dut->tck_o);
+    CMP("tms_o", r.tms & 1, dut->tms_o);
+    CMP("tdi_o", r.tdi & 1, dut->tdi_o);
+    CMP("rtck_o", r.rtck & 1, dut->rtck_o);
+    if (m.in_state(BitsliceBridge<uint64_t>::ST_VCMD) & ~r.tmsc_oen & 1) {
+        CMP("tmsc_o (vendor response)", m.tmsc_o_vcmd() & 1, dut->tmsc_o);
+    } else if (m.loop_on() & ~r.tmsc_oen & 1) {
+        CMP("tmsc_o (loopback)", m.tmsc_o_loop() & 1, dut->tmsc_o);
+    }
+#undef CMP
+    return nullptr;
+}
+
+// Replay one lane for `cycles` cycles on the RTL in lockstep with the model.
+// Optionally writes the wire activity as .stim (100 MHz clk_i).
+static bool confirm_lane(Vtop* dut, const Options& opt, uint64_t batch, int lane, uint64_t cycles,
+                         const char* stim_path, RtlRun& run) {
+    LaneGen g;
+    g.init(lane_seed(opt, batch, lane), opt.half_min, opt.half_max);
+    BitsliceBridge<uint64_t> m;
+
+    // Reset: same pin levels as the generator's idle state
+    dut->jtag_sel_i = 0;
+    dut->jtag_tck_i = 0;
+    dut->jtag_tms_i = 1;
+    dut->jtag_tdi_i = 0;
+    dut->tckc_i     = 0;
+    dut->tmsc_i     = 1;
+    dut->ntrst_i    = 0;
+    for (int i = 0; i < 4; ++i) rtl_cycle(dut);
+    dut->ntrst_i = 1;
+    dut->eval();
+
+    std::vector<StimEvent> ev;
+    const sim_ps_t period = 10000;
+    uint8_t  tckc = 0, tmsc = 1;
+    unsigned left = 0;
+    const double w0 = wall_s();
+    bool ok = true;
+    for (uint64_t c = 0; c < cycles; ++c) {
+        if (left == 0) {
+            const Segment s = g.next();
+            if (stim_path && (ev.empty() || s.tckc != tckc || s.tmsc != tmsc)) {
+                ev.push_back(StimEvent{c * period + period / 4, s.tckc, s.tmsc, 0});
+            }
+            tckc = s.tckc;
+            tmsc = s.tmsc;
+            left = s.hold;
+        }
+        --left;
+
+        // All lanes identical; lane 0 compared.  The poll engine samples the
+        // TAP's TDO as it is before the edge.
+        m.step(tckc ? ~0ull : 0ull, tmsc ? ~0ull : 0ull, dut->tdo_comb_o ? ~0ull : 0ull);
+        dut->tckc_i = tckc;
+        dut->tmsc_i = tmsc;
+        rtl_cycle(dut);
+
+        uint32_t mv = 0, rv = 0;
+        const char* diff = rtl_diff(m, dut, &mv, &rv);
+        if (diff) {
+            printf("  ❌ model/RTL divergence at cycle %llu: %s model=0x%x rtl=0x%x\n", (unsigned long long)c, diff,
+                   mv, rv);
+            ok = false;
+            cycles = c + 1;
+            break;
+        }
+    }
+    run.cycles += cycles;
+    run.wall += wall_s() - w0;
+
+    if (stim_path && ok) {
+        char note[128];
+        snprintf(note, sizeof note, "fuzz_bitslice seed %llu batch %llu lane %d",
+                 (unsigned long long)opt.seed, (unsigned long long)batch, lane);
+        StimWriter w;
+        if (w.open(stim_path, note)) {
+            for (const StimEvent& e : ev) w.write(e);
+            w.close();
+        } else {
+            printf("  (cannot write %s)\n", stim_path);
+        }
+    }
+    return ok;
+}
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+static bool parse_range(const char* s, int* a, int* b) {
+    return sscanf(s, "%d-%d", a, b) == 2 && *a >= 1 && *b >= *a && *b <= 30;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    cjtag_log_init(argc, argv);
+
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--lanes") == 0 && i + 1 < argc) {
+            opt.lanes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batches") == 0 && i + 1 < argc) {
+            opt.batches = strtoull(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            opt.cycles = strtoull(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opt.seed = strtoull(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--half") == 0 && i + 1 < argc) {
+            if (!parse_range(argv[++i], &opt.half_min, &opt.half_max)) {
+                fprintf(stderr, "--half expects A-B with 1 <= A <= B <= 30\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+            opt.check = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seeds-dir") == 0 && i + 1 < argc) {
+            opt.seeds_dir = argv[++i];
+        } else if (argv[i][0] != '+') {
+            fprintf(stderr,
+                    "usage: fuzz_bitslice [--lanes 64|256|512] [--batches N] [--cycles N] [--seed S]\n"
+                    "                     [--half A-B] [--check N] [--seeds-dir DIR]\n");
+            return 1;
+        }
+    }
+    if (opt.lanes != 64 && opt.lanes != 256 && opt.lanes != 512) {
+        fprintf(stderr, "--lanes must be 64, 256 or 512\n");
+        return 1;
+    }
+
+    printf("========================================\n");
+    printf("cJTAG Bit-Sliced Fuzzer\n");
+    printf("%d lanes x %llu batches x %llu cycles, seed %llu, TCKC phase %d-%d clk\n", opt.lanes,
+           (unsigned long long)opt.batches, (unsigned long long)opt.cycles, (unsigned long long)opt.seed,
+           opt.half_min, opt.half_max);
+    printf("========================================\n");
+
+    FuzzStats st;
+    if (opt.lanes == 64) run_batches<Lanes64>(opt, st);
+    else if (opt.lanes == 256) run_batches<Lanes256>(opt, st);
+    else run_batches<Lanes512>(opt, st);
+
+    printf("Model:      %.3g lane-cycles in %.2f s (%.3g lane-cycles/s)\n", (double)st.lane_cycles, st.wall,
+           st.wall > 0.0 ? (double)st.lane_cycles / st.wall : 0.0);
+
+    printf("\nCoverage (lane-cycles hit, first hit):\n");
+    for (int i = 0; i < C_COUNT; ++i) {
+        const Hit& h = st.cover[i];
+        if (h.seen) {
+            printf("  %-22s %12llu  batch %llu lane %d cycle %llu\n", cover_names[i], (unsigned long long)h.count,
+                   (unsigned long long)h.batch, h.lane, (unsigned long long)h.cycle);
+        } else {
+            printf("  %-22s %12s\n", cover_names[i], "-");
+        }
+    }
+
+    printf("\nEscape outcomes by toggle count (next state per return state):\n");
+    static const char* const from_names[3] = {"OFFLINE", "ONLINE_ACT", "OSCAN1"};
+    static const char  state_letter[5] = {'F', 'E', 'A', 'S', 'V'};
+    for (int t = 0; t < 32; ++t) {
+        bool any = false;
+        for (int f = 0; f < 3; ++f) {
+            for (int s = 0; s < 5; ++s) any |= st.escapes[f][t][s] != 0;
+        }
+        if (!any) continue;
+        printf("  %2d:", t);
+        for (int f = 0; f < 3; ++f) {
+            printf("  %s->", from_names[f]);
+            bool first = true;
+            for (int s = 0; s < 5; ++s) {
+                if (!st.escapes[f][t][s]) continue;
+                printf("%s%c", first ? "" : "/", state_letter[s]);
+                first = false;
+            }
+            if (first) printf("-");
+        }
+        printf("\n");
+    }
+    printf("  (F=OFFLINE E=ESCAPE A=ONLINE_ACT S=OSCAN1 V=VCMD)\n");
+
+    // Confirm findings on the RTL
+    if (opt.seeds_dir) mkdir(opt.seeds_dir, 0755);  // may already exist
+    Vtop*  dut = new Vtop;
+    RtlRun rtl;
+    int    divergences = 0, confirmed_viol = 0;
+    auto   stim_path = [&](const char* kind, const char* name) -> std::string {
+        if (!opt.seeds_dir) return std::string();
+        return std::string(opt.seeds_dir) + "/" + kind + "_" + name + ".stim";
+    };
+
+    printf("\nRTL confirmation:\n");
+    for (int i = 0; i < V_COUNT; ++i) {
+        const Hit& h = st.viol[i];
+        if (!h.seen) continue;
+        printf("  VIOLATION %-22s batch %llu lane %d cycle %llu (%llu lane-cycles)\n", violation_names[i],
+               (unsigned long long)h.batch, h.lane, (unsigned long long)h.cycle, (unsigned long long)h.count);
+        const std::string p = stim_path("violation", violation_names[i]);
+        if (confirm_lane(dut, opt, h.batch, h.lane, h.cycle + 32, p.empty() ? nullptr : p.c_str(), rtl)) {
+            printf("  ❌ confirmed on RTL\n");
+            ++confirmed_viol;
+        } else {
+            ++divergences;
+        }
+    }
+    int confirmed_cover = 0, cover_seeds = 0;
+    for (int i = 0; i < C_COUNT; ++i) {
+        const Hit& h = st.cover[i];
+        if (!h.seen) continue;
+        ++cover_seeds;
+        const std::string p = stim_path("cover", cover_names[i]);
+        if (confirm_lane(dut, opt, h.batch, h.lane, h.cycle + 32, p.empty() ? nullptr : p.c_str(), rtl)) {
+            ++confirmed_cover;
+        } else {
+            printf("  (while confirming %s)\n", cover_names[i]);
+            ++divergences;
+        }
+    }
+    printf("  %d/%d coverage seeds reproduced\n", confirmed_cover, cover_seeds);
+    uint64_t s = splitmix64(opt.seed ^ 0xC4EC);
+    for (int i = 0; i < opt.check; ++i) {
+        s = splitmix64(s);
+        const uint64_t batch = (s >> 20) % opt.batches;
+        const int      lane  = (int)(s % (uint64_t)opt.lanes);
+        if (!confirm_lane(dut, opt, batch, lane, opt.cycles, nullptr, rtl)) {
+            printf("  (whole-lane check batch %llu lane %d)\n", (unsigned long long)batch, lane);
+            ++divergences;
+        }
+    }
+    if (opt.check > 0) printf("  %d whole lanes replayed\n", opt.check);
+    if (rtl.wall > 0.0 && st.wall > 0.0) {
+        const double rtl_rate   = (double)rtl.cycles / rtl.wall;
+        const double model_rate = (double)st.lane_cycles / st.wall;
+        printf("  RTL %.3g cycles/s; bit-sliced model %.0fx faster per lane-cycle\n", rtl_rate,
+               model_rate / rtl_rate);
+    }
+
+    dut->final();
+    delete dut;
+
+    printf("\n");
+    if (divergences) {
+        printf("❌ %d model/RTL divergences: bitslice_bridge.h no longer matches cjtag_bridge.sv\n", divergences);
+        return 1;
+    }
+    if (confirmed_viol) {
+        printf("❌ %d invariant violations confirmed on the RTL\n", confirmed_viol);
+        cjtag_log_dump_tail(stdout);
+        return 1;
+    }
+    printf("✅ No violations; model matches RTL on every replayed lane\n");
+    return 0;
+}
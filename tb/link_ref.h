@@ -0,0 +1,31 @@
+// =============================================================================
+// Host-Side Reference for the Bridge's Link Checks
+// =============================================================================
+// The two sequences the bridge runs on the link itself, as a host computes
+// them to check its answers:
+//
+//   link_crc16()   one step of crc_tdi / crc_tms (VCMD_CRC_READ): CRC-16/CCITT,
+//                  polynomial 0x1021, MSB first, as crc16_step() in
+//                  cjtag_bridge.sv.  Start from 0xFFFF.
+//   prbs15_next()  the VCMD_LOOP_PRBS sequence: x^15 + x^14 + 1, returns bit 14
+//                  and then steps.  Start from 0x7FFF (all ones).
+// =============================================================================
+
+#ifndef LINK_REF_H
+#define LINK_REF_H
+
+#include <stdint.h>
+
+static inline uint16_t link_crc16(uint16_t crc, int bit) {
+    const bool fb = ((crc >> 15) ^ bit) & 1;
+    crc = (uint16_t)(crc << 1);
+    return fb ? (uint16_t)(crc ^ 0x1021) : crc;
+}
+
+static inline int prbs15_next(uint16_t& lfsr) {
+    const int bit = (lfsr >> 14) & 1;
+    lfsr = ((lfsr << 1) | (bit ^ ((lfsr >> 13) & 1))) & 0x7FFF;
+    return bit;
+}
+
+#endif // LINK_REF_H
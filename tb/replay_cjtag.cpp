@@ -0,0 +1,243 @@
+// =============================================================================
+// Wire-Level Replay Harness for the cJTAG Bridge
+// =============================================================================
+// Replays a .stim file (tb/sim_kernel.h format: synthetic timelines from
+// bench_clock_ratio --stim-out, or logic-analyser captures converted with
+// tools/la2stim) against the bridge on the event kernel.  The file is
+// streamed, so captures far larger than memory replay in constant space.
+//
+// Reported: bridge activations/deselections, TAP traffic mix (states
+// entered), TCKC cycles, simulated vs wall time.  With --check-tdo every TCKC
+// rise while the bridge drives TMSC compares tmsc_o against the captured
+// TMSC level, i.e. against what the real target answered.
+//
+// Usage: replay_cjtag FILE.stim [--clk-mhz F] [--repeat N] [--check-tdo]
+//                              [--trace] [+log=SPEC]
+//   --clk-mhz  clk_i frequency (use the value the capture was resampled to)
+//   --repeat   replay the file N times back to back (benchmark long mixes)
+//   --trace    dump replay_cjtag.fst
+// Exit status is non-zero if the stimulus is malformed, the bridge never went
+// online although TCKC was clocked, or --check-tdo saw a mismatch.
+// =============================================================================
+
+#include "Vtop.h"
+#include "cjtag_log.h"
+#include "cjtag_probe.h"
+#include "sim_kernel.h"
+#include "verilated.h"
+#include "verilated_fst_c.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <functional>
+
+static SimKernel* g_kernel = nullptr;
+
+// Verilator time callback - required for $time in SystemVerilog
+double sc_time_stamp() {
+    return g_kernel ? (double)g_kernel->now() : 0;
+}
+
+// ─── Replay statistics ───────────────────────────────────────────────────────
+struct ReplayStats {
+    uint64_t tckc_rises      = 0;
+    uint64_t activations     = 0;  // online_o rising
+    uint64_t deselections    = 0;  // online_o falling
+    uint64_t tdo_checked     = 0;
+    uint64_t tdo_mismatch    = 0;
+    uint64_t tap_entered[16] = {};
+    sim_ps_t online_ps       = 0;
+};
+
+static double wall_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    cjtag_log_init(argc, argv);
+
+    const char* path      = nullptr;
+    double      clk_mhz   = 100.0;
+    int         repeat    = 1;
+    bool        check_tdo = false;
+    bool        trace     = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--clk-mhz") == 0 && i + 1 < argc) {
+            clk_mhz = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check-tdo") == 0) {
+            check_tdo = true;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            trace = true;
+        } else if (argv[i][0] != '-' && argv[i][0] != '+' && !path) {
+            path = argv[i];
+        }
+    }
+    if (!path || clk_mhz <= 0.0 || repeat < 1) {
+        fprintf(stderr, "usage: replay_cjtag FILE.stim [--clk-mhz F] [--repeat N] [--check-tdo] [--trace]\n");
+        return 1;
+    }
+
+    printf("========================================\n");
+    printf("cJTAG Wire Replay: %s\n", path);
+    printf("clk_i %.3f MHz, %d pass(es)%s\n", clk_mhz, repeat, check_tdo ? ", TDO checked against capture" : "");
+    printf("========================================\n");
+
+    Vtop* dut = new Vtop;
+    VerilatedFstC* tfp = nullptr;
+    if (trace) {
+        Verilated::traceEverOn(true);
+        tfp = new VerilatedFstC;
+        dut->trace(tfp, 99);
+        tfp->open("replay_cjtag.fst");
+    }
+
+    SimKernel k([dut] { dut->eval(); });
+    g_kernel = &k;
+    cjtag_log_set_clock(k.clock());
+
+    // Post-eval monitor: bridge online transitions and TAP traffic mix
+    ReplayStats st;
+    uint8_t  last_online = 0, last_tap = TAP_TEST_LOGIC_RESET;
+    sim_ps_t online_since = 0;
+    k.set_dump([&](sim_ps_t t) {
+        if (tfp) tfp->dump(t);
+        if (dut->online_o != last_online) {
+            last_online = dut->online_o;
+            if (last_online) {
+                ++st.activations;
+                online_since = t;
+            } else {
+                ++st.deselections;
+                st.online_ps += t - online_since;
+            }
+        }
+        const uint8_t tap = probe_tap_state(dut);
+        if (tap != last_tap) {
+            last_tap = tap;
+            ++st.tap_entered[tap & 0xF];
+        }
+    });
+
+    // Reset as the tick harnesses do, with clk_i free-running
+    dut->ntrst_i    = 0;
+    dut->tckc_i     = 0;
+    dut->tmsc_i     = 1;
+    dut->jtag_sel_i = 0;
+    dut->jtag_tck_i = 0;
+    dut->jtag_tms_i = 1;
+    dut->jtag_tdi_i = 0;
+    dut->clk_i      = 0;
+    const ClockSpec clk = ClockSpec::from_mhz(clk_mhz);
+    k.add_clock(clk, [dut](bool level) { dut->clk_i = level; });
+    k.at((sim_ps_t)(100 * clk.period_ps), [dut] { dut->ntrst_i = 1; });
+    const sim_ps_t t0 = (sim_ps_t)(120 * clk.period_ps);
+    k.run_until(t0);
+
+    // Streamed replay: each wire event schedules the next one
+    StimReader rd;
+    StimEvent  ev;
+    sim_ps_t   offset   = t0;
+    sim_ps_t   last_end = t0;
+    int        pass     = 0;
+    bool       done     = false;
+    bool       bad_stim = false;
+
+    std::function<void()> schedule_next = [&]() {
+        if (!rd.next(ev)) {
+            bad_stim |= rd.error();
+            if (bad_stim || ++pass >= repeat || !rd.open(path) || !rd.next(ev)) {
+                done = true;
+                return;
+            }
+            // Restart on a whole clk_i period so each pass keeps the events'
+            // own phase (la2stim puts them mid low phase)
+            const double cycles = ceil((double)last_end / clk.period_ps) + 20;
+            offset = (sim_ps_t)llround(cycles * clk.period_ps);
+        }
+        const StimEvent e = ev;
+        k.at(offset + e.t, [&, e] {
+            if (e.tckc && !dut->tckc_i) {
+                ++st.tckc_rises;
+                // Bridge drives TMSC in the TDO slot; the capture holds what
+                // the real target drove at the same TCKC rise
+                if (check_tdo && dut->tmsc_oen == 0) {
+                    ++st.tdo_checked;
+                    if ((dut->tmsc_o & 1u) != e.tmsc) {
+                        if (st.tdo_mismatch < 10) {
+                            printf("TDO mismatch at %llu ps: bridge %u, capture %u\n",
+                                   (unsigned long long)k.now(), dut->tmsc_o & 1u, e.tmsc);
+                        }
+                        ++st.tdo_mismatch;
+                    }
+                }
+            }
+            dut->tckc_i = e.tckc;
+            dut->tmsc_i = e.tmsc;
+            last_end    = k.now();
+            schedule_next();
+        });
+    };
+
+    if (!rd.open(path)) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    const double w0 = wall_s();
+    schedule_next();
+    const sim_ps_t chunk = (sim_ps_t)(1000 * clk.period_ps);
+    while (!done) k.run_until(k.now() + chunk);
+    k.run_until(last_end + (sim_ps_t)(20 * clk.period_ps));
+    const double wall = wall_s() - w0;
+    if (last_online) st.online_ps += k.now() - online_since;
+
+    const double sim_s = (double)(k.now() - t0) / 1e12;
+    printf("Simulated:     %.6f s of wire traffic in %.3f s wall (%.2fx real time)\n", sim_s, wall,
+           wall > 0.0 ? sim_s / wall : 0.0);
+    printf("Kernel:        %llu evals, %llu events\n", (unsigned long long)k.evals(),
+           (unsigned long long)k.events());
+    printf("TCKC cycles:   %llu\n", (unsigned long long)st.tckc_rises);
+    printf("Bridge:        %llu activations, %llu deselections, online %.1f%% of the time\n",
+           (unsigned long long)st.activations, (unsigned long long)st.deselections,
+           sim_s > 0.0 ? 100.0 * ((double)st.online_ps / 1e12) / sim_s : 0.0);
+    printf("TAP mix (states entered):\n");
+    for (int s = 0; s < 16; ++s) {
+        if (st.tap_entered[s]) printf("  %-18s %12llu\n", tap_state_name((uint8_t)s), (unsigned long long)st.tap_entered[s]);
+    }
+    if (check_tdo) {
+        printf("TDO check:     %llu bits compared, %llu mismatches\n", (unsigned long long)st.tdo_checked,
+               (unsigned long long)st.tdo_mismatch);
+    }
+
+    int status = 0;
+    if (bad_stim) {
+        printf("❌ Malformed stimulus\n");
+        status = 1;
+    } else if (st.tckc_rises > 0 && st.activations == 0) {
+        printf("❌ Bridge never went online (activation rejected?)\n");
+        status = 1;
+    } else if (st.tdo_mismatch > 0) {
+        printf("❌ TDO differs from the capture\n");
+        status = 1;
+    } else {
+        printf("✅ Replay complete\n");
+    }
+    if (status != 0) cjtag_log_dump_tail(stdout);
+
+    g_kernel = nullptr;
+    if (tfp) {
+        tfp->close();
+        delete tfp;
+    }
+    dut->final();
+    delete dut;
+    return status;
+}
@@ -0,0 +1,240 @@
+// =============================================================================
+// Coroutine Test Sequences on the Event Kernel
+// =============================================================================
+// The tick harnesses run one straight-line sequence: every wait is a fixed
+// number of clk_i ticks or a busy wait_until() poll, so a second agent on
+// the wires, or a reset arriving in the middle of a scan, cannot be written
+// as its own piece of code.
+//
+// Here each actor is a C++20 coroutine (CoTask) that suspends on simulation
+// events, and any number of them run concurrently on one SimKernel:
+//
+//   co_await sim.delay(ps);              // resume ps later
+//   co_await sim.cycles(n);              // after n rising edges of clk_i
+//   co_await sim.until(pred);            // first eval after which pred() holds
+//   bool ok = co_await sim.until(pred, timeout_ps);
+//   co_await sub_sequence(...);          // nested CoTask, runs to completion
+//
+// spawn() starts a top-level coroutine.  Coroutines interleave only at
+// co_await points and are resumed as kernel actions, so wire changes made
+// after a resumption are applied together with every other action at that
+// timestamp and seen by the next eval().  Condition awaiters are checked by
+// poll(), which the harness calls from the kernel's dump hook after each
+// eval; the model is only evaluated at times some event asked for.
+//
+// Requires -std=c++20; the rest of tb/ stays C++14.
+// =============================================================================
+
+#ifndef SIM_CORO_H
+#define SIM_CORO_H
+
+#include "sim_kernel.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ─── Coroutine task ──────────────────────────────────────────────────────────
+// Lazily started; co_await runs it as a sub-sequence of the caller, spawn()
+// runs it as an independent top-level sequence.  The frame is destroyed with
+// the CoTask object, never on completion, so a finished sequence's locals
+// stay valid for whoever still points at them.
+class CoTask {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation;
+
+        CoTask get_return_object() {
+            return CoTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Hand control straight back to the awaiting coroutine, if any
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                std::coroutine_handle<> c = h.promise().continuation;
+                return c ? c : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    CoTask() = default;
+    explicit CoTask(Handle h) : h_(h) {}
+    CoTask(CoTask&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    CoTask& operator=(CoTask&& o) noexcept {
+        if (this != &o) {
+            destroy();
+            h_ = std::exchange(o.h_, {});
+        }
+        return *this;
+    }
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+    ~CoTask() { destroy(); }
+
+    bool done() const { return !h_ || h_.done(); }
+    Handle handle() const { return h_; }
+
+    // co_await task: start it now, resume the caller when it returns
+    bool await_ready() const noexcept { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        h_.promise().continuation = caller;
+        return h_;
+    }
+    void await_resume() const noexcept {}
+
+private:
+    void destroy() {
+        if (h_) h_.destroy();
+        h_ = {};
+    }
+
+    Handle h_;
+};
+
+// ─── Scheduler ───────────────────────────────────────────────────────────────
+// Owns the spawned coroutines.  It must outlive every kernel run that can
+// fire their resumptions: events it scheduled stay queued after run() returns,
+// so running the kernel again once it is destroyed resumes freed frames.
+class CoSim {
+public:
+    explicit CoSim(SimKernel& k) : k_(k) {}
+    CoSim(const CoSim&) = delete;
+    CoSim& operator=(const CoSim&) = delete;
+
+    SimKernel& kernel() { return k_; }
+    sim_ps_t now() const { return k_.now(); }
+    uint64_t posedges() const { return posedges_; }
+
+    // Start a coroutine at the current time.  Background tasks (pulsers,
+    // monitors) may loop forever; run() only waits for the others.
+    void spawn(CoTask t, bool background = false) {
+        const CoTask::Handle h = t.handle();
+        tasks_.push_back(Spawned{std::move(t), background});
+        wake(h);
+    }
+
+    // Run the kernel until every foreground task has returned, a task called
+    // fail(), or simulated time reaches limit.  True if all returned cleanly.
+    bool run(sim_ps_t limit) {
+        k_.run_while_not([this] { return failed_ || foreground_done(); }, limit);
+        return !failed_ && foreground_done();
+    }
+
+    // Record a test failure (first one wins) and stop run(); the caller
+    // should co_return.
+    void fail(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        if (failed_) return;
+        char buf[512];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buf, sizeof buf, fmt, ap);
+        va_end(ap);
+        failure_ = buf;
+        failed_  = true;
+    }
+    bool failed() const { return failed_; }
+    const std::string& failure() const { return failure_; }
+
+    // Harness hooks: feed clk_i edges from the add_clock() drive callback,
+    // and call poll() after every eval (kernel dump hook).
+    void on_clock(bool level) {
+        if (level) ++posedges_;
+    }
+    void poll() {
+        for (size_t i = 0; i < waiters_.size();) {
+            Until* u = waiters_[i].u;
+            const bool hit = u->pred();
+            if (hit || (u->deadline != 0 && k_.now() >= u->deadline)) {
+                const std::coroutine_handle<> h = waiters_[i].h;
+                u->ok = hit;
+                waiters_.erase(waiters_.begin() + (long)i);  // keep FIFO order
+                wake(h);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // ─── Awaiters ────────────────────────────────────────────────────────────
+    struct Delay {
+        CoSim*   sim;
+        sim_ps_t dt;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { sim->k_.after(dt, [h] { h.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    // pred() reads model state as of the last eval.  Resumes with true once
+    // it holds, or with false at the deadline (0 = wait forever).
+    struct Until {
+        CoSim*                sim;
+        std::function<bool()> pred;
+        sim_ps_t              deadline;
+        bool                  ok;
+        bool await_ready() {
+            ok = pred();
+            return ok;
+        }
+        void await_suspend(std::coroutine_handle<> h) {
+            sim->waiters_.push_back(Waiter{this, h});
+            // Guarantee an eval (and so a poll) at the deadline
+            if (deadline != 0) sim->k_.at(deadline, [] {});
+        }
+        bool await_resume() const noexcept { return ok; }
+    };
+
+    Delay delay(sim_ps_t dt) { return Delay{this, dt}; }
+
+    Until until(std::function<bool()> pred, sim_ps_t timeout = 0) {
+        return Until{this, std::move(pred), timeout ? k_.now() + timeout : 0, false};
+    }
+
+    Until cycles(uint64_t n) {
+        const uint64_t target = posedges_ + n;
+        return until([this, target] { return posedges_ >= target; });
+    }
+
+private:
+    struct Spawned {
+        CoTask task;
+        bool   background;
+    };
+    struct Waiter {
+        Until*                  u;
+        std::coroutine_handle<> h;
+    };
+
+    void wake(std::coroutine_handle<> h) {
+        k_.at(k_.now(), [h] { h.resume(); });
+    }
+
+    bool foreground_done() const {
+        for (const Spawned& s : tasks_) {
+            if (!s.background && !s.task.done()) return false;
+        }
+        return true;
+    }
+
+    SimKernel&           k_;
+    std::vector<Spawned> tasks_;
+    std::vector<Waiter>  waiters_;
+    uint64_t             posedges_ = 0;
+    bool                 failed_   = false;
+    std::string          failure_;
+};
+
+#endif // SIM_CORO_H
@@ -0,0 +1,402 @@
+// =============================================================================
+// Discrete-Event Stimulus Kernel for the cJTAG Harnesses
+// =============================================================================
+// The tick-based harnesses express every delay as a whole number of clk_i
+// half-periods (10 per TCKC phase in tckc_cycle(), 30 clocks per edge in
+// tb_vpi.cpp), so probe/system clock ratios are always integers and both
+// clocks are perfectly phase-locked.
+//
+// SimKernel instead keeps a picosecond event queue.  clk_i and any number of
+// other timelines (a TCKC/TMSC probe, a replayed capture, ...) schedule
+// actions at absolute times; the kernel applies every action due at a given
+// timestamp, then calls eval() exactly once and dumps the trace.  Nothing is
+// evaluated between events.
+//
+// Clocks (ClockSpec) may have fractional periods, a static frequency error
+// in ppm and per-edge Gaussian jitter around the ideal edge grid.
+//
+// Oscan1Timeline turns OScan1 operations (escape, activation, 3-slot
+// packets, vendor frames) into a list of StimEvent wire changes on such a
+// clock; the same StimEvent list is what .stim files hold (stim_read /
+// stim_write), so synthetic, recorded and imported traffic all replay
+// through one path:
+//
+//   # cjtag-stim v1
+//   # <time_ps> <tckc> <tmsc> [S]        S = sample tmsc_o before applying
+//   1000000 0 1
+//   1050000 1 1 S
+// =============================================================================
+
+#ifndef SIM_KERNEL_H
+#define SIM_KERNEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+typedef uint64_t sim_ps_t;
+
+// ─── Clock description ───────────────────────────────────────────────────────
+struct ClockSpec {
+    double period_ps;        // nominal period; fractional values are fine
+    double duty;             // fraction of the period spent high
+    double ppm;              // static frequency error (+100 = 100 ppm slow)
+    double jitter_ps;        // RMS per-edge jitter around the ideal grid
+    double phase_ps;         // time of the first rising edge
+
+    static ClockSpec from_mhz(double mhz, double jitter_ps = 0.0, double ppm = 0.0) {
+        ClockSpec c;
+        c.period_ps = 1e6 / mhz;
+        c.duty      = 0.5;
+        c.ppm       = ppm;
+        c.jitter_ps = jitter_ps;
+        c.phase_ps  = 0.0;
+        return c;
+    }
+
+    double effective_period_ps() const { return period_ps * (1.0 + ppm * 1e-6); }
+};
+
+// Walks the edges of a ClockSpec.  Jitter displaces each edge independently
+// from the ideal grid (it does not accumulate); edges stay strictly ordered.
+class EdgeGenerator {
+public:
+    EdgeGenerator(const ClockSpec& spec, std::mt19937_64& rng, double start_ps = 0.0)
+        : spec_(spec), rng_(rng), ideal_(start_ps + spec.phase_ps), last_(0), high_next_(true) {}
+
+    // Time of the next edge; level() tells which edge it was.
+    sim_ps_t next() {
+        double t = ideal_;
+        if (spec_.jitter_ps > 0.0) {
+            std::normal_distribution<double> n(0.0, spec_.jitter_ps);
+            t += n(rng_);
+        }
+        sim_ps_t ps = t <= 0.0 ? 0 : (sim_ps_t)llround(t);
+        if (ps <= last_ && last_ != 0) ps = last_ + 1;
+        last_  = ps;
+        level_ = high_next_;
+        const double p = spec_.effective_period_ps();
+        ideal_ += high_next_ ? p * spec_.duty : p * (1.0 - spec_.duty);
+        high_next_ = !high_next_;
+        return ps;
+    }
+
+    bool level() const { return level_; }
+
+private:
+    ClockSpec        spec_;
+    std::mt19937_64& rng_;
+    double           ideal_;
+    sim_ps_t         last_;
+    bool             high_next_;
+    bool             level_ = false;
+};
+
+// ─── Event kernel ────────────────────────────────────────────────────────────
+class SimKernel {
+public:
+    typedef std::function<void()> Action;
+
+    // eval: called once per distinct event time after all due actions ran.
+    // dump: optional trace hook, called with the current time after eval.
+    explicit SimKernel(std::function<void()> eval, uint64_t seed = 1)
+        : eval_(eval), rng_(seed) {}
+
+    sim_ps_t now() const { return now_; }
+    const sim_ps_t* clock() const { return &now_; }  // for cjtag_log_set_clock()
+    uint64_t evals() const { return evals_; }
+    uint64_t events() const { return events_; }
+    std::mt19937_64& rng() { return rng_; }
+
+    void set_dump(std::function<void(sim_ps_t)> dump) { dump_ = dump; }
+
+    void at(sim_ps_t t, Action a) { queue_.push(Event{t < now_ ? now_ : t, seq_++, a}); }
+    void after(sim_ps_t dt, Action a) { at(now_ + dt, a); }
+
+    // Free-running clock: drive(level) on every edge until stop_clock(id).
+    int add_clock(const ClockSpec& spec, std::function<void(bool)> drive) {
+        clocks_.push_back(Clock{EdgeGenerator(spec, rng_, (double)now_), drive, true});
+        const int id = (int)clocks_.size() - 1;
+        schedule_edge(id);
+        return id;
+    }
+    void stop_clock(int id) { clocks_[id].running = false; }
+
+    // Process every event up to and including time t; now() ends at t.
+    void run_until(sim_ps_t t) {
+        while (!queue_.empty() && queue_.top().t <= t) step();
+        if (t > now_) now_ = t;
+    }
+
+    // Process events until pred() holds after an eval, or until time limit.
+    template <typename Pred>
+    bool run_while_not(Pred pred, sim_ps_t limit) {
+        while (!pred()) {
+            if (queue_.empty() || queue_.top().t > limit) return false;
+            step();
+        }
+        return true;
+    }
+
+    bool idle() const { return queue_.empty(); }
+
+private:
+    struct Event {
+        sim_ps_t t;
+        uint64_t seq;  // FIFO order among events at the same time
+        Action   fn;
+        bool operator>(const Event& o) const { return t != o.t ? t > o.t : seq > o.seq; }
+    };
+    struct Clock {
+        EdgeGenerator             edges;
+        std::function<void(bool)> drive;
+        bool                      running;
+    };
+
+    void schedule_edge(int id) {
+        Clock& c = clocks_[id];
+        const sim_ps_t t = c.edges.next();
+        const bool level = c.edges.level();
+        at(t, [this, id, level] {
+            Clock& clk = clocks_[id];
+            if (!clk.running) return;
+            clk.drive(level);
+            schedule_edge(id);
+        });
+    }
+
+    // Run all actions due at the earliest pending time, then evaluate once.
+    void step() {
+        now_ = queue_.top().t;
+        while (!queue_.empty() && queue_.top().t == now_) {
+            Action fn = queue_.top().fn;
+            queue_.pop();
+            fn();
+            ++events_;
+        }
+        eval_();
+        ++evals_;
+        if (dump_) dump_(now_);
+    }
+
+    std::function<void()>                                          eval_;
+    std::function<void(sim_ps_t)>                                  dump_;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue_;
+    std::vector<Clock>                                             clocks_;
+    std::mt19937_64                                                rng_;
+    sim_ps_t                                                       now_    = 0;
+    uint64_t                                                       seq_    = 0;
+    uint64_t                                                       evals_  = 0;
+    uint64_t                                                       events_ = 0;
+};
+
+// ─── Wire-level stimulus ─────────────────────────────────────────────────────
+#define STIM_SAMPLE 0x01u  // read tmsc_o (value before this event is applied)
+
+struct StimEvent {
+    sim_ps_t t;
+    uint8_t  tckc;
+    uint8_t  tmsc;
+    uint8_t  flags;
+};
+
+// Streaming .stim writer/reader, so captures longer than memory can be
+// converted and replayed event by event.
+class StimWriter {
+public:
+    bool open(const char* path, const char* note = nullptr) {
+        fp_ = fopen(path, "w");
+        if (!fp_) return false;
+        fprintf(fp_, "# cjtag-stim v1\n");
+        if (note) fprintf(fp_, "# %s\n", note);
+        fprintf(fp_, "# <time_ps> <tckc> <tmsc> [S]\n");
+        return true;
+    }
+    void comment(const char* text) { fprintf(fp_, "# %s\n", text); }
+    void write(const StimEvent& e) {
+        fprintf(fp_, "%llu %u %u%s\n", (unsigned long long)e.t, e.tckc, e.tmsc, (e.flags & STIM_SAMPLE) ? " S" : "");
+    }
+    bool close() {
+        const bool ok = fp_ && fclose(fp_) == 0;
+        fp_ = nullptr;
+        return ok;
+    }
+    ~StimWriter() { if (fp_) fclose(fp_); }
+
+private:
+    FILE* fp_ = nullptr;
+};
+
+class StimReader {
+public:
+    bool open(const char* path) {  // (re)open; restarts at the first event
+        if (fp_) fclose(fp_);
+        path_   = path;
+        fp_     = fopen(path, "r");
+        lineno_ = 0;
+        last_   = 0;
+        count_  = 0;
+        error_  = false;
+        return fp_ != nullptr;
+    }
+    // false at end of file or on a malformed line (error() tells which)
+    bool next(StimEvent& e) {
+        char line[256];
+        while (fp_ && fgets(line, sizeof(line), fp_)) {
+            ++lineno_;
+            if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+            unsigned long long t;
+            unsigned tckc, tmsc;
+            char flag[4] = "";
+            const int n = sscanf(line, "%llu %u %u %3s", &t, &tckc, &tmsc, flag);
+            if (n < 3 || tckc > 1 || tmsc > 1 || (count_ != 0 && t < last_)) {
+                fprintf(stderr, "[STIM] %s:%d: malformed line\n", path_, lineno_);
+                error_ = true;
+                return false;
+            }
+            e = StimEvent{(sim_ps_t)t, (uint8_t)tckc, (uint8_t)tmsc, (uint8_t)(flag[0] == 'S' ? STIM_SAMPLE : 0)};
+            last_ = e.t;
+            ++count_;
+            return true;
+        }
+        return false;
+    }
+    bool error() const { return error_; }
+    uint64_t count() const { return count_; }
+    ~StimReader() { if (fp_) fclose(fp_); }
+
+private:
+    FILE*       fp_     = nullptr;
+    const char* path_   = "";
+    int         lineno_ = 0;
+    sim_ps_t    last_   = 0;
+    uint64_t    count_  = 0;
+    bool        error_  = false;
+};
+
+static inline bool stim_write(const char* path, const std::vector<StimEvent>& ev, const char* note = nullptr) {
+    StimWriter w;
+    if (!w.open(path, note)) return false;
+    for (const StimEvent& e : ev) w.write(e);
+    return w.close();
+}
+
+static inline bool stim_read(const char* path, std::vector<StimEvent>& ev) {
+    StimReader r;
+    if (!r.open(path)) return false;
+    StimEvent e;
+    while (r.next(e)) ev.push_back(e);
+    return !r.error();
+}
+
+// Schedule a StimEvent list on the kernel.  apply(tckc, tmsc) drives the
+// pins; sample() is called first for events flagged STIM_SAMPLE.
+template <typename Apply, typename Sample>
+static inline void stim_schedule(SimKernel& k, const std::vector<StimEvent>& ev, sim_ps_t offset, Apply apply,
+                                 Sample sample) {
+    for (const StimEvent& e : ev) {
+        const StimEvent c = e;
+        k.at(offset + e.t, [c, apply, sample] {
+            if (c.flags & STIM_SAMPLE) sample();
+            apply(c.tckc, c.tmsc);
+        });
+    }
+}
+
+// ─── OScan1 probe timeline ───────────────────────────────────────────────────
+// Builds the wire activity of a DTS (probe) whose TCKC runs from its own
+// ClockSpec.  TMSC is driven at each TCKC falling edge; in the TDO slot the
+// probe releases TMSC and samples it just before the rising edge.
+class Oscan1Timeline {
+public:
+    Oscan1Timeline(const ClockSpec& tckc, std::mt19937_64& rng, sim_ps_t start_ps)
+        : edges_(tckc, rng, (double)start_ps), half_ps_(tckc.effective_period_ps() / 2.0) {
+        // Consume the rising edge at start_ps: TCKC idles high, so the
+        // first thing we emit is a falling edge.
+        edges_.next();
+    }
+
+    const std::vector<StimEvent>& events() const { return ev_; }
+    sim_ps_t end_ps() const { return ev_.empty() ? 0 : ev_.back().t; }
+    unsigned samples() const { return samples_; }
+
+    // One TCKC cycle carrying tmsc (driven on the falling edge).
+    void cycle(int tmsc, bool sample = false) {
+        const sim_ps_t fall = edges_.next();
+        const sim_ps_t rise = edges_.next();
+        push(fall, 0, (uint8_t)tmsc, 0);
+        push(rise, 1, (uint8_t)tmsc, sample ? STIM_SAMPLE : 0);
+        if (sample) ++samples_;
+    }
+
+    // TCKC held high for one period while TMSC toggles `toggles` times
+    // (4-5 deselect, 6-7 select, 8+ reset), then a normal low phase.
+    void escape(int toggles) {
+        cycle(tmsc_);
+        hold_high(toggles);
+    }
+
+    // OAC + EC + CP, LSB first (OAC=1100, EC=1000 as the tick harnesses).
+    void activation(int oac = 0xC, int ec = 0x8) {
+        const int cp = oac ^ ec;
+        for (int i = 0; i < 4; ++i) cycle((oac >> i) & 1);
+        for (int i = 0; i < 4; ++i) cycle((ec >> i) & 1);
+        for (int i = 0; i < 4; ++i) cycle((cp >> i) & 1);
+    }
+
+    // 3-slot OScan1 packet; capture=true samples TDO in the third slot.
+    void packet(int tdi, int tms, bool capture) {
+        cycle(!tdi);
+        cycle(tms);
+        cycle(0, capture);
+    }
+
+    void idle_cycles(int n) {
+        for (int i = 0; i < n; ++i) cycle(tmsc_);
+    }
+
+    // Vendor frame (EC=0x9 links), right after a packet: 2 toggles while
+    // TCKC stays high, the opcode LSB first, then resp_bits cycles whose
+    // TMSC is sampled; padded to whole 3-bit packets like the bridge.
+    void vendor(int opcode, int resp_bits) {
+        hold_high(2);
+        const int frame = (8 + resp_bits + 2) / 3 * 3;
+        for (int i = 0; i < frame; ++i) {
+            cycle(i < 8 ? (opcode >> i) & 1 : 0, i >= 8 && i < 8 + resp_bits);
+        }
+    }
+
+private:
+    // Keep TCKC high for one more period after the last rising edge and
+    // toggle TMSC `toggles` times in it.
+    void hold_high(int toggles) {
+        const sim_ps_t hold_start = end_ps();
+        const double   spacing    = 2.0 * half_ps_ / (toggles + 1);
+        for (int i = 1; i <= toggles; ++i) {
+            push(hold_start + (sim_ps_t)llround(spacing * i), 1, (uint8_t)!tmsc_, 0);
+        }
+        // Skip the edges covered by the held-high window
+        edges_.next();
+        edges_.next();
+    }
+
+    void push(sim_ps_t t, uint8_t tckc, uint8_t tmsc, uint8_t flags) {
+        if (!ev_.empty() && t <= ev_.back().t) t = ev_.back().t + 1;
+        ev_.push_back(StimEvent{t, tckc, tmsc, flags});
+        tmsc_ = tmsc;
+    }
+
+    EdgeGenerator          edges_;
+    double                 half_ps_;
+    std::vector<StimEvent> ev_;
+    uint8_t                tmsc_    = 1;
+    unsigned               samples_ = 0;
+};
+
+#endif // SIM_KERNEL_H
@@ -0,0 +1,67 @@
+// =============================================================================
+// Single-Producer / Single-Consumer Ring Buffer
+// =============================================================================
+// Bounded lock-free queue between exactly two threads, used by tb_vpi.cpp to
+// hand decoded VPI commands from the socket I/O thread to the simulation
+// thread and responses back.  Slots are filled and consumed in place
+// (back()/push(), front()/pop()), so a 1 KiB vpi_cmd is copied once per hop.
+//
+// Each side caches the other side's index and only reloads it when the
+// queue looks full (producer) or empty (consumer), keeping the shared cache
+// lines quiet while traffic flows.
+// =============================================================================
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+    // ─── Producer side ───────────────────────────────────────────────────────
+    // Free slot to fill, or nullptr if the queue is full.
+    T* back() {
+        const size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ == N) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ == N) return nullptr;
+        }
+        return &buf_[t & (N - 1)];
+    }
+
+    // Publish the slot returned by back().
+    void push() { tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // ─── Consumer side ───────────────────────────────────────────────────────
+    // Oldest published slot, or nullptr if the queue is empty.
+    T* front() {
+        const size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return nullptr;
+        }
+        return &buf_[h & (N - 1)];
+    }
+
+    // Release the slot returned by front().
+    void pop() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Either side; exact only when the other side is idle.
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{ 0 };  // written by the consumer
+    size_t tail_cache_ = 0;                       // consumer's copy of tail_
+    alignas(64) std::atomic<size_t> tail_{ 0 };  // written by the producer
+    size_t head_cache_ = 0;                       // producer's copy of head_
+    alignas(64) T buf_[N];
+};
+
+#endif  // SPSC_QUEUE_H
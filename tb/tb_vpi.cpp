@@ -11,13 +11,97 @@
 //   3. Reads TMSC output
 //   4. Sends response
 //
+// With --jtag the server instead drives the TAP's TCK/TMS/TDI directly
+// (top.jtag_sel_i=1), bypassing cjtag_bridge.  CMD_TMS_SEQ and
+// CMD_SCAN_CHAIN[_FLIP_TMS] then behave as in stock jtag_vpi, so the same
+// OpenOCD script can run over plain JTAG and over OScan1 against an
+// identical TAP/DTM.  Per-command statistics are printed on exit.
+//
+// With --rtck each edge runs only until the bridge echoes it on rtck_o
+// (adaptive clocking), bounded above by --clks-per-vpi, instead of a fixed
+// clock count.  CMD_OSCAN1_RAW responses then carry the acknowledge in bit 1
+// of buffer_in[0] (bit 0 stays TMSC), so hosts that mask bit 0 are unaffected.
+//
+// With --realtime RATIO simulated time is locked to wall-clock time
+// (RATIO = simulated seconds per wall second, e.g. 1 or 0.01).  The server
+// sleeps when the simulation is ahead and, while OpenOCD is idle, advances
+// clk_i only as far as the wall clock allows, so host-side timeouts and
+// `after` delays see silicon-like timing without a core spinning.
+//
+// --record FILE saves every command (with the idle clocks that preceded it
+// and the response sent) so the session can later be re-run without OpenOCD
+// via --replay FILE.  Replay discards responses but counts any that differ
+// from the recording, which makes it a repeatable workload for `make profile`
+// and a quick regression check after RTL changes.
+//
+// --checkpoint-every M (with --record) also saves the model (Verilator
+// --savable) and the harness state into FILE.ckpt at the first command
+// boundary after every M clk_i cycles, with a cycle index.  --replay FILE
+// --seek CYCLE[+N] maps that archive, restores the last checkpoint at or
+// before CYCLE and replays only the commands after it; --trace dumps from
+// CYCLE on (for N cycles, then stops), so a failure hours into a session is
+// reached in seconds.
+//
+// --log SPEC (or CJTAG_LOG=SPEC) enables the runtime log categories from
+// cjtag_log.h; the "vpi" category traces every CMD_OSCAN1_RAW exchange.  The
+// log tail is dumped on SIGUSR1 and when the server is interrupted.
+//
+// With --io-thread a second thread owns the socket: it receives and decodes
+// commands into a lock-free queue (spsc_queue.h) consumed by the simulation
+// thread and sends responses from a second queue, so receiving command N+1
+// overlaps evaluating command N.  Either way the exit summary reports
+// per-command latency (queue wait, evaluation, receive-to-response
+// turnaround) and throughput, which is how the two modes are compared.
+//
+// CMD_OSCAN1_REPEAT runs nb_bits identical OScan1 packets (constant TDI/TMS,
+// e.g. RUNTEST idle cycles or all-zero DR reads) inside the server and
+// returns only the TDO bits, replacing six round trips per packet with one
+// per run.
+//
+// CMD_VENDOR clocks one bridge vendor command frame (available after an
+// EC=1001 activation, see cjtag_bridge.sv): the 2-toggle entry, the opcode,
+// optional operand bits and the response bits the bridge drives, e.g. the
+// link CRC read OpenOCD's `jtag_vpi link_crc` uses to verify what the bridge
+// received.  --tmsc-ber P flips each host-driven OScan1 data bit with
+// probability P while the bridge is online, modelling an overclocked link so
+// the CRC/retry path can be exercised end to end.
+//
+// --bitbang speaks OpenOCD's remote_bitbang ASCII protocol on the same port
+// instead, so a stock OpenOCD (no jtag_vpi patch) can drive the bridge: each
+// JTAG TCK pulse becomes one OScan1 packet, and the server selects and
+// activates the bridge itself.  Characters stream without replies except
+// 'R', so a scan costs a few socket segments rather than one 1036-byte
+// round trip per TCKC edge.  --bitbang-raw maps the characters straight onto
+// TCKC/TMSC for cJTAG-aware clients.
+//
+// --xvc serves Xilinx Virtual Cable 1.0 (getinfo:, settck:, shift:) over the
+// same packet path: each shift: vector of up to 2048 bytes of TMS/TDI is
+// clocked as OScan1 packets and answered with its TDO vector in one reply.
+// settck: sets the simulated TCKC period.
+//
+// --instances N serves N independent models from one process: instance i
+// has its own context, model and session on its own thread and listens on
+// --port + i, so parallel OpenOCD jobs share one binary, one startup and
+// one log ring (events tagged with the instance).  Per-session state is
+// thread_local; options are shared.  Not combinable with --record/--replay.
+//
 // This differs from tb_cjtag.cpp which uses free-running clocks.
 // =============================================================================
 
 #include <verilated.h>
 #include <verilated_fst_c.h>
+#include <verilated_save.h>
 #include "Vtop.h"
+#include "cjtag_log.h"
+#include "spsc_queue.h"
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -28,7 +112,12 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/select.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <time.h>
 
 // ─── VPI protocol constants ──────────────────────────────────────────────────
 #define CMD_RESET               0u
@@ -37,6 +126,8 @@
 #define CMD_SCAN_CHAIN_FLIP_TMS 3u
 #define CMD_STOP_SIMU           4u
 #define CMD_OSCAN1_RAW          5u
+#define CMD_OSCAN1_REPEAT       6u
+#define CMD_VENDOR              7u
 #define XFERT_MAX_SIZE          512
 
 struct vpi_cmd {
@@ -49,28 +140,113 @@ struct vpi_cmd {
 static_assert(sizeof(vpi_cmd) == 1036, "vpi_cmd size mismatch");
 
 // ─── Simulation globals ──────────────────────────────────────────────────────
-static Vtop*          g_dut      = nullptr;
-static VerilatedFstC* g_tfp      = nullptr;
-static uint64_t       g_sim_time = 0;
-static uint64_t       g_cycle    = 0;
-static volatile bool  g_abort    = false;
+// Model and session state is per thread: with --instances each model runs on
+// its own thread with its own copy.  Options and the abort flag are shared.
+static thread_local Vtop*          g_dut      = nullptr;
+static thread_local VerilatedFstC* g_tfp      = nullptr;
+static thread_local uint64_t       g_sim_time = 0;
+static thread_local uint64_t       g_cycle    = 0;
+static thread_local int            g_instance = -1;  // --instances: model index (-1: single model)
+static std::atomic<bool>           g_abort{ false };  // SIGINT/SIGTERM; read by every thread
+
+static bool aborted() { return g_abort.load(std::memory_order_relaxed); }
 
 static const uint64_t CLK_HALF_PS = 5000ULL; // 10 ns period = 5 ns half
 
 // ─── Run-time parameters ─────────────────────────────────────────────────────
 static int      g_vpi_port       = 5555;
 static uint64_t g_max_cycles     = 50000000ULL;
-static int      g_clks_per_vpi   = 30;  // Match test_idcode.cpp timing (20 low + 10 high)
+static int      g_clks_per_vpi_opt = 30;  // --clks-per-vpi (match test_idcode.cpp: 20 low + 10 high)
 static int      g_idle_clks      = 1000;
 static int      g_boot_clks      = 100;
 static bool     g_trace_enabled  = false;
+static bool     g_jtag_mode      = false;  // --jtag: direct 4-wire path, no bridge
+static double   g_rt_ratio       = 0.0;    // --realtime: sim s per wall s (0 = free-running)
+static bool     g_rtck_mode      = false;  // --rtck: pace edges on rtck_o (adaptive clocking)
+static const char* g_record_path = nullptr; // --record: save session for --replay
+static const char* g_replay_path = nullptr; // --replay: run a saved session, no socket
+static bool     g_io_thread      = false;  // --io-thread: socket I/O on its own thread
+static double   g_tmsc_ber       = 0.0;    // --tmsc-ber: host->bridge bit error rate while online
+static uint64_t g_ckpt_every     = 0;      // --checkpoint-every: clk_i cycles between checkpoints
+static uint64_t g_seek_cycle     = 0;      // --seek: replay target (restore nearest checkpoint)
+static uint64_t g_seek_span      = 0;      // --seek CYCLE+N: stop N cycles after the target
+static uint64_t g_trace_from     = 0;      // first g_cycle dumped to the FST trace
+
+enum bitbang_mode { BITBANG_OFF, BITBANG_JTAG, BITBANG_RAW };
+static int      g_bitbang        = BITBANG_OFF;  // --bitbang / --bitbang-raw: remote_bitbang frontend
+static bool     g_xvc            = false;  // --xvc: Xilinx Virtual Cable frontend
+static int      g_instances      = 1;      // --instances: models served, one port each
+
+static thread_local int g_clks_per_vpi = 30;  // current edge length (XVC settck: changes it)
+
+// ─── Statistics (for cJTAG vs JTAG A/B runs) ─────────────────────────────────
+#define CMD_STATS_SLOTS 16u
+#define STAT_XVC_SHIFT  13u  // XVC shift: commands (not a jtag_vpi command)
+#define STAT_BITBANG    14u  // remote_bitbang receive batches (not a jtag_vpi command)
+
+struct cmd_stats {
+    uint64_t count;
+    uint64_t cycles;  // clk_i cycles spent executing this command type
+    uint64_t bits;    // JTAG bits (TMS or TDI) carried by this command type
+};
+static thread_local cmd_stats g_stats[CMD_STATS_SLOTS];
+
+static const char *cmd_name(uint32_t cmd) {
+    switch (cmd) {
+    case CMD_RESET:               return "RESET";
+    case CMD_TMS_SEQ:             return "TMS_SEQ";
+    case CMD_SCAN_CHAIN:          return "SCAN_CHAIN";
+    case CMD_SCAN_CHAIN_FLIP_TMS: return "SCAN_CHAIN_FLIP_TMS";
+    case CMD_STOP_SIMU:           return "STOP_SIMU";
+    case CMD_OSCAN1_RAW:          return "OSCAN1_RAW";
+    case CMD_OSCAN1_REPEAT:       return "OSCAN1_REPEAT";
+    case CMD_VENDOR:              return "VENDOR";
+    case STAT_XVC_SHIFT:          return "XVC_SHIFT";
+    case STAT_BITBANG:            return "BITBANG";
+    default:                      return "UNKNOWN";
+    }
+}
+
+static_assert(ATOMIC_BOOL_LOCK_FREE == 2, "g_abort is stored from a signal handler");
+static void sig_handler(int) { g_abort.store(true, std::memory_order_relaxed); }
 
-static void sig_handler(int) { g_abort = true; }
+static std::atomic<bool> g_log_dump_req{ false };
+static void sig_log_dump(int) { g_log_dump_req.store(true, std::memory_order_relaxed); }
+
+// ─── Messages ────────────────────────────────────────────────────────────────
+// One stderr line, prefixed "[VPI]" or, with --instances, "[VPI#n]" so the
+// models' output can be told apart.  Formatted first and written in one call
+// so lines from concurrent instances do not interleave.
+static void vpi_msg(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void vpi_msg(const char *fmt, ...) {
+    char line[512];
+    int  n = g_instance < 0 ? snprintf(line, sizeof(line), "[VPI] ")
+                            : snprintf(line, sizeof(line), "[VPI#%d] ", g_instance);
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(line + n, sizeof(line) - (size_t)n, fmt, ap);
+    va_end(ap);
+    fputs(line, stderr);
+}
+
+// ─── Log message ids (category "vpi") ────────────────────────────────────────
+#define LOGID_VPI_OSCAN1 CJTAG_LOG_ID(LOG_CAT_VPI, 0x00)
+#define LOGID_VPI_CMD    CJTAG_LOG_ID(LOG_CAT_VPI, 0x01)
+#define LOGID_VPI_BB     CJTAG_LOG_ID(LOG_CAT_VPI, 0x02)
+#define LOGID_VPI_XVC    CJTAG_LOG_ID(LOG_CAT_VPI, 0x03)
+
+static void vpi_log_register() {
+    cjtag_log_register_fmt(LOGID_VPI_OSCAN1, LOG_CAT_VPI,
+                           "VPI: TCKC=%u TMSC_in=%u | oe/out/TMSC/resp=%x | TCK/TMS/TDI/TDOc/TDOr/online=%02x");
+    cjtag_log_register_fmt(LOGID_VPI_CMD, LOG_CAT_VPI, "VPI: cmd %u, length %u, nb_bits %u");
+    cjtag_log_register_fmt(LOGID_VPI_BB, LOG_CAT_VPI, "VPI: bitbang batch, %u chars, %u reads, %u packets");
+    cjtag_log_register_fmt(LOGID_VPI_XVC, LOG_CAT_VPI, "VPI: XVC %u (0 getinfo, 1 shift), %u bits");
+}
 
 // ─── Clock helpers ───────────────────────────────────────────────────────────
 static inline void tick_half() {
     g_dut->eval();
-    if (g_tfp) g_tfp->dump(g_sim_time);
+    if (g_tfp && g_cycle >= g_trace_from) g_tfp->dump(g_sim_time);
     g_sim_time += CLK_HALF_PS;
 }
 
@@ -84,6 +260,235 @@ static void run_clocks(int n) {
     for (int i = 0; i < n; ++i) tick();
 }
 
+// ─── Adaptive clocking (--rtck) ──────────────────────────────────────────────
+// TMSC-only changes (escape toggles) are not acknowledged on rtck_o, so every
+// edge still gets the synchronizer + edge-detect + count latency.
+#define RTCK_MIN_CLKS 4
+static thread_local uint64_t g_rtck_timeouts = 0;
+
+// Let the DUT absorb one pin change.  Fixed mode runs g_clks_per_vpi clocks;
+// --rtck runs until rtck_o == level (at most g_clks_per_vpi).  Returns false
+// if the edge was not acknowledged in time.
+static bool settle_edge(uint8_t level) {
+    if (!g_rtck_mode) {
+        run_clocks(g_clks_per_vpi);
+        return (g_dut->rtck_o & 1u) == level;
+    }
+    run_clocks(RTCK_MIN_CLKS);
+    for (int n = RTCK_MIN_CLKS; (g_dut->rtck_o & 1u) != level && n < g_clks_per_vpi; ++n) {
+        tick();
+    }
+    if ((g_dut->rtck_o & 1u) != level) {
+        ++g_rtck_timeouts;
+        return false;
+    }
+    return true;
+}
+
+// ─── Direct 4-wire JTAG helpers ──────────────────────────────────────────────
+// One TCK period = 2 x g_clks_per_vpi system clocks, i.e. the same edge
+// spacing as one CMD_OSCAN1_RAW edge, so cycle counts compare like for like.
+// TDO is sampled from the negedge-registered tdo_o while TCK is still low,
+// before the rising edge shifts the register (IEEE 1149.1 §11.4).
+static uint8_t jtag_clock_bit(uint8_t tms, uint8_t tdi) {
+    g_dut->jtag_tck_i = 0;
+    g_dut->jtag_tms_i = tms & 1u;
+    g_dut->jtag_tdi_i = tdi & 1u;
+    settle_edge(0);
+    uint8_t tdo = g_dut->tdo_o & 1u;
+    g_dut->jtag_tck_i = 1;
+    settle_edge(1);
+    g_dut->jtag_tck_i = 0;  // falling edge is evaluated by the next tick
+    return tdo;
+}
+
+// ─── Link bit errors (--tmsc-ber) ────────────────────────────────────────────
+// The decision is made when TCKC falls (where the host changes data) and
+// held through the following rise, so a corrupted bit is consistently wrong
+// and escape toggle counts are preserved.  Selection and activation run
+// clean: only traffic while online_o is high is affected.
+static thread_local uint64_t g_ber_rng   = 0x9E3779B97F4A7C15ULL;
+static thread_local uint64_t g_ber_flips = 0;
+static thread_local bool     g_ber_flip  = false;  // decision held from TCKC fall to rise
+
+static uint8_t ber_corrupt(uint8_t tckc, uint8_t tmsc) {
+    if (g_tmsc_ber <= 0.0 || !(g_dut->online_o & 1u)) {
+        g_ber_flip = false;
+        return tmsc;
+    }
+    if (tckc == 0) {
+        g_ber_rng ^= g_ber_rng << 13;
+        g_ber_rng ^= g_ber_rng >> 7;
+        g_ber_rng ^= g_ber_rng << 17;
+        g_ber_flip = (double)(g_ber_rng >> 11) * (1.0 / 9007199254740992.0) < g_tmsc_ber;
+        if (g_ber_flip) ++g_ber_flips;
+    }
+    return g_ber_flip ? (uint8_t)(tmsc ^ 1u) : tmsc;
+}
+
+// ─── OScan1 edge (cJTAG mode) ────────────────────────────────────────────────
+// Drive one TCKC/TMSC pair, let the bridge settle and return what the host
+// sees on TMSC.  *acked reports the RTCK acknowledge, *tdo_window whether the
+// bridge was driving TMSC (the TDO slot of a packet).
+//
+// 1-bit delay buffer to fix TDO sampling offset
+// The TAP shifts by the time we sample (after 30 clocks), so we see bit N+1
+// instead of bit N. Solution: Buffer each bit and return the previous one.
+static thread_local uint8_t g_tdo_delay_buffer = 0;
+static thread_local bool    g_first_command    = true;
+
+static uint8_t oscan1_edge(uint8_t tckc, uint8_t tmsc, bool *acked, bool *tdo_window) {
+    g_dut->tckc_i = tckc;
+    g_dut->tmsc_i = ber_corrupt(tckc, tmsc);
+
+    // Run clocks to let bridge process (until RTCK ack with --rtck)
+    *acked = settle_edge(tckc);
+
+    // Read TMSC output when bridge is driving (tmsc_oen active-low = 0)
+    uint8_t oe  = g_dut->tmsc_oen & 1u;
+    uint8_t out = g_dut->tmsc_o & 1u;
+    uint8_t tmsc_current = (oe == 0u) ? out : 0u;
+
+    // Return the PREVIOUS bit (from buffer), except on first command
+    // BUG FIX: Only apply delay to TDO reads (when oe=0), not to TDI/TMS bits
+    uint8_t tmsc_response;
+    *tdo_window = (oe == 0);
+    if (oe == 0) {  // TDO window is open
+        tmsc_response = g_first_command ? tmsc_current : g_tdo_delay_buffer;
+        g_tdo_delay_buffer = tmsc_current;
+        g_first_command = false;
+    } else {
+        // Not a TDO read, just pass through
+        tmsc_response = tmsc_current;
+    }
+
+    // Read internal JTAG signals for debugging
+    uint8_t tck  = g_dut->tck_o & 1u;
+    uint8_t tms  = g_dut->tms_o & 1u;
+    uint8_t tdi  = g_dut->tdi_o & 1u;
+    uint8_t tdo_comb = g_dut->tdo_comb_o & 1u;  // Combinatorial TDO (what bridge uses)
+    uint8_t tdo_reg  = g_dut->tdo_o & 1u;       // Negedge-registered (valid when TCK=0)
+    uint8_t online = g_dut->online_o & 1u;
+
+    CJTAG_LOG(LOG_CAT_VPI, LOG_TRACE, LOGID_VPI_OSCAN1, tckc, tmsc,
+              (oe << 12) | (out << 8) | (tmsc_current << 4) | tmsc_response,
+              (tck << 5) | (tms << 4) | (tdi << 3) | (tdo_comb << 2) | (tdo_reg << 1) | online);
+    return tmsc_response;
+}
+
+// ─── Vendor command frames (cJTAG mode, EC=1001) ─────────────────────────────
+// Frame bits bypass the TDO delay buffer (the bridge drives its response
+// from registers, not from the TAP) and the link error model, so a CRC read
+// itself is never corrupted.  Returns TMSC while the bridge drives it.
+static uint8_t vendor_edge(uint8_t tckc, uint8_t tmsc, uint32_t *nacks) {
+    g_dut->tckc_i = tckc;
+    g_dut->tmsc_i = tmsc;
+    if (!settle_edge(tckc)) ++*nacks;
+    return ((g_dut->tmsc_oen & 1u) == 0u) ? (g_dut->tmsc_o & 1u) : 0u;
+}
+
+// A command with operands may run in the bridge after its last operand bit
+// (VCMD_POLL clocks the TAP); rtck_o stays low until it is done, so that
+// edge waits for the acknowledge in both pacing modes.  Bounded by a full
+// 255-scan poll with 255 idle TCKs between scans.
+#define VENDOR_BUSY_MAX_CLKS (1 << 18)
+
+static bool settle_busy() {
+    run_clocks(RTCK_MIN_CLKS);
+    for (int n = RTCK_MIN_CLKS; !(g_dut->rtck_o & 1u) && n < VENDOR_BUSY_MAX_CLKS; ++n) {
+        tick();
+    }
+    return (g_dut->rtck_o & 1u) != 0;
+}
+
+// One frame from a packet boundary (TCKC high, TMSC low): 2 TMSC toggles,
+// then 8 opcode bits, n_in operand bits, n_out response bits, padded to a
+// whole number of packets.  Returns the number of unacknowledged edges.
+static uint32_t vendor_frame(uint8_t opcode, const uint8_t *in, uint32_t n_in, uint8_t *out, uint32_t n_out) {
+    uint32_t nacks = 0;
+    vendor_edge(1, 1, &nacks);
+    vendor_edge(1, 0, &nacks);
+    const uint32_t n_bits = 8u + n_in + n_out;
+    const uint32_t frame  = (n_bits + 2u) / 3u * 3u;
+    for (uint32_t i = 0; i < frame; ++i) {
+        uint8_t v = 0;
+        if (i < 8u) {
+            v = (opcode >> i) & 1u;
+        } else if (i < 8u + n_in) {
+            v = (in[(i - 8u) / 8] >> ((i - 8u) % 8)) & 1u;
+        }
+        const uint8_t r = vendor_edge(0, v, &nacks);
+        if (i >= 8u + n_in && i < n_bits) {
+            const uint32_t k = i - 8u - n_in;
+            out[k / 8] |= static_cast<uint8_t>(r << (k % 8));
+        }
+        if (n_in > 0u && i == 7u + n_in) {
+            g_dut->tckc_i = 1;
+            g_dut->tmsc_i = v;
+            if (!settle_busy()) ++nacks;
+        } else {
+            vendor_edge(1, v, &nacks);
+        }
+    }
+    // Leave TMSC low, as after a packet
+    vendor_edge(1, 0, &nacks);
+    return nacks;
+}
+
+// ─── Wall-clock pacing (--realtime) ──────────────────────────────────────────
+// The simulation may run at most RT_SLACK_NS ahead of the wall clock before
+// it sleeps.  If it falls more than RT_MAX_DEBT_NS behind (the model cannot
+// sustain the requested ratio) the debt is dropped and counted as a slip,
+// so an overloaded host degrades to free-running instead of bursting.
+static const int64_t RT_SLACK_NS     = 1000000LL;    // 1 ms
+static const int64_t RT_MAX_DEBT_NS  = 100000000LL;  // 100 ms
+static thread_local uint64_t g_rt_wall0_ns = 0;
+static thread_local uint64_t g_rt_sim0_ps  = 0;
+static thread_local uint64_t g_rt_slept_ns = 0;
+static thread_local uint64_t g_rt_slips    = 0;
+
+static uint64_t wall_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void rt_start() {
+    g_rt_wall0_ns = wall_ns();
+    g_rt_sim0_ps  = g_sim_time;
+}
+
+// Lead of simulated time over the wall-clock budget, in wall nanoseconds
+// (negative when the simulation is behind).
+static int64_t rt_lead_ns() {
+    const double sim_ns  = (double)(g_sim_time - g_rt_sim0_ps) / 1000.0;
+    const double wall_el = (double)(wall_ns() - g_rt_wall0_ns);
+    return (int64_t)(sim_ns / g_rt_ratio - wall_el);
+}
+
+// Block until the wall clock has caught up with simulated time.
+static void rt_throttle() {
+    const int64_t lead = rt_lead_ns();
+    if (lead <= RT_SLACK_NS) return;
+    struct timespec ts = { (time_t)(lead / 1000000000LL), (long)(lead % 1000000000LL) };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR && !aborted()) {}
+    g_rt_slept_ns += (uint64_t)lead;
+}
+
+// Idle: advance clk_i up to the current wall-clock budget.
+static void rt_catch_up() {
+    int64_t lead = rt_lead_ns();
+    if (lead >= 0) return;
+    if (-lead > RT_MAX_DEBT_NS) {
+        g_rt_wall0_ns += (uint64_t)(-lead - RT_SLACK_NS);
+        lead = -RT_SLACK_NS;
+        ++g_rt_slips;
+    }
+    const double   sim_ps = (double)(-lead) * g_rt_ratio * 1000.0;
+    const uint64_t clks   = (uint64_t)(sim_ps / (double)(2 * CLK_HALF_PS));
+    run_clocks((int)(clks < (uint64_t)g_idle_clks * 100 ? clks : (uint64_t)g_idle_clks * 100));
+}
+
 // ─── TCP helpers ─────────────────────────────────────────────────────────────
 static bool recv_exact(int fd, void *buf, size_t n) {
     size_t got = 0;
@@ -96,6 +501,7 @@ static bool recv_exact(int fd, void *buf, size_t n) {
 }
 
 static bool send_exact(int fd, const void *buf, size_t n) {
+    if (fd < 0) return true;  // --replay: responses are compared, not sent
     size_t sent = 0;
     while (sent < n) {
         ssize_t r = send(fd, static_cast<const char*>(buf) + sent, n - sent, 0);
@@ -105,6 +511,182 @@ static bool send_exact(int fd, const void *buf, size_t n) {
     return true;
 }
 
+// ─── Latency instrumentation ─────────────────────────────────────────────────
+// Wall-clock latencies in ns, bucketed with 8 sub-buckets per power of two
+// (percentiles within 12.5%).  Turnaround runs from the moment a command has
+// been fully received to the moment its response has been sent (or, for
+// commands without a response, until it has been evaluated).
+#define LAT_BUCKETS 496u
+
+struct lat_stats {
+    uint64_t n;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t hist[LAT_BUCKETS];
+
+    static unsigned bucket(uint64_t ns) {
+        if (ns < 8) return (unsigned)ns;
+        const unsigned msb = 63u - (unsigned)__builtin_clzll(ns);
+        return (msb - 2u) * 8u + (unsigned)((ns >> (msb - 3u)) & 7u);
+    }
+    static uint64_t bucket_floor(unsigned b) {
+        if (b < 8) return b;
+        return (uint64_t)(8u + b % 8u) << (b / 8u - 1u);
+    }
+    void add(uint64_t ns) {
+        ++n;
+        sum_ns += ns;
+        if (ns > max_ns) max_ns = ns;
+        ++hist[bucket(ns)];
+    }
+    void merge(const lat_stats &o) {
+        n += o.n;
+        sum_ns += o.sum_ns;
+        if (o.max_ns > max_ns) max_ns = o.max_ns;
+        for (unsigned i = 0; i < LAT_BUCKETS; ++i) hist[i] += o.hist[i];
+    }
+    double pct_us(double p) const {
+        const uint64_t want = (uint64_t)(p * (double)n);
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < LAT_BUCKETS; ++i) {
+            seen += hist[i];
+            if (seen > want) return (double)bucket_floor(i) / 1e3;
+        }
+        return (double)max_ns / 1e3;
+    }
+};
+
+static thread_local lat_stats g_lat_wait;             // received -> evaluation starts
+static thread_local lat_stats g_lat_eval;             // evaluation (response send excluded)
+static thread_local lat_stats g_lat_turn;             // received -> response sent
+static thread_local uint64_t  g_lat_first_ns    = 0;  // first command received
+static thread_local uint64_t  g_lat_last_ns     = 0;  // last command evaluated
+static thread_local uint64_t  g_cur_rx_ns       = 0;  // current command: received at
+static thread_local uint64_t  g_cur_eval_end_ns = 0;  // current command: response ready at (0 = none)
+
+// ─── Socket I/O thread (--io-thread) ─────────────────────────────────────────
+// The I/O thread is the only one touching the socket once the session runs:
+// it sends queued responses first (the host is usually blocked on them),
+// then receives the next command into the rx queue.  The simulation thread
+// passes IO_QUEUE_FD as the connection, which makes respond() queue the
+// response instead of sending it.  A pipe wakes the I/O thread only when it
+// is parked in poll(), so a busy session costs no extra syscalls.
+#define IO_QUEUE_FD   (-2)
+#define IO_QUEUE_SIZE 64
+
+struct io_msg {
+    struct vpi_cmd cmd;
+    uint64_t       rx_ns;
+};
+
+// One per session, shared by its simulation thread and its I/O thread; both
+// reach it through their own g_io.
+struct io_channel {
+    SpscQueue<io_msg, IO_QUEUE_SIZE> rxq;  // I/O thread -> simulation thread
+    SpscQueue<io_msg, IO_QUEUE_SIZE> txq;  // simulation thread -> I/O thread
+    std::atomic<bool> stop{ false };
+    std::atomic<bool> closed{ false };     // peer closed the connection
+    std::atomic<bool> parked{ false };     // I/O thread is (about to be) in poll()
+    int               wake[2] = { -1, -1 };
+    lat_stats         lat_turn{};          // owned by the I/O thread until joined
+};
+static thread_local io_channel *g_io = nullptr;
+
+static bool io_flush_responses(int fd) {
+    while (io_msg *m = g_io->txq.front()) {
+        const bool ok = send_exact(fd, &m->cmd, sizeof(m->cmd));
+        g_io->lat_turn.add(wall_ns() - m->rx_ns);
+        g_io->txq.pop();
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static void io_thread_main(int fd, io_channel *ch) {
+    g_io = ch;
+    struct pollfd pfd[2] = { { fd, POLLIN, 0 }, { g_io->wake[0], POLLIN, 0 } };
+    bool rx_open = true;
+    while (!g_io->stop.load(std::memory_order_acquire)) {
+        if (!io_flush_responses(fd)) rx_open = false;
+
+        io_msg *slot = rx_open ? g_io->rxq.back() : nullptr;
+        pfd[0].events = slot ? POLLIN : 0;
+        g_io->parked.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int timeout = g_io->txq.front() ? 0 : 1;  // re-check after parking
+        const int ready   = poll(pfd, 2, timeout);
+        g_io->parked.store(false, std::memory_order_relaxed);
+        if (ready <= 0) continue;
+
+        if (pfd[1].revents & POLLIN) {
+            char drain[64];
+            while (read(g_io->wake[0], drain, sizeof(drain)) == (ssize_t)sizeof(drain)) {}
+        }
+        if (slot && (pfd[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+            if (!recv_exact(fd, &slot->cmd, sizeof(slot->cmd))) {
+                rx_open = false;
+                g_io->closed.store(true, std::memory_order_release);
+                continue;
+            }
+            slot->rx_ns = wall_ns();
+            g_io->rxq.push();
+        }
+    }
+    io_flush_responses(fd);
+}
+
+// Simulation thread: hand a response to the I/O thread.
+static void io_post_response(const struct vpi_cmd *c, uint64_t rx_ns) {
+    io_msg *m;
+    while ((m = g_io->txq.back()) == nullptr) std::this_thread::yield();
+    m->cmd   = *c;
+    m->rx_ns = rx_ns;
+    g_io->txq.push();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (g_io->parked.load(std::memory_order_seq_cst)) {
+        const char b = 1;
+        if (write(g_io->wake[1], &b, 1) < 0) {}  // full pipe: a wake-up is already pending
+    }
+}
+
+// Simulation thread: next queued command, waiting up to timeout_ns for one.
+static io_msg *io_next_cmd(uint64_t timeout_ns) {
+    io_msg *m = g_io->rxq.front();
+    if (m || timeout_ns == 0) return m;
+    const uint64_t t_end = wall_ns() + timeout_ns;
+    for (unsigned spin = 0; (m = g_io->rxq.front()) == nullptr; ++spin) {
+        if (g_io->closed.load(std::memory_order_acquire) || aborted()) return g_io->rxq.front();
+        if (spin >= 64) {
+            if (wall_ns() >= t_end) return nullptr;
+            std::this_thread::yield();
+        }
+    }
+    return m;
+}
+
+// Send (or, with --io-thread, queue) the response to the current command.
+static bool respond(int fd, struct vpi_cmd *c) {
+    g_cur_eval_end_ns = wall_ns();
+    if (fd == IO_QUEUE_FD) {
+        io_post_response(c, g_cur_rx_ns);
+        return true;
+    }
+    const bool ok = send_exact(fd, c, sizeof(*c));
+    g_lat_turn.add(wall_ns() - g_cur_rx_ns);
+    return ok;
+}
+
+// A command whose length does not fit the transfer buffer: log it, leave the
+// model untouched and, if the host waits for a response, answer with zeroed
+// TDO.  The session (and every other --instances session) keeps going.
+static bool reject_cmd(int fd, struct vpi_cmd *c, const char *what, uint32_t n, bool has_response) {
+    vpi_msg("%s too long (%u), ignored\n", what, n);
+    if (!has_response) return true;
+    memset(c->buffer_in, 0, sizeof(c->buffer_in));
+    c->length = 0;
+    return respond(fd, c);
+}
+
 // ─── VPI command processor ───────────────────────────────────────────────────
 static bool process_vpi_cmd(int fd, struct vpi_cmd *c) {
     const uint32_t cmd = c->cmd;
@@ -118,96 +700,806 @@ static bool process_vpi_cmd(int fd, struct vpi_cmd *c) {
         return true;
     }
 
-    case CMD_TMS_SEQ:
+    case CMD_TMS_SEQ: {
         // Not used in cJTAG mode
+        if (!g_jtag_mode) return true;
+
+        // Direct path: clock out nb_bits TMS bits, TDI held low.  No response
+        // is sent, matching stock jtag_vpi.
+        const uint32_t nb_bits = c->nb_bits;
+        if (nb_bits > XFERT_MAX_SIZE * 8u) return reject_cmd(fd, c, "TMS_SEQ", nb_bits, false);
+        for (uint32_t i = 0; i < nb_bits; ++i) {
+            uint8_t tms = (c->buffer_out[i / 8] >> (i % 8)) & 1u;
+            jtag_clock_bit(tms, 0);
+        }
+        g_stats[cmd].bits += nb_bits;
         return true;
+    }
 
     case CMD_SCAN_CHAIN:
-    case CMD_SCAN_CHAIN_FLIP_TMS:
-        // Not used in cJTAG mode
-        fprintf(stderr, "[VPI] SCAN_CHAIN not supported in cJTAG mode\n");
-        return true;
+    case CMD_SCAN_CHAIN_FLIP_TMS: {
+        if (!g_jtag_mode) {
+            // Not used in cJTAG mode
+            vpi_msg("SCAN_CHAIN not supported in cJTAG mode\n");
+            return true;
+        }
+
+        // Direct path: shift nb_bits LSB-first, TMS=1 on the last bit when
+        // FLIP_TMS (leaves Shift-xR for Exit1-xR), return captured TDO.
+        const uint32_t nb_bits = c->nb_bits;
+        if (nb_bits > XFERT_MAX_SIZE * 8u) return reject_cmd(fd, c, "SCAN_CHAIN", nb_bits, true);
+        memset(c->buffer_in, 0, sizeof(c->buffer_in));
+        for (uint32_t i = 0; i < nb_bits; ++i) {
+            uint8_t tdi = (c->buffer_out[i / 8] >> (i % 8)) & 1u;
+            uint8_t tms = (cmd == CMD_SCAN_CHAIN_FLIP_TMS && i == nb_bits - 1) ? 1u : 0u;
+            uint8_t tdo = jtag_clock_bit(tms, tdi);
+            c->buffer_in[i / 8] |= static_cast<uint8_t>(tdo << (i % 8));
+        }
+        g_stats[cmd].bits += nb_bits;
+        return respond(fd, c);
+    }
 
     case CMD_OSCAN1_RAW: {
         // cJTAG: drive TCKC/TMSC, return TMSC output
         uint8_t tckc = c->buffer_out[0] & 0x01u;
         uint8_t tmsc = (c->buffer_out[0] >> 1) & 0x01u;
-        
-        // 1-bit delay buffer to fix TDO sampling offset
-        // The TAP shifts by the time we sample (after 30 clocks), so we see bit N+1
-        // instead of bit N. Solution: Buffer each bit and return the previous one.
-        static uint8_t tdo_delay_buffer = 0;
-        static bool first_command = true;
-        
-        g_dut->tckc_i = tckc;
-        g_dut->tmsc_i = tmsc;
-        
-        // Run clocks to let bridge process
-        run_clocks(g_clks_per_vpi);
+        bool acked = false, tdo_window = false;
+        uint8_t tmsc_response = oscan1_edge(tckc, tmsc, &acked, &tdo_window);
+        if (tdo_window) g_stats[CMD_OSCAN1_RAW].bits++;  // one TDO window = one JTAG bit per OScan1 packet
 
-        // Read TMSC output when bridge is driving (tmsc_oen active-low = 0)
-        uint8_t oe  = g_dut->tmsc_oen & 1u;
-        uint8_t out = g_dut->tmsc_o & 1u;
-        uint8_t tmsc_current = (oe == 0u) ? out : 0u;
-        
-        // Return the PREVIOUS bit (from buffer), except on first command
-        // BUG FIX: Only apply delay to TDO reads (when oe=0), not to TDI/TMS bits
-        uint8_t tmsc_response;
-        if (oe == 0) {  // TDO window is open
-            tmsc_response = first_command ? tmsc_current : tdo_delay_buffer;
-            tdo_delay_buffer = tmsc_current;
-            first_command = false;
-        } else {
-            // Not a TDO read, just pass through
-            tmsc_response = tmsc_current;
-        }
-        
-        // Read internal JTAG signals for debugging
-        uint8_t tck  = g_dut->tck_o & 1u;
-        uint8_t tms  = g_dut->tms_o & 1u;
-        uint8_t tdi  = g_dut->tdi_o & 1u;
-        uint8_t tdo_comb = g_dut->tdo_comb_o & 1u;  // Combinatorial TDO (what bridge uses)
-        uint8_t tdo_reg  = g_dut->tdo_o & 1u;       // Negedge-registered (valid when TCK=0)
-        uint8_t online = g_dut->online_o & 1u;
-
-#ifdef VERBOSE
-        static int cmd_count = 0;
-        ++cmd_count;
-        if (cmd_count <= 150 || (cmd_count > 4400 && cmd_count <= 4700)) {
-            fprintf(stderr, "[VPI] #%04d: TCKC=%u TMSC_in=%u | oe=%u out=%u → TMSC=%u (resp=%u) | TCK=%u TMS=%u TDI=%u TDO_comb=%u TDO_reg=%u online=%u\n",
-                    cmd_count, tckc, tmsc, oe, out, tmsc_current, tmsc_response, tck, tms, tdi, tdo_comb, tdo_reg, online);
+        memset(c->buffer_in, 0, sizeof(c->buffer_in));
+        c->buffer_in[0] = static_cast<uint8_t>(tmsc_response | (acked ? 0x02u : 0u));  // bit1: RTCK ack
+        return respond(fd, c);
+    }
+
+    case CMD_OSCAN1_REPEAT: {
+        // cJTAG: nb_bits identical OScan1 packets in one round trip
+        // (RUNTEST idle, constant-TDI shifts).  buffer_out[0]: bit0 TDI,
+        // bit1 TMS, bit2 return TDO.  Each packet is driven edge for edge
+        // as the host's SF0 encoder would, so TDO bits (LSB-first in
+        // buffer_in) match a CMD_OSCAN1_RAW sequence exactly.  The response
+        // length field carries the number of unacknowledged edges (--rtck).
+        const uint8_t  ntdi    = (c->buffer_out[0] & 0x01u) ^ 0x01u;
+        const uint8_t  tms     = (c->buffer_out[0] >> 1) & 0x01u;
+        const bool     capture = (c->buffer_out[0] & 0x04u) != 0;
+        const uint32_t count   = c->nb_bits;
+        if (capture && count > XFERT_MAX_SIZE * 8u) return reject_cmd(fd, c, "OSCAN1_REPEAT capture", count, true);
+        memset(c->buffer_in, 0, sizeof(c->buffer_in));
+        uint32_t nacks = 0;
+        for (uint32_t i = 0; i < count && !aborted(); ++i) {
+            const uint8_t edges[6][2] = { { 0, ntdi }, { 1, ntdi }, { 0, tms }, { 1, tms }, { 0, 0 }, { 1, 0 } };
+            for (int e = 0; e < 6; ++e) {
+                bool acked = false, tdo_window = false;
+                const uint8_t r = oscan1_edge(edges[e][0], edges[e][1], &acked, &tdo_window);
+                if (!acked) ++nacks;
+                if (e == 4 && capture) c->buffer_in[i / 8] |= static_cast<uint8_t>(r << (i % 8));
+            }
         }
-#endif
+        g_stats[CMD_OSCAN1_REPEAT].bits += count;
+        c->length = nacks;
+        return respond(fd, c);
+    }
 
+    case CMD_VENDOR: {
+        // cJTAG: one bridge vendor frame.  buffer_out[0] opcode,
+        // buffer_out[1] operand bits, buffer_out[2] response bits, operands
+        // LSB-first from buffer_out[4].  Response bits LSB-first in
+        // buffer_in; length carries the unacknowledged edges (--rtck).
+        if (g_jtag_mode) {
+            vpi_msg("VENDOR not supported in --jtag mode\n");
+            return true;
+        }
+        const uint32_t n_in  = c->buffer_out[1];
+        const uint32_t n_out = c->buffer_out[2];
         memset(c->buffer_in, 0, sizeof(c->buffer_in));
-        c->buffer_in[0] = tmsc_response;  // Send buffered value on TCKC rising edge
-        return send_exact(fd, c, sizeof(*c));
+        c->length = vendor_frame(c->buffer_out[0], &c->buffer_out[4], n_in, c->buffer_in, n_out);
+        g_stats[CMD_VENDOR].bits += n_out;
+        return respond(fd, c);
     }
 
     case CMD_STOP_SIMU:
-        fprintf(stderr, "[VPI] CMD_STOP_SIMU received\n");
+        vpi_msg("CMD_STOP_SIMU received\n");
         return false;
 
     default:
-        fprintf(stderr, "[VPI] Unknown VPI command 0x%08x\n", cmd);
+        vpi_msg("Unknown VPI command 0x%08x\n", cmd);
         return true;
     }
 }
 
-// ─── Main ────────────────────────────────────────────────────────────────────
-int main(int argc, char **argv) {
-    // Parse arguments
-    for (int i = 1; i < argc; ++i) {
-        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
-            g_vpi_port = atoi(argv[++i]);
-        } else if (strcmp(argv[i], "--trace") == 0) {
-            g_trace_enabled = true;
-        } else if (strcmp(argv[i], "--max-cycles") == 0 && i + 1 < argc) {
-            g_max_cycles = strtoull(argv[++i], nullptr, 10);
-        } else if (strcmp(argv[i], "--clks-per-vpi") == 0 && i + 1 < argc) {
-            g_clks_per_vpi = atoi(argv[++i]);
+// ─── Session record / replay ─────────────────────────────────────────────────
+// File: header, then one record per command: idle clk_i cycles since the
+// previous command finished, followed by the vpi_cmd as it stood after
+// processing (request in buffer_out, response in buffer_in).  Host byte order.
+static const char     REC_MAGIC[8]    = { 'C', 'J', 'V', 'P', 'I', 'R', 'E', 'C' };
+static const uint32_t REC_VERSION     = 1;
+static const uint32_t REC_FLAG_JTAG   = 1u << 0;
+static const uint32_t REC_FLAG_RTCK   = 1u << 1;
+
+struct rec_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;
+};
+
+static thread_local FILE*    g_rec_fp         = nullptr;
+static thread_local uint64_t g_rec_last_cycle = 0;  // g_cycle when the previous command finished
+static thread_local uint64_t g_rec_commands   = 0;  // commands recorded so far
+
+static uint32_t rec_mode_flags() {
+    return (g_jtag_mode ? REC_FLAG_JTAG : 0u) | (g_rtck_mode ? REC_FLAG_RTCK : 0u);
+}
+
+static bool record_open(const char *path) {
+    g_rec_fp = fopen(path, "wb");
+    if (!g_rec_fp) {
+        vpi_msg("Cannot create %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    rec_header h;
+    memcpy(h.magic, REC_MAGIC, sizeof(h.magic));
+    h.version = REC_VERSION;
+    h.flags   = rec_mode_flags();
+    fwrite(&h, sizeof(h), 1, g_rec_fp);
+    g_rec_last_cycle = g_cycle;
+    vpi_msg("Recording session → %s\n", path);
+    if (!g_ckpt_every) unlink((std::string(path) + ".ckpt").c_str());  // stale archive
+    return true;
+}
+
+// ─── Checkpoint archive (--checkpoint-every, --seek) ─────────────────────────
+// FILE.ckpt next to the recording: header, then per checkpoint a ckpt_entry
+// followed by a Verilator save stream (harness state, then the model).  A
+// clean shutdown appends the index (every ckpt_entry) and a ckpt_footer;
+// without them the reader walks the entries up to the first torn one.
+// Host byte order.
+static const char     CKPT_MAGIC[8] = { 'C', 'J', 'V', 'P', 'I', 'C', 'K', 'P' };
+static const uint32_t CKPT_VERSION  = 1;
+
+struct ckpt_header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;       // rec_mode_flags() of the session
+};
+
+struct ckpt_entry {
+    uint64_t cycle;       // g_cycle at the command boundary
+    uint64_t commands;    // commands recorded before it
+    uint64_t rec_offset;  // recording offset of the next command
+    uint64_t offset;      // archive offset of this entry
+    uint64_t size;        // save stream bytes after it (0 while being written)
+};
+
+struct ckpt_footer {
+    uint64_t index_offset;
+    uint64_t count;
+    char     magic[8];
+};
+
+// Verilator's save/restore streams on the archive instead of a file of
+// their own: the same buffer, header() and trailer() VerilatedSave and
+// VerilatedRestore use, written through stdio and read from the mapping.
+class CkptWriter final : public VerilatedSerialize {
+public:
+    explicit CkptWriter(FILE* fp) : fp_(fp) {
+        m_isOpen = true;
+        header();
+    }
+    ~CkptWriter() override { close(); }
+    void close() override {
+        if (!isOpen()) return;
+        trailer();
+        flush();
+        m_isOpen = false;
+    }
+    void flush() override {
+        bytes_ += fwrite(m_bufp, 1, (size_t)(m_cp - m_bufp), fp_);
+        m_cp = m_bufp;
+    }
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    FILE*    fp_;
+    uint64_t bytes_ = 0;
+};
+
+class CkptReader final : public VerilatedDeserialize {
+public:
+    CkptReader(const uint8_t* p, size_t n) : p_(p), end_(p + n) {
+        m_isOpen = true;
+        m_cp     = m_bufp;
+        m_endp   = m_bufp;
+        header();
+    }
+    ~CkptReader() override { close(); }
+    void close() override {
+        if (!isOpen()) return;
+        trailer();
+        m_isOpen = false;
+    }
+
+protected:
+    void fill() override {
+        const size_t keep = (size_t)(m_endp - m_cp);
+        memmove(m_bufp, m_cp, keep);
+        m_cp   = m_bufp;
+        m_endp = m_bufp + keep;
+        const size_t n = std::min((size_t)(end_ - p_), bufferSize() - keep);
+        memcpy(m_endp, p_, n);
+        m_endp += n;
+        p_     += n;
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+// Everything replay needs besides the recording: model, time, link error
+// generator and the OScan1 TDO delay buffer
+template <typename S>
+static void ckpt_state(S& s) {
+    s & g_cycle;
+    s & g_sim_time;
+    s & g_ber_rng;
+    s & g_ber_flip;
+    s & g_tdo_delay_buffer;
+    s & g_first_command;
+    s & *g_dut;
+}
+
+struct CkptSave {
+    VerilatedSerialize& os;
+    template <typename T> CkptSave& operator&(T& v) { os << v; return *this; }
+};
+struct CkptLoad {
+    VerilatedDeserialize& is;
+    template <typename T> CkptLoad& operator&(T& v) { is >> v; return *this; }
+};
+
+static thread_local FILE*                   g_ckpt_fp   = nullptr;
+static thread_local uint64_t                g_ckpt_next = 0;  // checkpoint at the first boundary from here
+static thread_local std::vector<ckpt_entry> g_ckpt_index;
+
+static bool ckpt_open(const char *rec_path) {
+    const std::string path = std::string(rec_path) + ".ckpt";
+    g_ckpt_fp = fopen(path.c_str(), "wb");
+    if (!g_ckpt_fp) {
+        vpi_msg("Cannot create %s: %s\n", path.c_str(), strerror(errno));
+        return false;
+    }
+    ckpt_header h;
+    memcpy(h.magic, CKPT_MAGIC, sizeof(h.magic));
+    h.version = CKPT_VERSION;
+    h.flags   = rec_mode_flags();
+    fwrite(&h, sizeof(h), 1, g_ckpt_fp);
+    g_ckpt_next = g_cycle + g_ckpt_every;
+    vpi_msg("Checkpoint every %llu cycles → %s\n", (unsigned long long)g_ckpt_every, path.c_str());
+    return true;
+}
+
+// At a command boundary, after the command's record has been written.  Both
+// files are flushed so the archive stays usable if the session dies later.
+static void ckpt_save() {
+    ckpt_entry e;
+    e.cycle      = g_cycle;
+    e.commands   = g_rec_commands;
+    e.rec_offset = (uint64_t)ftello(g_rec_fp);
+    e.offset     = (uint64_t)ftello(g_ckpt_fp);
+    e.size       = 0;
+    fwrite(&e, sizeof(e), 1, g_ckpt_fp);
+    {
+        CkptWriter os(g_ckpt_fp);
+        CkptSave   save{os};
+        ckpt_state(save);
+        os.close();
+        e.size = os.bytes();
+    }
+    fseeko(g_ckpt_fp, (off_t)e.offset, SEEK_SET);
+    fwrite(&e, sizeof(e), 1, g_ckpt_fp);
+    fseeko(g_ckpt_fp, 0, SEEK_END);
+    fflush(g_ckpt_fp);
+    fflush(g_rec_fp);
+    g_ckpt_index.push_back(e);
+    g_ckpt_next = (g_cycle / g_ckpt_every + 1) * g_ckpt_every;
+}
+
+static void ckpt_close() {
+    ckpt_footer f;
+    f.index_offset = (uint64_t)ftello(g_ckpt_fp);
+    f.count        = g_ckpt_index.size();
+    memcpy(f.magic, CKPT_MAGIC, sizeof(f.magic));
+    if (!g_ckpt_index.empty()) fwrite(g_ckpt_index.data(), sizeof(ckpt_entry), g_ckpt_index.size(), g_ckpt_fp);
+    fwrite(&f, sizeof(f), 1, g_ckpt_fp);
+    fclose(g_ckpt_fp);
+    g_ckpt_fp = nullptr;
+}
+
+// Cycle-ordered entries of a mapped archive
+static std::vector<ckpt_entry> ckpt_read_index(const uint8_t *base, size_t size) {
+    std::vector<ckpt_entry> idx;
+    ckpt_footer f;
+    if (size >= sizeof(ckpt_header) + sizeof(f)) {
+        memcpy(&f, base + size - sizeof(f), sizeof(f));
+        if (memcmp(f.magic, CKPT_MAGIC, sizeof(f.magic)) == 0 && f.index_offset <= size - sizeof(f) &&
+            f.count == (size - sizeof(f) - f.index_offset) / sizeof(ckpt_entry)) {
+            idx.resize(f.count);
+            if (f.count) memcpy(idx.data(), base + f.index_offset, f.count * sizeof(ckpt_entry));
+            return idx;
+        }
+    }
+    // No index: the session did not shut down cleanly
+    for (uint64_t off = sizeof(ckpt_header); off + sizeof(ckpt_entry) <= size;) {
+        ckpt_entry e;
+        memcpy(&e, base + off, sizeof(e));
+        if (e.offset != off || e.size == 0 || e.size > size - off - sizeof(e)) break;
+        idx.push_back(e);
+        off += sizeof(e) + e.size;
+    }
+    return idx;
+}
+
+// Restore the last checkpoint at or before g_seek_cycle from REC.ckpt and
+// position the recording after the commands it covers.  Returns how many
+// commands that skips (0: no usable checkpoint, replay from the start).
+static int64_t ckpt_restore(const char *rec_path, FILE *rec) {
+    const std::string path = std::string(rec_path) + ".ckpt";
+    const int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ckpt_header)) {
+        vpi_msg("No checkpoint archive %s, replaying from the start\n", path.c_str());
+        if (fd >= 0) close(fd);
+        return 0;
+    }
+    const size_t size = (size_t)st.st_size;
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        vpi_msg("Cannot map %s: %s\n", path.c_str(), strerror(errno));
+        return 0;
+    }
+    const uint8_t *base = static_cast<const uint8_t*>(map);
+    ckpt_header h;
+    memcpy(&h, base, sizeof(h));
+    int64_t skipped = 0;
+    if (memcmp(h.magic, CKPT_MAGIC, sizeof(h.magic)) != 0 || h.version != CKPT_VERSION) {
+        vpi_msg("%s is not a checkpoint archive, replaying from the start\n", path.c_str());
+    } else {
+        const std::vector<ckpt_entry> idx = ckpt_read_index(base, size);
+        auto it = std::upper_bound(idx.begin(), idx.end(), g_seek_cycle,
+                                   [](uint64_t c, const ckpt_entry& e) { return c < e.cycle; });
+        if (it == idx.begin()) {
+            vpi_msg("No checkpoint at or before cycle %llu, replaying from the start\n",
+                    (unsigned long long)g_seek_cycle);
+        } else {
+            const ckpt_entry& e = *--it;
+            {
+                CkptReader is(base + e.offset + sizeof(e), (size_t)e.size);
+                CkptLoad   load{is};
+                ckpt_state(load);
+                is.close();
+            }
+            fseeko(rec, (off_t)e.rec_offset, SEEK_SET);
+            g_rec_last_cycle = g_cycle;
+            skipped          = (int64_t)e.commands;
+            vpi_msg("Restored checkpoint %zu/%zu: cycle %llu, command #%lld\n",
+                    (size_t)(it - idx.begin()) + 1, idx.size(), (unsigned long long)e.cycle, (long long)skipped);
         }
     }
+    munmap(map, size);
+    return skipped;
+}
+
+// Log, execute and account one command received at rx_ns; idle cycles are
+// those run since the previous command (for the recording).
+static bool dispatch_cmd(int fd, struct vpi_cmd *c, uint64_t rx_ns) {
+    const uint64_t idle        = g_cycle - g_rec_last_cycle;
+    const uint64_t start_cycle = g_cycle;
+    if (c->cmd != CMD_OSCAN1_RAW) {
+        CJTAG_LOG(LOG_CAT_VPI, LOG_DEBUG, LOGID_VPI_CMD, c->cmd, c->length, c->nb_bits, 0);
+    }
+    const uint64_t t0 = wall_ns();
+    if (g_lat_first_ns == 0) g_lat_first_ns = rx_ns;
+    g_lat_wait.add(t0 - rx_ns);
+    g_cur_rx_ns       = rx_ns;
+    g_cur_eval_end_ns = 0;
+    const bool running = process_vpi_cmd(fd, c);
+    const uint64_t t1 = g_cur_eval_end_ns ? g_cur_eval_end_ns : wall_ns();
+    g_lat_eval.add(t1 - t0);
+    if (!g_cur_eval_end_ns) g_lat_turn.add(t1 - rx_ns);  // no response
+    g_lat_last_ns = t1;
+    const uint32_t slot = c->cmd < CMD_STATS_SLOTS ? c->cmd : CMD_STATS_SLOTS - 1;
+    g_stats[slot].count  += 1;
+    g_stats[slot].cycles += g_cycle - start_cycle;
+    if (g_rec_fp) {
+        fwrite(&idle, sizeof(idle), 1, g_rec_fp);
+        fwrite(c, sizeof(*c), 1, g_rec_fp);
+        ++g_rec_commands;
+        if (g_ckpt_fp && g_cycle >= g_ckpt_next) ckpt_save();
+    }
+    g_rec_last_cycle = g_cycle;
+    return running;
+}
+
+// Re-run a recorded session; returns the number of commands executed or -1.
+static int64_t replay_session(const char *path, uint64_t *mismatches) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        vpi_msg("Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    rec_header h;
+    if (fread(&h, sizeof(h), 1, fp) != 1 || memcmp(h.magic, REC_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != REC_VERSION) {
+        vpi_msg("%s is not a VPI session recording\n", path);
+        fclose(fp);
+        return -1;
+    }
+    if (h.flags != rec_mode_flags()) {
+        vpi_msg("Warning: recorded with%s%s, replaying with%s%s\n",
+                (h.flags & REC_FLAG_JTAG) ? " --jtag" : "", (h.flags & REC_FLAG_RTCK) ? " --rtck" : "",
+                g_jtag_mode ? " --jtag" : "", g_rtck_mode ? " --rtck" : "");
+    }
+    vpi_msg("Replaying session ← %s\n", path);
+
+    int64_t  count = 0;
+    uint64_t idle  = 0;
+    struct vpi_cmd rec, cmd;
+    *mismatches = 0;
+    if (g_seek_cycle) {
+        count = ckpt_restore(path, fp);
+        vpi_msg("Seeking to cycle %llu%s\n", (unsigned long long)g_seek_cycle,
+                g_tfp ? ", tracing from there" : "");
+    }
+    const uint64_t stop = g_seek_span ? g_seek_cycle + g_seek_span : 0;
+    while (!aborted() && (stop == 0 || g_cycle < stop) &&
+           fread(&idle, sizeof(idle), 1, fp) == 1 && fread(&rec, sizeof(rec), 1, fp) == 1) {
+        run_clocks((int)idle);
+        cmd = rec;
+        memset(cmd.buffer_in, 0, sizeof(cmd.buffer_in));
+        const bool running = dispatch_cmd(-1, &cmd, wall_ns());
+        ++count;
+        if (memcmp(cmd.buffer_in, rec.buffer_in, sizeof(rec.buffer_in)) != 0) {
+            if (*mismatches < 10) {
+                vpi_msg("Replay: response to command #%lld (%s) differs from recording\n",
+                        (long long)count, cmd_name(cmd.cmd));
+            }
+            ++*mismatches;
+        }
+        if (!running) break;
+    }
+    fclose(fp);
+    return count;
+}
+
+// ─── remote_bitbang frontend (--bitbang, --bitbang-raw) ──────────────────────
+// OpenOCD's remote_bitbang driver sends one character per pin write and
+// waits only for the answers to 'R'.  Each receive is processed in one go
+// and its answers go back in one send.
+//
+// --bitbang takes the stock JTAG characters: '0'-'7' set TCK/TMS/TDI (bits
+// 2/1/0), and each TCK rising edge becomes one OScan1 packet (nTDI, TMS, TDO
+// slot).  A packet that finds the bridge offline first runs the jtag_vpi
+// patch's init sequence (reset escape, select escape, OAC=0xC EC=0x8).  The
+// bridge raises TCK inside the TDO slot, so the bit sampled there is the
+// TDO of the *next* TCK cycle; it answers the next 'R', which OpenOCD sends
+// while TCK is low, before that cycle's rising edge.  With --jtag the
+// characters drive the TAP's 4-wire pins directly.
+//
+// --bitbang-raw maps the characters onto the link for cJTAG-aware clients:
+// TCK -> TCKC, TMS -> TMSC (TDI ignored).  Every write is one edge and 'R'
+// answers TMSC, exactly as the CMD_OSCAN1_RAW response would.
+//
+// Both modes: 'r'-'u' set TRST (bit 1, drives ntrst_i) and SRST (bit 0, no
+// such pin), 'Z' / 'z' idle 1 ms / 1 us of simulated time, 'B' / 'b' are
+// ignored and 'Q' ends the session.  SWD characters are not supported.
+#define BITBANG_CLKS_PER_US ((int)(1000000ULL / (2 * CLK_HALF_PS)))
+
+struct bitbang_state {
+    uint8_t  tck  = 0;
+    uint8_t  tms  = 1;
+    uint8_t  tdi  = 0;
+    uint8_t  tdo  = 0;  // answer to the next 'R'
+    uint64_t activations = 0;
+    bool     warned      = false;
+};
+static thread_local bitbang_state g_bb;
+
+// Same sequence as the jtag_vpi patch's cJTAG init
+static void bitbang_activate() {
+    static const int escapes[2] = { 8, 6 };  // reset, then select
+    bool acked = false, tdo_window = false;
+    for (int toggles : escapes) {
+        uint8_t tmsc = 0;
+        oscan1_edge(0, tmsc, &acked, &tdo_window);
+        oscan1_edge(1, tmsc, &acked, &tdo_window);
+        for (int i = 0; i < toggles; ++i) {
+            tmsc ^= 1u;
+            oscan1_edge(1, tmsc, &acked, &tdo_window);
+        }
+        oscan1_edge(0, tmsc, &acked, &tdo_window);
+    }
+    const uint16_t oac = 0xC, ec = 0x8;
+    const uint16_t act = static_cast<uint16_t>(oac | (ec << 4) | ((oac ^ ec) << 8));
+    for (int i = 0; i < 12; ++i) {
+        const uint8_t b = (act >> i) & 1u;
+        oscan1_edge(0, b, &acked, &tdo_window);
+        oscan1_edge(1, b, &acked, &tdo_window);
+    }
+    ++g_bb.activations;
+}
+
+// One JTAG TCK cycle as an OScan1 packet; keeps the slot's TDO for 'R'
+static void bitbang_packet(uint8_t tms, uint8_t tdi) {
+    if (!(g_dut->online_o & 1u)) bitbang_activate();
+    bool acked = false, tdo_window = false;
+    const uint8_t ntdi = tdi ^ 1u;
+    oscan1_edge(0, ntdi, &acked, &tdo_window);
+    oscan1_edge(1, ntdi, &acked, &tdo_window);
+    oscan1_edge(0, tms, &acked, &tdo_window);
+    oscan1_edge(1, tms, &acked, &tdo_window);
+    oscan1_edge(0, 0, &acked, &tdo_window);  // TDO slot: TCK has risen
+    g_bb.tdo = ((g_dut->tmsc_oen & 1u) == 0u) ? (g_dut->tmsc_o & 1u) : 0u;
+    oscan1_edge(1, 0, &acked, &tdo_window);
+}
+
+static void bitbang_write(uint8_t v) {
+    const uint8_t tck = (v >> 2) & 1u, tms = (v >> 1) & 1u, tdi = v & 1u;
+    if (g_bitbang == BITBANG_RAW) {
+        bool acked = false, tdo_window = false;
+        g_bb.tdo = oscan1_edge(tck, tms, &acked, &tdo_window) & 1u;
+        if (tdo_window) g_stats[STAT_BITBANG].bits++;
+    } else if (g_jtag_mode) {
+        g_dut->jtag_tck_i = tck;
+        g_dut->jtag_tms_i = tms;
+        g_dut->jtag_tdi_i = tdi;
+        if (tck != g_bb.tck) {
+            settle_edge(tck);
+            if (tck) g_stats[STAT_BITBANG].bits++;
+        }
+    } else if (tck && !g_bb.tck) {
+        bitbang_packet(tms, tdi);
+        g_stats[STAT_BITBANG].bits++;
+    }
+    g_bb.tck = tck;
+    g_bb.tms = tms;
+    g_bb.tdi = tdi;
+}
+
+static uint8_t bitbang_read() {
+    return (g_jtag_mode && g_bitbang == BITBANG_JTAG) ? (g_dut->tdo_o & 1u) : g_bb.tdo;
+}
+
+// Process one receive worth of characters.  False when the client quit or
+// closed the connection.
+static bool bitbang_batch(int fd) {
+    char in[4096], out[4096];
+    const ssize_t n = recv(fd, in, sizeof(in), 0);
+    if (n <= 0) {
+        vpi_msg("Connection closed by OpenOCD\n");
+        return false;
+    }
+    const uint64_t rx_ns = wall_ns(), start_cycle = g_cycle, start_bits = g_stats[STAT_BITBANG].bits;
+    if (g_lat_first_ns == 0) g_lat_first_ns = rx_ns;
+
+    size_t n_out   = 0;
+    bool   running = true;
+    for (ssize_t i = 0; i < n && running && !aborted(); ++i) {
+        const char ch = in[i];
+        if (ch >= '0' && ch <= '7') {
+            bitbang_write(static_cast<uint8_t>(ch - '0'));
+        } else if (ch == 'R') {
+            out[n_out++] = static_cast<char>('0' + bitbang_read());
+        } else if (ch >= 'r' && ch <= 'u') {
+            const bool trst = ((ch - 'r') & 2) != 0;
+            g_dut->ntrst_i = trst ? 0 : 1;  // active-low
+            run_clocks(g_clks_per_vpi * 4);
+        } else if (ch == 'Z') {
+            run_clocks(1000 * BITBANG_CLKS_PER_US);
+        } else if (ch == 'z') {
+            run_clocks(BITBANG_CLKS_PER_US);
+        } else if (ch == 'Q') {
+            vpi_msg("remote_bitbang quit received\n");
+            running = false;
+        } else if (ch != 'B' && ch != 'b' && ch != '\n' && ch != '\r' && !g_bb.warned) {
+            vpi_msg("remote_bitbang: ignoring unsupported character '%c'\n", ch);
+            g_bb.warned = true;
+        }
+    }
+    const uint64_t t1 = wall_ns();
+    const bool     sent = n_out == 0 || send_exact(fd, out, n_out);
+
+    CJTAG_LOG(LOG_CAT_VPI, LOG_DEBUG, LOGID_VPI_BB, (uint32_t)n, (uint32_t)n_out,
+              (uint32_t)(g_stats[STAT_BITBANG].bits - start_bits), 0);
+    g_stats[STAT_BITBANG].count  += 1;
+    g_stats[STAT_BITBANG].cycles += g_cycle - start_cycle;
+    g_lat_wait.add(0);
+    g_lat_eval.add(t1 - rx_ns);
+    g_lat_turn.add(wall_ns() - rx_ns);
+    g_lat_last_ns = t1;
+    return running && sent;
+}
+
+// ─── Xilinx Virtual Cable frontend (--xvc) ───────────────────────────────────
+// XVC 1.0, one command per select() wake-up:
+//   getinfo:                        -> "xvcServer_v1.0:<max vector bytes>\n"
+//   settck:<u32 period ns>          -> <u32 period ns actually used>
+//   shift:<u32 bits><tms[]><tdi[]>  -> <tdo[]>   (LSB-first, little-endian)
+// Each bit is one TCK cycle through the bitbang packet path (or the 4-wire
+// pins with --jtag), with TDO taken before the rising edge as in the XVC
+// reference server.  A TCK period is one OScan1 packet, i.e. six TCKC edges
+// of --clks-per-vpi clocks each (two edges with --jtag), so settck: rounds
+// the requested period to whole clk_i cycles per edge.
+#define XVC_MAX_BYTES  2048
+#define XVC_MIN_CLKS   8     // synchronizer + edge detect + TDO slot turnaround
+#define XVC_MAX_CLKS   10000
+
+static uint8_t xvc_clock_bit(uint8_t tms, uint8_t tdi) {
+    if (g_jtag_mode) return jtag_clock_bit(tms, tdi);
+    const uint8_t tdo = g_bb.tdo;
+    bitbang_packet(tms, tdi);
+    return tdo;
+}
+
+static uint32_t xvc_tck_period_ns() {
+    const uint32_t edges = g_jtag_mode ? 2u : 6u;
+    return edges * (uint32_t)g_clks_per_vpi * (uint32_t)(2 * CLK_HALF_PS / 1000);
+}
+
+static uint32_t xvc_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void xvc_put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Serve one command; false when the client closed the connection or sent
+// something that is not XVC.
+static bool xvc_command(int fd) {
+    char name[16];
+    size_t len = 0;
+    for (;;) {
+        if (!recv_exact(fd, &name[len], 1)) {
+            vpi_msg("Connection closed by XVC client\n");
+            return false;
+        }
+        if (name[len] == ':') break;
+        if (++len == sizeof(name) - 1) {
+            vpi_msg("XVC: unknown command\n");
+            return false;
+        }
+    }
+    name[len] = '\0';
+
+    const uint64_t rx_ns = wall_ns(), start_cycle = g_cycle;
+    if (g_lat_first_ns == 0) g_lat_first_ns = rx_ns;
+    bool ok = true;
+    if (strcmp(name, "getinfo") == 0) {
+        char info[32];
+        const int n = snprintf(info, sizeof(info), "xvcServer_v1.0:%u\n", XVC_MAX_BYTES);
+        ok = send_exact(fd, info, (size_t)n);
+        CJTAG_LOG(LOG_CAT_VPI, LOG_DEBUG, LOGID_VPI_XVC, 0, 0, 0, 0);
+    } else if (strcmp(name, "settck") == 0) {
+        uint8_t buf[4];
+        if (!recv_exact(fd, buf, sizeof(buf))) return false;
+        const uint32_t edges = g_jtag_mode ? 2u : 6u;
+        const uint64_t clks  = ((uint64_t)xvc_u32(buf) * 1000u / (2 * CLK_HALF_PS) + edges / 2) / edges;
+        g_clks_per_vpi = (int)(clks < XVC_MIN_CLKS ? XVC_MIN_CLKS : clks > XVC_MAX_CLKS ? XVC_MAX_CLKS : clks);
+        xvc_put_u32(buf, xvc_tck_period_ns());
+        ok = send_exact(fd, buf, sizeof(buf));
+        vpi_msg("XVC: TCK period %u ns (%d clocks per edge)\n", xvc_tck_period_ns(), g_clks_per_vpi);
+    } else if (strcmp(name, "shift") == 0) {
+        static thread_local uint8_t vec[2 * XVC_MAX_BYTES], tdo[XVC_MAX_BYTES];
+        uint8_t buf[4];
+        if (!recv_exact(fd, buf, sizeof(buf))) return false;
+        const uint32_t nbits  = xvc_u32(buf);
+        const uint32_t nbytes = (nbits + 7u) / 8u;
+        if (nbytes > XVC_MAX_BYTES) {
+            vpi_msg("XVC: shift of %u bits exceeds %u bytes\n", nbits, XVC_MAX_BYTES);
+            return false;
+        }
+        if (!recv_exact(fd, vec, 2u * nbytes)) return false;
+        memset(tdo, 0, nbytes);
+        for (uint32_t i = 0; i < nbits && !aborted(); ++i) {
+            const uint8_t tms = (vec[i / 8] >> (i % 8)) & 1u;
+            const uint8_t tdi = (vec[nbytes + i / 8] >> (i % 8)) & 1u;
+            tdo[i / 8] |= static_cast<uint8_t>(xvc_clock_bit(tms, tdi) << (i % 8));
+        }
+        ok = send_exact(fd, tdo, nbytes);
+        g_stats[STAT_XVC_SHIFT].count  += 1;
+        g_stats[STAT_XVC_SHIFT].cycles += g_cycle - start_cycle;
+        g_stats[STAT_XVC_SHIFT].bits   += nbits;
+        CJTAG_LOG(LOG_CAT_VPI, LOG_DEBUG, LOGID_VPI_XVC, 1, nbits, 0, 0);
+    } else {
+        vpi_msg("XVC: unknown command '%s:'\n", name);
+        return false;
+    }
+    const uint64_t t1 = wall_ns();
+    g_lat_wait.add(0);
+    g_lat_eval.add(t1 - rx_ns);
+    g_lat_turn.add(t1 - rx_ns);
+    g_lat_last_ns = t1;
+    return ok;
+}
+
+// ─── Summary ─────────────────────────────────────────────────────────────────
+static std::mutex g_summary_mutex;  // --instances: one summary at a time
+
+static void print_summary(uint64_t cmd_count) {
+    std::lock_guard<std::mutex> lock(g_summary_mutex);
+    vpi_msg("Done: %llu commands, %llu cycles\n",
+            (unsigned long long)cmd_count, (unsigned long long)g_cycle);
+    if (g_rtck_mode) {
+        vpi_msg("RTCK: %llu edges not acknowledged within %d clocks\n",
+                (unsigned long long)g_rtck_timeouts, g_clks_per_vpi);
+    }
+    if (g_rt_ratio > 0.0) {
+        const double wall_s = (double)(wall_ns() - g_rt_wall0_ns) / 1e9;
+        const double sim_s  = (double)(g_sim_time - g_rt_sim0_ps) / 1e12;
+        vpi_msg("Real-time: %.3f s sim / %.3f s wall (ratio %g, target %g), slept %.3f s, %llu slips\n",
+                sim_s, wall_s, wall_s > 0.0 ? sim_s / wall_s : 0.0, g_rt_ratio,
+                (double)g_rt_slept_ns / 1e9, (unsigned long long)g_rt_slips);
+    }
+    if ((g_bitbang == BITBANG_JTAG || g_xvc) && !g_jtag_mode) {
+        vpi_msg("%s: %llu bridge activations\n", g_xvc ? "XVC" : "remote_bitbang",
+                (unsigned long long)g_bb.activations);
+    }
+    if (g_tmsc_ber > 0.0) {
+        vpi_msg("Link errors: %llu host bits flipped (BER %g)\n",
+                (unsigned long long)g_ber_flips, g_tmsc_ber);
+    }
+    vpi_msg("%-20s %10s %12s %10s %12s\n", "command", "count", "cycles", "bits", "cycles/bit");
+    for (uint32_t i = 0; i < CMD_STATS_SLOTS; ++i) {
+        const cmd_stats &st = g_stats[i];
+        if (st.count == 0) continue;
+        vpi_msg("%-20s %10llu %12llu %10llu %12.1f\n", cmd_name(i),
+                (unsigned long long)st.count, (unsigned long long)st.cycles, (unsigned long long)st.bits,
+                st.bits ? (double)st.cycles / (double)st.bits : 0.0);
+    }
+    if (g_lat_eval.n == 0) return;
+    vpi_msg("%-20s %10s %12s %10s %12s\n", "latency (us)", "mean", "p50", "p99", "max");
+    const struct { const char *name; const lat_stats *st; } rows[] = {
+        { "queue wait", &g_lat_wait }, { "evaluation", &g_lat_eval }, { "turnaround", &g_lat_turn },
+    };
+    for (const auto &r : rows) {
+        if (r.st->n == 0) continue;
+        vpi_msg("%-20s %10.1f %12.1f %10.1f %12.1f\n", r.name,
+                (double)r.st->sum_ns / (double)r.st->n / 1e3, r.st->pct_us(0.50), r.st->pct_us(0.99),
+                (double)r.st->max_ns / 1e3);
+    }
+    const double span_s = (double)(g_lat_last_ns - g_lat_first_ns) / 1e9;
+    vpi_msg("Throughput: %.0f commands/s over %.3f s, simulation thread busy %.1f%% (%s)\n",
+            span_s > 0.0 ? (double)g_lat_eval.n / span_s : 0.0, span_s,
+            span_s > 0.0 ? 100.0 * ((double)g_lat_eval.sum_ns / 1e9) / span_s : 0.0,
+            g_io_thread ? "separate I/O thread" : "single thread");
+}
+
+static void shutdown_model() {
+    if (g_ckpt_fp) ckpt_close();
+    if (g_rec_fp) fclose(g_rec_fp);
+    if (g_tfp) {
+        g_tfp->flush();
+        g_tfp->close();
+        delete g_tfp;
+    }
+    g_dut->final();
+    delete g_dut;
+}
+
+// ─── Model instance ──────────────────────────────────────────────────────────
+// Build, reset and serve one model on the calling thread: the replayed
+// session, or the connection accepted on its port.  instance < 0 is the
+// single-model server; otherwise messages, log events and the trace file
+// carry the instance number and the port is --port + instance.
+static int serve(int instance, int argc, char **argv) {
+    g_instance     = instance;
+    g_clks_per_vpi = g_clks_per_vpi_opt;
+    const int port = g_vpi_port + (instance < 0 ? 0 : instance);
+    if (instance >= 0) {
+        cjtag_log_set_thread(&g_sim_time, instance);
+        g_ber_rng ^= (uint64_t)(instance + 1) * 0xD1B54A32D192ED03ULL;  // independent error patterns
+    }
 
     // Create Verilator context
     const std::unique_ptr<VerilatedContext> contextp{new VerilatedContext};
@@ -219,30 +1511,45 @@ int main(int argc, char **argv) {
 
     // Optional tracing
     if (g_trace_enabled) {
+        const std::string fst = instance < 0 ? "cjtag_vpi.fst" : "cjtag_vpi." + std::to_string(instance) + ".fst";
         g_tfp = new VerilatedFstC;
         g_dut->trace(g_tfp, 99);
-        g_tfp->open("cjtag_vpi.fst");
-        fprintf(stderr, "[VPI] FST tracing enabled → cjtag_vpi.fst\n");
+        g_tfp->open(fst.c_str());
+        vpi_msg("FST tracing enabled → %s\n", fst.c_str());
     }
 
-    // Signal handling
-    signal(SIGINT, sig_handler);
-    signal(SIGTERM, sig_handler);
-
     // Reset
     g_dut->ntrst_i = 0;
     g_dut->tckc_i = 0;
     g_dut->tmsc_i = 0;
+    g_dut->jtag_sel_i = g_jtag_mode ? 1 : 0;
+    g_dut->jtag_tck_i = 0;
+    g_dut->jtag_tms_i = 1;
+    g_dut->jtag_tdi_i = 0;
     run_clocks(20);
     g_dut->ntrst_i = 1;
     run_clocks(g_boot_clks);
 
-    fprintf(stderr, "[VPI] Reset complete, starting VPI server on port %d\n", g_vpi_port);
+    if (g_replay_path) {
+        uint64_t mismatches = 0;
+        const int64_t n = replay_session(g_replay_path, &mismatches);
+        if (n >= 0) {
+            print_summary((uint64_t)n);
+            vpi_msg("Replay: %llu responses differ from recording\n", (unsigned long long)mismatches);
+        }
+        shutdown_model();
+        return n < 0 ? 1 : 0;
+    }
+
+    vpi_msg("Reset complete, starting VPI server on port %d (%s mode%s)\n", port,
+            g_jtag_mode ? "JTAG direct" : "cJTAG",
+            g_bitbang == BITBANG_JTAG ? ", remote_bitbang" : g_bitbang == BITBANG_RAW ? ", remote_bitbang raw"
+            : g_xvc ? ", XVC" : "");
 
     // Create TCP server
     int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd < 0) {
-        fprintf(stderr, "[VPI] socket() failed: %s\n", strerror(errno));
+        vpi_msg("socket() failed: %s\n", strerror(errno));
         return 1;
     }
 
@@ -253,70 +1560,253 @@ int main(int argc, char **argv) {
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(g_vpi_port);
+    addr.sin_port = htons(port);
 
     if (bind(server_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        fprintf(stderr, "[VPI] bind() failed: %s\n", strerror(errno));
+        vpi_msg("bind() failed: %s\n", strerror(errno));
         close(server_fd);
         return 1;
     }
 
     if (listen(server_fd, 1) < 0) {
-        fprintf(stderr, "[VPI] listen() failed: %s\n", strerror(errno));
+        vpi_msg("listen() failed: %s\n", strerror(errno));
         close(server_fd);
         return 1;
     }
 
-    fprintf(stderr, "[VPI] Listening on port %d, waiting for OpenOCD...\n", g_vpi_port);
+    vpi_msg("Listening on port %d, waiting for OpenOCD...\n", port);
+
+    // Wait for the connection in 100 ms slices: SIGINT/SIGTERM may land on
+    // another thread (--instances) and accept() restarts after a signal
+    struct pollfd lfd = { server_fd, POLLIN, 0 };
+    while (!aborted() && poll(&lfd, 1, 100) <= 0) {}
+    if (aborted()) {
+        vpi_msg("Interrupted while waiting for OpenOCD\n");
+        close(server_fd);
+        shutdown_model();
+        return 0;
+    }
 
-    // Accept connection (blocking)
     int client_fd = accept(server_fd, nullptr, nullptr);
     if (client_fd < 0) {
-        fprintf(stderr, "[VPI] accept() failed: %s\n", strerror(errno));
+        vpi_msg("accept() failed: %s\n", strerror(errno));
         close(server_fd);
         return 1;
     }
 
-    fprintf(stderr, "[VPI] Client connected\n");
+    vpi_msg("Client connected\n");
+
+    if (g_bitbang != BITBANG_OFF || g_xvc) {
+        // 'R' answers and XVC replies are small; do not hold them back
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    }
+
+    if (g_record_path && (!record_open(g_record_path) || (g_ckpt_every && !ckpt_open(g_record_path)))) {
+        close(client_fd);
+        close(server_fd);
+        return 1;
+    }
+
+    if (g_rt_ratio > 0.0) {
+        vpi_msg("Real-time pacing: %g simulated s per wall s\n", g_rt_ratio);
+        rt_start();
+    }
 
     // Main VPI command loop
     uint64_t cmd_count = 0;
     bool running = true;
 
-    while (running && !g_abort && (g_max_cycles == 0 || g_cycle < g_max_cycles)) {
-        fd_set rfds;
-        FD_ZERO(&rfds);
-        FD_SET(client_fd, &rfds);
-        struct timeval tv = { 0, 1000 }; // 1 ms
-
-        int ready = select(client_fd + 1, &rfds, nullptr, nullptr, &tv);
-        if (ready > 0) {
-            struct vpi_cmd cmd;
-            if (!recv_exact(client_fd, &cmd, sizeof(cmd))) {
-                fprintf(stderr, "[VPI] Connection closed by OpenOCD\n");
+    io_channel  io;
+    std::thread io_thread;
+    if (g_io_thread) {
+        if (pipe(io.wake) != 0) {
+            vpi_msg("pipe() failed: %s\n", strerror(errno));
+            close(client_fd);
+            close(server_fd);
+            return 1;
+        }
+        fcntl(io.wake[0], F_SETFL, O_NONBLOCK);
+        fcntl(io.wake[1], F_SETFL, O_NONBLOCK);
+        g_io      = &io;
+        io_thread = std::thread(io_thread_main, client_fd, &io);
+        vpi_msg("Socket I/O on a separate thread\n");
+    }
+
+    while (running && !aborted() && (g_max_cycles == 0 || g_cycle < g_max_cycles)) {
+        bool behind = false;
+        if (g_rt_ratio > 0.0) {
+            rt_throttle();
+            behind = rt_lead_ns() < 0;  // behind: poll, then catch up
+        }
+
+        bool got_cmd = false;
+        if (g_io_thread) {
+            if (io_msg *m = io_next_cmd(behind ? 0 : 1000000ULL)) {
+                running = dispatch_cmd(IO_QUEUE_FD, &m->cmd, m->rx_ns);
+                g_io->rxq.pop();
+                ++cmd_count;
+                got_cmd = true;
+            } else if (g_io->closed.load(std::memory_order_acquire)) {
+                vpi_msg("Connection closed by OpenOCD\n");
                 break;
             }
-            running = process_vpi_cmd(client_fd, &cmd);
-            ++cmd_count;
-        } else if (ready == 0) {
-            // Timeout: advance idle clocks
-            run_clocks(g_idle_clks);
+        } else {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(client_fd, &rfds);
+            struct timeval tv = { 0, behind ? 0 : 1000 }; // 1 ms
+
+            int ready = select(client_fd + 1, &rfds, nullptr, nullptr, &tv);
+            if (ready > 0 && g_bitbang != BITBANG_OFF) {
+                running = bitbang_batch(client_fd);
+                ++cmd_count;
+            } else if (ready > 0 && g_xvc) {
+                running = xvc_command(client_fd);
+                ++cmd_count;
+            } else if (ready > 0) {
+                struct vpi_cmd cmd;
+                if (!recv_exact(client_fd, &cmd, sizeof(cmd))) {
+                    vpi_msg("Connection closed by OpenOCD\n");
+                    break;
+                }
+                running = dispatch_cmd(client_fd, &cmd, wall_ns());
+                ++cmd_count;
+            }
+            got_cmd = ready != 0;
+        }
+        if (!got_cmd) {
+            // Timeout: advance idle clocks (paced to the wall clock if enabled)
+            if (g_rt_ratio > 0.0) {
+                rt_catch_up();
+            } else {
+                run_clocks(g_idle_clks);
+            }
+        }
+        if (g_log_dump_req.exchange(false, std::memory_order_relaxed)) {
+            cjtag_log_dump_tail(stderr);
         }
     }
+    if (io_thread.joinable()) {
+        // Unblock a half-received command; queued responses are still sent
+        io.stop.store(true, std::memory_order_release);
+        shutdown(client_fd, SHUT_RD);
+        const char b = 1;
+        if (write(io.wake[1], &b, 1) < 0) {}
+        io_thread.join();
+        g_lat_turn.merge(io.lat_turn);
+        close(io.wake[0]);
+        close(io.wake[1]);
+    }
+    if (aborted() && g_instance < 0) cjtag_log_dump_tail(stderr);
 
-    fprintf(stderr, "[VPI] Done: %llu commands, %llu cycles\n",
-            (unsigned long long)cmd_count, (unsigned long long)g_cycle);
+    print_summary(cmd_count);
 
     // Cleanup
     close(client_fd);
     close(server_fd);
-    if (g_tfp) {
-        g_tfp->flush();
-        g_tfp->close();
-        delete g_tfp;
-    }
-    g_dut->final();
-    delete g_dut;
+    shutdown_model();
 
     return 0;
 }
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+int main(int argc, char **argv) {
+    // Parse arguments
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            g_vpi_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            g_trace_enabled = true;
+        } else if (strcmp(argv[i], "--max-cycles") == 0 && i + 1 < argc) {
+            g_max_cycles = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--clks-per-vpi") == 0 && i + 1 < argc) {
+            g_clks_per_vpi_opt = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jtag") == 0) {
+            g_jtag_mode = true;
+        } else if (strcmp(argv[i], "--rtck") == 0) {
+            g_rtck_mode = true;
+        } else if (strcmp(argv[i], "--realtime") == 0 && i + 1 < argc) {
+            g_rt_ratio = strtod(argv[++i], nullptr);
+            if (g_rt_ratio <= 0.0) {
+                vpi_msg("--realtime expects a positive ratio\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            g_record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            g_replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            g_ckpt_every = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            char *end = nullptr;
+            g_seek_cycle = strtoull(argv[++i], &end, 10);
+            if (*end == '+') g_seek_span = strtoull(end + 1, nullptr, 10);
+        } else if (strcmp(argv[i], "--io-thread") == 0) {
+            g_io_thread = true;
+        } else if (strcmp(argv[i], "--bitbang") == 0) {
+            g_bitbang = BITBANG_JTAG;
+        } else if (strcmp(argv[i], "--bitbang-raw") == 0) {
+            g_bitbang = BITBANG_RAW;
+        } else if (strcmp(argv[i], "--xvc") == 0) {
+            g_xvc = true;
+        } else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            g_instances = atoi(argv[++i]);
+            if (g_instances < 1) {
+                vpi_msg("--instances expects a positive count\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--tmsc-ber") == 0 && i + 1 < argc) {
+            g_tmsc_ber = strtod(argv[++i], nullptr);
+            if (g_tmsc_ber < 0.0 || g_tmsc_ber >= 1.0) {
+                vpi_msg("--tmsc-ber expects a probability in [0, 1)\n");
+                return 1;
+            }
+        }
+    }
+    if ((g_bitbang != BITBANG_OFF || g_xvc) && (g_io_thread || g_record_path || g_replay_path)) {
+        vpi_msg("--bitbang/--xvc cannot be combined with --io-thread, --record or --replay\n");
+        return 1;
+    }
+    if (g_ckpt_every && !g_record_path) {
+        vpi_msg("--checkpoint-every needs --record\n");
+        return 1;
+    }
+    if (g_seek_cycle && !g_replay_path) {
+        vpi_msg("--seek needs --replay\n");
+        return 1;
+    }
+    g_trace_from = g_seek_cycle;
+    if (g_bitbang != BITBANG_OFF && g_xvc) {
+        vpi_msg("Choose one of --bitbang and --xvc\n");
+        return 1;
+    }
+    if (g_bitbang == BITBANG_RAW && g_jtag_mode) {
+        vpi_msg("--bitbang-raw drives the cJTAG link; use --bitbang with --jtag\n");
+        return 1;
+    }
+    if (g_instances > 1 && (g_record_path || g_replay_path)) {
+        vpi_msg("--record and --replay serve a single model; drop --instances\n");
+        return 1;
+    }
+    cjtag_log_init(argc, argv);
+    cjtag_log_set_clock(&g_sim_time);
+    vpi_log_register();
+
+    // Signal handling (shared by all instances)
+    signal(SIGINT, sig_handler);
+    signal(SIGTERM, sig_handler);
+    signal(SIGUSR1, sig_log_dump);
+
+    if (g_instances == 1) return serve(-1, argc, argv);
+
+    // One thread per model; instance i listens on --port + i
+    vpi_msg("Serving %d models on ports %d-%d\n", g_instances, g_vpi_port, g_vpi_port + g_instances - 1);
+    std::vector<int>         status(g_instances, 0);
+    std::vector<std::thread> models;
+    for (int i = 0; i < g_instances; ++i) {
+        models.emplace_back([&status, i, argc, argv] { status[i] = serve(i, argc, argv); });
+    }
+    for (std::thread &t : models) t.join();
+    if (aborted()) cjtag_log_dump_tail(stderr);
+    return std::any_of(status.begin(), status.end(), [](int rc) { return rc != 0; }) ? 1 : 0;
+}
@@ -5,44 +5,65 @@
 // =============================================================================
 
 #include "Vtop.h"
+#include "cjtag_log.h"
+#include "cjtag_probe.h"
+#include "link_ref.h"
 #include "verilated.h"
 #include "verilated_fst_c.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <string>
+#include <vector>
 
 int test_no = 0;
 // Test framework macros
 #define TEST_CASE(name) void test_##name(TestHarness& tb)
+// A failed assertion ends the test, not the suite: RUN_TEST records it and
+// re-runs the test alone with tracing (see rerun_traced()).
 #define RUN_TEST(name) do { \
     printf("Running test: %02d. %s ... ", ++test_no, #name); \
     fflush(stdout); \
-    g_tb->reset(); \
-    test_##name(*g_tb); \
-    printf("PASS\n"); \
-    tests_passed++; \
+    const vluint64_t start_time = g_tb->time; \
+    try { \
+        g_tb->reset(); \
+        test_##name(*g_tb); \
+        printf("PASS\n"); \
+        tests_passed++; \
+    } catch (const TestFailure& f) { \
+        test_failed(#name, test_##name, start_time, f.msg); \
+    } \
 } while(0)
 
 #define ASSERT_EQ(actual, expected, msg) do { \
     if ((actual) != (expected)) { \
-        printf("\nFAIL: %s\n", msg); \
-        printf("  Expected: %d (0x%x)\n", (int)(expected), (int)(expected)); \
-        printf("  Actual:   %d (0x%x)\n", (int)(actual), (int)(actual)); \
-        cleanup_and_exit(1); \
+        if (!g_rerun) { \
+            printf("\nFAIL: %s\n", msg); \
+            printf("  Expected: %d (0x%x)\n", (int)(expected), (int)(expected)); \
+            printf("  Actual:   %d (0x%x)\n", (int)(actual), (int)(actual)); \
+        } \
+        fail_test(msg); \
     } \
 } while(0)
 
 #define ASSERT_TRUE(condition, msg) do { \
     if (!(condition)) { \
-        printf("\nFAIL: %s\n", msg); \
-        cleanup_and_exit(1); \
+        if (!g_rerun) printf("\nFAIL: %s\n", msg); \
+        fail_test(msg); \
     } \
 } while(0)
 
 // Forward declarations
 class TestHarness;
-void cleanup_and_exit(int code);
+
+struct TestFailure {
+    const char* msg;
+};
+
+static bool g_rerun = false;  // traced re-run of a failed test in progress
+
+[[noreturn]] static void fail_test(const char* msg) { throw TestFailure{ msg }; }
 
 // Global test statistics
 static int tests_passed = 0;
@@ -57,15 +78,20 @@ public:
     bool trace_enabled;
     bool clk_state;
 
-    TestHarness(bool enable_trace = false) : time(0), trace_enabled(enable_trace), clk_state(false) {
-        dut = new Vtop;
+    // contextp: own simulation context (the traced re-run of a failed test
+    // runs beside the suite's model); nullptr uses the default one.
+    TestHarness(bool enable_trace = false, const char* trace_path = "cjtag.fst",
+                VerilatedContext* contextp = nullptr)
+        : time(0), trace_enabled(enable_trace), clk_state(false) {
+        if (contextp) contextp->traceEverOn(trace_enabled);
+        dut = contextp ? new Vtop{contextp, "TOP"} : new Vtop;
         tfp = nullptr;
 
         if (trace_enabled) {
             Verilated::traceEverOn(true);
             tfp = new VerilatedFstC;
             dut->trace(tfp, 99);
-            tfp->open("cjtag.fst");
+            tfp->open(trace_path);
         }
 
         reset();
@@ -85,6 +111,12 @@ public:
         dut->tckc_i = 0;
         dut->tmsc_i = 1;
 
+        // Route the TAP through the bridge (direct 4-wire path idle)
+        dut->jtag_sel_i = 0;
+        dut->jtag_tck_i = 0;
+        dut->jtag_tms_i = 1;
+        dut->jtag_tdi_i = 0;
+
         // Run system clock during reset
         for (int i = 0; i < 100; i++) {
             tick();
@@ -168,17 +200,22 @@ public:
         }
     }
 
-    void send_oac_sequence() {
+    void send_oac_sequence(int ec_val = 0x8) {
         // Full 12-bit activation packet per IEEE 1149.7:
         // OAC (4 bits) + EC (4 bits) + CP (4 bits) - all LSB first
         // OAC = 1100 (LSB first: 0,0,1,1)  - TAP.7 star-2 topology
         // EC  = 1000 (LSB first: 0,0,0,1)  - Short format via RTI
+        //       (0x9 additionally enables the bridge's vendor frames)
         // CP  = calculated parity (XOR of OAC and EC bit-wise)
 
         int oac[4] = {0, 0, 1, 1};  // OAC: 1100 LSB first
-        int ec[4]  = {0, 0, 0, 1};  // EC: 1000 LSB first
+        int ec[4];                  // EC: ec_val LSB first
         int cp[4];                  // CP: calculated
 
+        for (int i = 0; i < 4; i++) {
+            ec[i] = (ec_val >> i) & 1;
+        }
+
         // Calculate CP: CP[i] = OAC[i] XOR EC[i]
         for (int i = 0; i < 4; i++) {
             cp[i] = oac[i] ^ ec[i];
@@ -230,6 +267,168 @@ public:
             tick();
         }
     }
+
+    template <typename Pred>
+    bool wait_until(Pred pred, int max_ticks) {
+        // Event-driven wait: tick until pred() holds (e.g. an internal probe
+        // reaches a value) instead of padding a fixed number of cycles.
+        for (int i = 0; i < max_ticks; i++) {
+            if (pred()) {
+                return true;
+            }
+            tick();
+        }
+        return pred();
+    }
+
+    bool tckc_edge_rtck(int tckc_val, int tmsc_val) {
+        // Adaptive clocking: drive one TCKC edge and wait only until the
+        // bridge echoes it on rtck_o (edge fully processed, TCK issued).
+        dut->tckc_i = tckc_val;
+        dut->tmsc_i = tmsc_val;
+        return wait_until([&] { return dut->rtck_o == tckc_val; }, 40);
+    }
+
+    bool send_oscan1_packet_rtck(int tdi, int tms, int* tdo_out) {
+        // Same 3-slot packet as send_oscan1_packet(), paced by rtck_o
+        bool ok = true;
+        ok &= tckc_edge_rtck(0, !tdi);  // nTDI
+        ok &= tckc_edge_rtck(1, !tdi);
+        ok &= tckc_edge_rtck(0, tms);   // TMS
+        ok &= tckc_edge_rtck(1, tms);
+        ok &= tckc_edge_rtck(0, 0);     // TDO slot: TCK has risen, window open
+        if (tdo_out) {
+            *tdo_out = dut->tmsc_o;
+        }
+        ok &= tckc_edge_rtck(1, 0);     // TCK has fallen
+        return ok;
+    }
+
+    uint64_t send_vendor_frame(int opcode, int resp_bits) {
+        // Vendor frame (EC=0x9 activation only), from a packet boundary:
+        // 2 TMSC toggles while TCKC stays high, the opcode LSB first, then
+        // resp_bits driven by the bridge from each TCKC falling edge.  The
+        // frame is padded to a whole number of 3-bit packets.
+        dut->tmsc_i = !dut->tmsc_i;
+        for (int i = 0; i < 10; i++) tick();
+        dut->tmsc_i = !dut->tmsc_i;
+        for (int i = 0; i < 10; i++) tick();
+
+        const int frame = (8 + resp_bits + 2) / 3 * 3;
+        uint64_t resp = 0;
+        for (int i = 0; i < frame; i++) {
+            dut->tckc_i = 0;
+            dut->tmsc_i = (i < 8) ? (opcode >> i) & 1 : 0;
+            for (int t = 0; t < 10; t++) tick();
+            if (i >= 8 && i < 8 + resp_bits) {
+                resp |= (uint64_t)(dut->tmsc_o & 1) << (i - 8);
+            }
+            dut->tckc_i = 1;
+            for (int t = 0; t < 10; t++) tick();
+        }
+        return resp;
+    }
+
+    bool send_verify_packet(int tdi, int tms, int exp, int mask) {
+        // Verify packet (after VCMD_VERIFY_ON): nTDI and TMS as usual, then
+        // the host drives the expected TDO in the slot where TCK rises and
+        // the mask bit in a fourth slot.  Returns true if the bridge left
+        // TMSC to the host throughout the EXP slot.
+        tckc_cycle(!tdi);
+        tckc_cycle(tms);
+        dut->tckc_i = 0;
+        dut->tmsc_i = exp;
+        bool host_owned = true;
+        for (int i = 0; i < 20; i++) {
+            tick();
+            host_owned &= dut->tmsc_oen == 1;
+        }
+        dut->tckc_i = 1;
+        for (int i = 0; i < 10; i++) tick();
+        tckc_cycle(mask);
+        return host_owned;
+    }
+
+    uint64_t send_poll_frame(uint32_t mask, uint32_t match, int offset, int interval, int limit,
+                             int* tck_pulses = nullptr) {
+        // POLL vendor frame (EC=0x9 activation only), paced like
+        // send_vendor_frame(): opcode 0x04, 88 operand bits {limit, interval,
+        // offset, match, mask} LSB first, then TCKC stays high until rtck_o
+        // shows the engine is done, then the 40 response bits {scans[7:0],
+        // TDO window[31:0]}.  tck_pulses counts the TCKs the engine issued.
+        dut->tmsc_i = !dut->tmsc_i;
+        for (int i = 0; i < 10; i++) tick();
+        dut->tmsc_i = !dut->tmsc_i;
+        for (int i = 0; i < 10; i++) tick();
+
+        uint8_t arg[96];
+        for (int i = 0; i < 96; i++) {
+            arg[i] = i < 8    ? (0x04 >> i) & 1
+                   : i < 40 ? (mask >> (i - 8)) & 1
+                   : i < 72 ? (match >> (i - 40)) & 1
+                   : i < 80 ? (offset >> (i - 72)) & 1
+                   : i < 88 ? (interval >> (i - 80)) & 1
+                            : (limit >> (i - 88)) & 1;
+        }
+        uint64_t resp = 0;
+        int pulses = 0, tck_prev = dut->tck_o;
+        for (int i = 0; i < 138; i++) {
+            dut->tckc_i = 0;
+            dut->tmsc_i = (i < 96) ? arg[i] : 0;
+            for (int t = 0; t < 10; t++) tick();
+            if (i >= 96 && i < 136) {
+                resp |= (uint64_t)(dut->tmsc_o & 1) << (i - 96);
+            }
+            dut->tckc_i = 1;
+            if (i == 95) {
+                wait_until([&] {
+                    pulses += dut->tck_o && !tck_prev;
+                    tck_prev = dut->tck_o;
+                    return dut->rtck_o == 1;
+                }, 40000);
+            }
+            for (int t = 0; t < 10; t++) tick();
+        }
+        if (tck_pulses) *tck_pulses = pulses;
+        return resp;
+    }
+
+    void send_goto_frame(int target) {
+        // TAP navigation frame (EC=0x9 activation only), from a packet
+        // boundary: 3 TMSC toggles while TCKC stays high, then 2 packets
+        // carrying the target TAP state LSB first in frame bits 0, 2, 3, 5
+        // (both TMS slots 0).  TCKC then stays high for the walk: at most
+        // 8 TCK pulses of 2 clk_i each, done 18 clk_i after the last edge.
+        for (int i = 0; i < 3; i++) {
+            dut->tmsc_i = !dut->tmsc_i;
+            for (int t = 0; t < 10; t++) tick();
+        }
+        static const int frame_bit[6] = {0, -1, 1, 2, -1, 3};
+        for (int i = 0; i < 6; i++) {
+            tckc_cycle(frame_bit[i] < 0 ? 0 : (target >> frame_bit[i]) & 1);
+        }
+        for (int t = 0; t < 36; t++) tick();
+    }
+
+    int jtag_clock_bit(int tms, int tdi) {
+        // Direct 4-wire path (requires dut->jtag_sel_i = 1).
+        // TCK low: drive TMS/TDI and let the TAP negedge update tdo_o,
+        // sample TDO, then raise TCK so the TAP shifts on the rising edge.
+        dut->jtag_tck_i = 0;
+        dut->jtag_tms_i = tms;
+        dut->jtag_tdi_i = tdi;
+        for (int i = 0; i < 10; i++) {
+            tick();
+        }
+        int tdo = dut->tdo_o;
+
+        dut->jtag_tck_i = 1;
+        for (int i = 0; i < 10; i++) {
+            tick();
+        }
+        dut->jtag_tck_i = 0;
+        return tdo;
+    }
 };
 
 // Verilator time callback - required for $time in SystemVerilog
@@ -237,13 +436,52 @@ double sc_time_stamp() {
     return g_tb ? g_tb->time : 0;
 }
 
-// Cleanup function implementation
-void cleanup_and_exit(int code) {
-    if (g_tb) {
-        delete g_tb;
-        g_tb = nullptr;
+// ─── Failed tests ────────────────────────────────────────────────────────────
+// The suite runs untraced.  A failed test is re-run on its own from its
+// starting point with FST tracing into <test>.fst: a fresh model in its own
+// context, its clock set to the failed run's start time so the waveform and
+// the dumped log line up, then the same reset and test body.  Only state
+// that survives reset() could differ, so the re-run reports whether the
+// failure reproduced.  With --trace the whole run is already traced and
+// nothing is re-run.
+static bool                     g_trace_all = false;
+static std::vector<std::string> g_failed;  // "name (waveform)" per failed test
+
+static bool rerun_traced(const char* name, void (*test)(TestHarness&), vluint64_t start_time,
+                         const char* first_msg) {
+    const std::string fst = std::string(name) + ".fst";
+    TestHarness* const suite = g_tb;
+    bool reproduced = false;
+    {
+        VerilatedContext ctx;
+        TestHarness rerun(true, fst.c_str(), &ctx);
+        if (rerun.time < start_time) rerun.time = start_time;
+        g_tb    = &rerun;  // sc_time_stamp()
+        g_rerun = true;
+        cjtag_log_set_clock(&rerun.time);
+        try {
+            rerun.reset();
+            test(rerun);
+        } catch (const TestFailure& f) {
+            reproduced = strcmp(f.msg, first_msg) == 0;
+        }
+        g_rerun = false;
+        g_tb    = suite;
+        cjtag_log_set_clock(&suite->time);
+    }
+    return reproduced;
+}
+
+static void test_failed(const char* name, void (*test)(TestHarness&), vluint64_t start_time, const char* msg) {
+    // The assertion has been printed; its log tail goes with it
+    cjtag_log_dump_tail(stdout);
+    std::string wave = "cjtag.fst";
+    if (!g_trace_all) {
+        wave = std::string(name) + ".fst";
+        if (!rerun_traced(name, test, start_time, msg)) wave += ", failure did not reproduce";
     }
-    exit(code);
+    printf("  Waveform: %s\n", wave.c_str());
+    g_failed.push_back(std::string(name) + " (" + wave + ")");
 }
 
 // =============================================================================
@@ -1642,15 +1880,18 @@ TEST_CASE(oscan1_bit_position_tracking) {
 
     tb.send_escape_sequence(6);
     tb.send_oac_sequence();
-    for (int i = 0; i < 50; i++) tb.tick();
+    ASSERT_TRUE(tb.wait_until([&] { return probe_bridge_state(tb.dut) == BRIDGE_OSCAN1; }, 50),
+                "Bridge should enter OSCAN1 after OAC");
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Packet should start at bit_pos 0");
 
-    // Send multiple packets and verify consistent operation
+    // Each TCKC rising edge advances bit_pos; check every slot of 20 packets
     for (int pkt = 0; pkt < 20; pkt++) {
-        int tdo = 0;
-        tb.send_oscan1_packet(pkt & 1, (pkt >> 1) & 1, &tdo);
-
-        // No assertion needed - if bit_pos tracking fails, packets will fail
-        // The fact that we can send 20 packets successfully validates tracking
+        tb.tckc_cycle(!(pkt & 1));          // nTDI slot
+        ASSERT_EQ(probe_bit_pos(tb.dut), 1, "bit_pos should be 1 after nTDI");
+        tb.tckc_cycle((pkt >> 1) & 1);      // TMS slot
+        ASSERT_EQ(probe_bit_pos(tb.dut), 2, "bit_pos should be 2 after TMS");
+        tb.tckc_cycle(0);                   // TDO slot
+        ASSERT_EQ(probe_bit_pos(tb.dut), 0, "bit_pos should wrap to 0 after TDO");
     }
 
     ASSERT_EQ(tb.dut->online_o, 1, "Should remain online after many packets");
@@ -3056,10 +3297,10 @@ TEST_CASE(cp_validation_all_bits_correct) {
     ASSERT_EQ(tb.dut->online_o, 1, "Correct CP parity should activate");
 }
 
-// DISABLED: CP validation no longer enforced for ftdi.c compatibility
-// ftdi.c sends CP=0x0 (incorrect), but real ARM hardware accepts it.
-// Our bridge now accepts any CP value while still validating OAC and EC.
-#if 0
+// Strict CP only (make test-strict-cp): ftdi.c sends CP=0x0 (incorrect), but
+// real ARM hardware accepts it, so the default bridge accepts any CP value
+// while still validating OAC and EC.
+#ifdef CJTAG_STRICT_CP_CHECK
 TEST_CASE(cp_validation_single_bit_errors) {
     // Test CP validation rejects single-bit errors in CP field
 
@@ -3107,8 +3348,8 @@ TEST_CASE(cp_validation_single_bit_errors) {
 }
 #endif
 
-// DISABLED: CP validation no longer enforced for ftdi.c compatibility
-#if 0
+// Strict CP only (make test-strict-cp)
+#ifdef CJTAG_STRICT_CP_CHECK
 TEST_CASE(cp_validation_multiple_bit_errors) {
     // Test CP validation rejects multiple-bit errors
 
@@ -3147,8 +3388,8 @@ TEST_CASE(cp_validation_with_wrong_ec) {
     ASSERT_EQ(tb.dut->online_o, 0, "Wrong EC should reject even with valid CP for that EC");
 }
 
-// DISABLED: CP validation no longer enforced for ftdi.c compatibility
-#if 0
+// Strict CP only (make test-strict-cp)
+#ifdef CJTAG_STRICT_CP_CHECK
 TEST_CASE(cp_validation_all_zeros) {
     // Test CP = 0000 (all zeros) - should fail since correct CP is 0010
 
@@ -3207,8 +3448,8 @@ TEST_CASE(cp_xor_calculation_verification) {
     ASSERT_EQ(tb.dut->online_o, 1, "Correctly calculated CP should activate");
 }
 
-// DISABLED: CP validation no longer enforced for ftdi.c compatibility
-#if 0
+// Strict CP only (make test-strict-cp)
+#ifdef CJTAG_STRICT_CP_CHECK
 TEST_CASE(cp_validation_stress_test) {
     // Stress test: Try many invalid CP values rapidly
 
@@ -4419,6 +4660,772 @@ TEST_CASE(dmi_stress_test_100_operations) {
     // Test passes if no crashes occur
 }
 
+// =============================================================================
+// Internal-State Probes (cjtag_probe.h)
+// =============================================================================
+
+TEST_CASE(probe_escape_toggle_count) {
+    // tmsc_toggle_count should count each TMSC edge while TCKC is high
+    tb.dut->tckc_i = 0;
+    for (int i = 0; i < 10; i++) tb.tick();
+    tb.dut->tckc_i = 1;
+    for (int i = 0; i < 10; i++) tb.tick();
+    ASSERT_EQ(probe_tmsc_toggle_count(tb.dut), 0, "Toggle count should clear on TCKC rise");
+    for (int n = 1; n <= 6; n++) {
+        tb.dut->tmsc_i = !tb.dut->tmsc_i;
+        ASSERT_TRUE(tb.wait_until([&] { return probe_tmsc_toggle_count(tb.dut) == n; }, 20),
+                    "Each TMSC toggle should be counted");
+    }
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OFFLINE, "Escape is evaluated only on TCKC fall");
+
+    tb.dut->tckc_i = 0;
+    ASSERT_TRUE(tb.wait_until([&] { return probe_bridge_state(tb.dut) == BRIDGE_ONLINE_ACT; }, 40),
+                "6 toggles should select ONLINE_ACT");
+}
+
+TEST_CASE(probe_activation_count_and_tap_ir) {
+    tb.send_escape_sequence(6);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_ONLINE_ACT, "Should be in ONLINE_ACT");
+
+    // activation_count advances once per OAC/EC/CP bit
+    const int packet[12] = {0, 0, 1, 1, 0, 0, 0, 1, 0, 0, 1, 0};
+    for (int i = 0; i < 11; i++) {
+        tb.tckc_cycle(packet[i]);
+        ASSERT_EQ(probe_activation_count(tb.dut), i + 1, "activation_count should track OAC bits");
+    }
+    tb.tckc_cycle(packet[11]);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "12th bit should complete activation");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_TEST_LOGIC_RESET, "TAP should be in reset");
+    ASSERT_EQ(probe_ir_reg(tb.dut), 0x01, "IR should hold IDCODE after reset");
+
+    // Load DTMCS (0x10) and watch the TAP walk the IR path
+    tb.send_oscan1_packet(0, 0, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "TMS=0 -> RUN_TEST_IDLE");
+    tb.send_oscan1_packet(0, 1, nullptr);
+    tb.send_oscan1_packet(0, 1, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_SELECT_IR_SCAN, "TMS=1,1 -> SELECT_IR_SCAN");
+    tb.send_oscan1_packet(0, 0, nullptr);
+    tb.send_oscan1_packet(0, 0, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_SHIFT_IR, "TMS=0,0 -> SHIFT_IR");
+    for (int i = 0; i < 5; i++) {
+        tb.send_oscan1_packet((0x10 >> i) & 1, i == 4, nullptr);
+    }
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_EXIT1_IR, "Last IR bit -> EXIT1_IR");
+    tb.send_oscan1_packet(0, 1, nullptr);
+    tb.send_oscan1_packet(0, 0, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "UPDATE_IR -> RUN_TEST_IDLE");
+    ASSERT_EQ(probe_ir_reg(tb.dut), 0x10, "IR should hold DTMCS after UPDATE_IR");
+}
+
+// =============================================================================
+// Adaptive Clocking (RTCK)
+// =============================================================================
+
+TEST_CASE(rtck_follows_tckc_when_offline) {
+    ASSERT_EQ(tb.dut->rtck_o, 0, "RTCK should be low after reset");
+    ASSERT_TRUE(tb.tckc_edge_rtck(1, 1), "RTCK should follow TCKC rise while offline");
+    ASSERT_TRUE(tb.tckc_edge_rtck(0, 1), "RTCK should follow TCKC fall while offline");
+}
+
+TEST_CASE(rtck_paced_idcode_read) {
+    // Read IDCODE pacing every TCKC edge on rtck_o instead of fixed padding
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+    ASSERT_EQ(tb.dut->online_o, 1, "Should be online");
+
+    vluint64_t start = tb.time;
+    bool acked = true;
+    acked &= tb.send_oscan1_packet_rtck(0, 0, nullptr); // -> RUN_TEST_IDLE
+    acked &= tb.send_oscan1_packet_rtck(0, 1, nullptr); // -> SELECT_DR
+    acked &= tb.send_oscan1_packet_rtck(0, 0, nullptr); // -> CAPTURE_DR
+
+    int first_bit = 0;
+    acked &= tb.send_oscan1_packet_rtck(0, 0, &first_bit); // -> SHIFT_DR, reads bit 0
+    uint32_t idcode = first_bit;
+    for (int i = 1; i < 32; i++) {
+        int tdo = 0;
+        acked &= tb.send_oscan1_packet_rtck(0, (i == 31) ? 1 : 0, &tdo);
+        idcode |= (uint32_t)tdo << i;
+    }
+    vluint64_t rtck_ticks = tb.time - start;
+
+    ASSERT_TRUE(acked, "Every TCKC edge should be acknowledged on RTCK");
+    ASSERT_EQ(idcode, 0x1DEAD3FF, "RTCK-paced IDCODE should match");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_EXIT1_DR, "TAP should be in EXIT1_DR");
+    // send_oscan1_packet() pads a fixed 70 ticks per packet; the RTCK-paced
+    // packet must never be slower than that (TDO-slot edges are the longest)
+    ASSERT_TRUE(rtck_ticks < 35u * 70u, "RTCK pacing should beat fixed padding");
+}
+
+// =============================================================================
+// Direct 4-wire JTAG Path (A/B reference for the bridge)
+// =============================================================================
+
+TEST_CASE(direct_jtag_idcode_matches_oscan1) {
+    // Read IDCODE through the direct 4-wire path, then through OScan1, and
+    // check both paths see the same TAP and what each costs in clocks.
+    tb.dut->jtag_sel_i = 1;
+    for (int i = 0; i < 10; i++) tb.tick();
+
+    vluint64_t start = tb.time;
+    tb.jtag_clock_bit(0, 0);  // TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    tb.jtag_clock_bit(1, 0);  // -> SELECT_DR
+    tb.jtag_clock_bit(0, 0);  // -> CAPTURE_DR
+    tb.jtag_clock_bit(0, 0);  // -> SHIFT_DR (IDCODE captured)
+
+    uint32_t idcode_jtag = 0;
+    for (int i = 0; i < 32; i++) {
+        int tms = (i == 31) ? 1 : 0;
+        idcode_jtag |= (uint32_t)tb.jtag_clock_bit(tms, 0) << i;
+    }
+    tb.jtag_clock_bit(1, 0);  // EXIT1_DR -> UPDATE_DR
+    tb.jtag_clock_bit(0, 0);  // UPDATE_DR -> RUN_TEST_IDLE
+    vluint64_t jtag_ticks = tb.time - start;
+
+    ASSERT_EQ(idcode_jtag, 0x1DEAD3FF, "Direct JTAG IDCODE should match");
+    ASSERT_EQ(tb.dut->online_o, 0, "Bridge should stay offline on the direct path");
+
+    // Same read over OScan1 against the same TAP/DTM
+    tb.reset();
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+    for (int i = 0; i < 20; i++) tb.tick();
+
+    start = tb.time;
+    tb.send_oscan1_packet(0, 0, nullptr); // TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+
+    int first_bit = 0;
+    tb.send_oscan1_packet(0, 0, &first_bit); // -> SHIFT_DR, reads bit 0
+    uint32_t idcode_oscan1 = first_bit;
+    for (int i = 1; i < 32; i++) {
+        int tdo = 0;
+        int tms = (i == 31) ? 1 : 0;
+        tb.send_oscan1_packet(0, tms, &tdo);
+        idcode_oscan1 |= (uint32_t)tdo << i;
+    }
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_DR -> UPDATE_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // UPDATE_DR -> RUN_TEST_IDLE
+    vluint64_t oscan1_ticks = tb.time - start;
+
+    ASSERT_EQ(idcode_oscan1, idcode_jtag, "OScan1 and direct JTAG should read the same IDCODE");
+
+    // Direct: 38 TCKs (4 to Shift-DR, 32 bits, 2 back to Idle), one 20-tick
+    // period each.  OScan1: 37 packets, since bit 0 comes with the
+    // Capture -> Shift packet; each is 3 TCKC periods of 20 ticks with the
+    // TDO slot held 10 ticks longer for the turnaround
+    ASSERT_EQ(jtag_ticks, 38 * 20, "Direct JTAG should cost one TCK period per bit");
+    ASSERT_EQ(oscan1_ticks, 37 * (3 * 20 + 10), "OScan1 should cost one 3-slot packet per bit");
+}
+
+// =============================================================================
+// Vendor Frames & Link CRC (EC=0x9)
+// =============================================================================
+
+TEST_CASE(vendor_crc_read_matches_host_crc) {
+    // The bridge's CRCs of received nTDI/TMS bits match the host's, the read
+    // restarts them, and packets continue normally after the frame
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    ASSERT_EQ(tb.dut->online_o, 1, "EC=0x9 should activate OScan1");
+
+    uint16_t crc_tdi = 0xFFFF, crc_tms = 0xFFFF;
+    for (int i = 0; i < 24; i++) {
+        const int tdi = (i * 5 >> 1) & 1;
+        const int tms = (i % 7) == 3;
+        tb.send_oscan1_packet(tdi, tms, nullptr);
+        crc_tdi = link_crc16(crc_tdi, !tdi);
+        crc_tms = link_crc16(crc_tms, tms);
+    }
+    ASSERT_EQ(probe_crc_tdi(tb.dut), crc_tdi, "Bridge nTDI CRC should track the host's");
+
+    const uint32_t resp = tb.send_vendor_frame(0x01, 32);
+    ASSERT_EQ(resp & 0xFFFF, crc_tdi, "CRC_READ should return the nTDI CRC in bits 0-15");
+    ASSERT_EQ(resp >> 16, crc_tms, "CRC_READ should return the TMS CRC in bits 16-31");
+    ASSERT_EQ(probe_crc_tdi(tb.dut), 0xFFFF, "CRC_READ should restart the nTDI CRC");
+    ASSERT_EQ(probe_crc_tms(tb.dut), 0xFFFF, "CRC_READ should restart the TMS CRC");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Frame should return to OSCAN1");
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Frame should end on a packet boundary");
+
+    // IDCODE through the same link after the frame
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet(0, 1, nullptr);  // -> TEST_LOGIC_RESET
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    int first_bit = 0;
+    tb.send_oscan1_packet(0, 0, &first_bit); // -> SHIFT_DR, reads bit 0
+    uint32_t idcode = first_bit;
+    for (int i = 1; i < 32; i++) {
+        int tdo = 0;
+        tb.send_oscan1_packet(0, (i == 31) ? 1 : 0, &tdo);
+        idcode |= (uint32_t)tdo << i;
+    }
+    ASSERT_EQ(idcode, 0x1DEAD3FF, "IDCODE should read correctly after a vendor frame");
+}
+
+TEST_CASE(vendor_crc_detects_corrupted_tdi) {
+    // One nTDI bit flipped on the wire: the TDI CRC differs, the TMS CRC
+    // still matches, so the host knows a re-shift is safe
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    ASSERT_EQ(tb.dut->online_o, 1, "EC=0x9 should activate OScan1");
+
+    uint16_t crc_tdi = 0xFFFF, crc_tms = 0xFFFF;
+    for (int i = 0; i < 16; i++) {
+        const int tdi = i & 1;
+        tb.send_oscan1_packet(i == 9 ? !tdi : tdi, 0, nullptr);  // bit error in packet 9
+        crc_tdi = link_crc16(crc_tdi, !tdi);
+        crc_tms = link_crc16(crc_tms, 0);
+    }
+
+    const uint32_t resp = tb.send_vendor_frame(0x01, 32);
+    ASSERT_TRUE((resp & 0xFFFF) != crc_tdi, "Corrupted nTDI bit should change the TDI CRC");
+    ASSERT_EQ(resp >> 16, crc_tms, "TMS CRC should be unaffected");
+}
+
+TEST_CASE(vendor_frame_ignored_without_ec9) {
+    // With EC=0x8 a 2-toggle escape is not a frame: the bits read as plain
+    // packets, and since opcodes keep every TMS slot clear the TAP only
+    // walks TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+    ASSERT_EQ(tb.dut->online_o, 1, "Should be online");
+
+    bool entered_vcmd = false;
+    tb.dut->tmsc_i = !tb.dut->tmsc_i;
+    for (int i = 0; i < 10; i++) tb.tick();
+    tb.dut->tmsc_i = !tb.dut->tmsc_i;
+    for (int i = 0; i < 10; i++) tb.tick();
+    for (int i = 0; i < 42; i++) {
+        tb.tckc_cycle(i < 8 ? (0x01 >> i) & 1 : 0);
+        entered_vcmd |= probe_bridge_state(tb.dut) == BRIDGE_VCMD;
+    }
+
+    ASSERT_TRUE(!entered_vcmd, "EC=0x8 should never enter VCMD");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Bridge should stay in OSCAN1");
+    ASSERT_EQ(probe_crc_tdi(tb.dut), 0xFFFF, "Link CRC should not run without EC=0x9");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "Missed frame should read as TMS=0 packets");
+}
+
+// =============================================================================
+// Context Retention (EC=0xA / 0xB)
+// =============================================================================
+
+TEST_CASE(context_resume_skips_activation) {
+    // EC=0xA keeps the activation across a deselect; a 7-toggle selection
+    // then lands directly in OSCAN1 and the TAP continues where it was left
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0xA);
+    ASSERT_EQ(tb.dut->online_o, 1, "EC=0xA should activate OScan1");
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+
+    tb.send_escape_sequence(4);
+    ASSERT_EQ(tb.dut->online_o, 0, "Deselection should go offline");
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 1, "EC=0xA deselect should retain the context");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "TAP is not clocked while deselected");
+
+    tb.send_escape_sequence(7);
+    ASSERT_EQ(tb.dut->online_o, 1, "7-toggle selection should resume OScan1");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Resume should skip ONLINE_ACT");
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Resume should start at a packet boundary");
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 0, "Resume should consume the context");
+
+    // IDCODE straight from RUN_TEST_IDLE
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    int first_bit = 0;
+    tb.send_oscan1_packet(0, 0, &first_bit); // -> SHIFT_DR, reads bit 0
+    uint32_t idcode = first_bit;
+    for (int i = 1; i < 32; i++) {
+        int tdo = 0;
+        tb.send_oscan1_packet(0, (i == 31) ? 1 : 0, &tdo);
+        idcode |= (uint32_t)tdo << i;
+    }
+    ASSERT_EQ(idcode, 0x1DEAD3FF, "IDCODE should read correctly after a resume");
+
+    // Retention stays armed: the next switch resumes as well
+    tb.send_escape_sequence(5);
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 1, "Resumed link should retain again on deselect");
+    tb.send_escape_sequence(7);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Second resume should also skip activation");
+}
+
+TEST_CASE(context_not_retained_without_opt_in) {
+    // EC=0x8: a 7-toggle selection after deselect is a normal selection
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+    ASSERT_EQ(tb.dut->online_o, 1, "Should be online");
+
+    tb.send_escape_sequence(4);
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 0, "EC=0x8 should not retain a context");
+    tb.send_escape_sequence(7);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_ONLINE_ACT, "Without retention 7 toggles should select");
+    tb.send_oac_sequence();
+    ASSERT_EQ(tb.dut->online_o, 1, "Full activation should still work");
+}
+
+TEST_CASE(context_discarded_by_reset_and_full_select) {
+    // 6 toggles always mean a full activation; a reset escape drops the context
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0xA);
+    tb.send_escape_sequence(4);
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 1, "Context should be retained");
+    tb.send_escape_sequence(6);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_ONLINE_ACT, "6 toggles should start a full activation");
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 0, "Full selection should discard the context");
+    tb.send_oac_sequence(0xA);
+    ASSERT_EQ(tb.dut->online_o, 1, "Full activation should succeed");
+
+    tb.send_escape_sequence(4);
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 1, "Context should be retained again");
+    tb.send_escape_sequence(8);
+    ASSERT_EQ(probe_ctx_valid(tb.dut), 0, "Reset escape should discard the context");
+    tb.send_escape_sequence(7);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_ONLINE_ACT, "7 toggles after reset should select normally");
+}
+
+TEST_CASE(context_resume_restores_vendor_extensions) {
+    // EC=0xB: the resumed link keeps vendor frames and restarts the link CRC
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0xB);
+    ASSERT_EQ(probe_vext_en(tb.dut), 1, "EC=0xB should enable vendor extensions");
+    tb.send_oscan1_packet(1, 0, nullptr);
+    tb.send_escape_sequence(4);
+    for (int i = 0; i < 10; i++) tb.tick();  // OFFLINE clears vext_en on its first cycle
+    ASSERT_EQ(probe_vext_en(tb.dut), 0, "Vendor extensions are off while offline");
+
+    tb.send_escape_sequence(7);
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Should resume OScan1");
+    ASSERT_EQ(probe_vext_en(tb.dut), 1, "Resume should restore vendor extensions");
+    ASSERT_EQ(probe_crc_tdi(tb.dut), 0xFFFF, "Resume should restart the link CRC");
+    tb.send_oscan1_packet(0, 0, nullptr);
+    ASSERT_EQ(probe_crc_tdi(tb.dut), link_crc16(0xFFFF, 1), "Link CRC should run on the resumed link");
+}
+
+// =============================================================================
+// TAP Navigation (GOTO frames, EC=0x9)
+// =============================================================================
+
+TEST_CASE(goto_mirror_tracks_tap) {
+    // The bridge's TAP mirror follows every TCK it issues, with or without
+    // vendor extensions
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+    ASSERT_EQ(probe_tap_mirror(tb.dut), TAP_TEST_LOGIC_RESET, "Mirror should start in TEST_LOGIC_RESET");
+
+    for (int i = 0; i < 64; i++) {
+        const int tms = ((i * 7) % 5) < 2;
+        tb.send_oscan1_packet(i & 1, tms, nullptr);
+        ASSERT_EQ(probe_tap_mirror(tb.dut), probe_tap_state(tb.dut), "Mirror should match the TAP after each packet");
+    }
+}
+
+TEST_CASE(goto_reaches_every_state) {
+    // Every (from, to) pair: one frame leaves the TAP and the mirror in the
+    // target state and the bridge in OSCAN1 at a packet boundary
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    ASSERT_EQ(tb.dut->online_o, 1, "EC=0x9 should activate OScan1");
+
+    for (int from = 0; from < 16; from++) {
+        for (int to = 0; to < 16; to++) {
+            tb.send_goto_frame(from);
+            ASSERT_EQ(probe_tap_state(tb.dut), from, "GOTO should reach the start state");
+            tb.send_goto_frame(to);
+            ASSERT_EQ(probe_tap_state(tb.dut), to, "GOTO should reach the target state");
+            ASSERT_EQ(probe_tap_mirror(tb.dut), to, "Mirror should agree with the TAP");
+            ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Walk should return to OSCAN1");
+            ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Walk should end on a packet boundary");
+            ASSERT_EQ(tb.dut->tck_o, 0, "TCK should be parked low after the walk");
+        }
+    }
+}
+
+TEST_CASE(goto_idcode_read) {
+    // GOTO Capture-DR, 32 packets, GOTO Run-Test/Idle.  The TDO slot shows
+    // TDO after its packet's TCK rise, so reads start from Capture-DR: the
+    // CAPTURE -> SHIFT packet returns bit 0 as in a hand-clocked scan
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet(0, 1, nullptr);  // IR = IDCODE
+
+    tb.send_goto_frame(TAP_CAPTURE_DR);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_CAPTURE_DR, "GOTO should reach CAPTURE_DR");
+    ASSERT_EQ(probe_goto_steps(tb.dut), 3, "TEST_LOGIC_RESET -> CAPTURE_DR takes 3 TCK pulses");
+    uint32_t idcode = 0;
+    for (int i = 0; i < 32; i++) {
+        int tdo = 0;
+        tb.send_oscan1_packet(0, (i == 31) ? 1 : 0, &tdo);
+        idcode |= (uint32_t)tdo << i;
+    }
+    ASSERT_EQ(idcode, 0x1DEAD3FF, "IDCODE should read correctly after a GOTO");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_EXIT1_DR, "Last bit should leave SHIFT_DR");
+
+    tb.send_goto_frame(TAP_RUN_TEST_IDLE);  // Exit1 -> Update -> Idle
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "GOTO should update and return to RUN_TEST_IDLE");
+    ASSERT_EQ(probe_goto_steps(tb.dut), 2, "Exit1 -> Idle takes 2 TCK pulses");
+}
+
+TEST_CASE(goto_reset_ignores_mirror) {
+    // Move the TAP behind the bridge's back on the direct 4-wire path: GOTO
+    // Test-Logic-Reset still gets there with 5 x TMS=1 and resyncs the mirror
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    tb.send_goto_frame(TAP_RUN_TEST_IDLE);
+
+    tb.dut->jtag_sel_i = 1;
+    static const int to_shift_ir[4] = {1, 1, 0, 0};  // Idle -> SelDR -> SelIR -> CapIR -> ShiftIR
+    for (int tms : to_shift_ir) tb.jtag_clock_bit(tms, 0);
+    for (int i = 0; i < 10; i++) tb.tick();
+    tb.dut->jtag_sel_i = 0;
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_SHIFT_IR, "Direct path should have moved the TAP");
+    ASSERT_EQ(probe_tap_mirror(tb.dut), TAP_RUN_TEST_IDLE, "Mirror cannot see the direct path");
+
+    tb.send_goto_frame(TAP_TEST_LOGIC_RESET);
+    ASSERT_EQ(probe_goto_steps(tb.dut), 5, "Reset target should always take 5 TCK pulses");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_TEST_LOGIC_RESET, "TAP should be in TEST_LOGIC_RESET");
+    ASSERT_EQ(probe_tap_mirror(tb.dut), TAP_TEST_LOGIC_RESET, "Mirror should be back in sync");
+}
+
+TEST_CASE(goto_rtck_waits_for_walk) {
+    // rtck_o is held back until the walk is over, so an RTCK-paced host
+    // needs no fixed hold time after the last frame bit
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+
+    for (int i = 0; i < 3; i++) {
+        tb.dut->tmsc_i = !tb.dut->tmsc_i;
+        for (int t = 0; t < 10; t++) tb.tick();
+    }
+    const int target = TAP_PAUSE_IR;  // 6 steps from TEST_LOGIC_RESET
+    static const int frame_bit[6] = {0, -1, 1, 2, -1, 3};
+    bool ok = true;
+    for (int i = 0; i < 6; i++) {
+        const int v = frame_bit[i] < 0 ? 0 : (target >> frame_bit[i]) & 1;
+        ok &= tb.tckc_edge_rtck(0, v);
+        if (i < 5) ok &= tb.tckc_edge_rtck(1, v);
+    }
+    ASSERT_TRUE(ok, "rtck_o should acknowledge every frame edge");
+
+    // Last rising edge: the acknowledgement waits for the 6 TCK pulses
+    tb.dut->tckc_i = 1;
+    bool walked = false;
+    const bool acked = tb.wait_until([&] {
+        walked |= probe_goto_count(tb.dut) == 6;
+        return tb.dut->rtck_o == 1;
+    }, 200);
+    ASSERT_TRUE(acked && walked, "rtck_o should rise once the walk has run");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "rtck_o should rise only after the walk");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_PAUSE_IR, "TAP should be in PAUSE_IR");
+
+    int tdo = 0;
+    ASSERT_TRUE(tb.send_oscan1_packet_rtck(0, 1, &tdo), "Packets should continue after the walk");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_EXIT2_IR, "Next packet should clock the TAP from PAUSE_IR");
+}
+
+TEST_CASE(goto_frame_ignored_without_ec9) {
+    // With EC=0x8 a 3-toggle escape is not a frame: the bits read as two
+    // packets with TMS=0, so the TAP only walks TEST_LOGIC_RESET -> RUN_TEST_IDLE
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence();
+
+    bool entered_goto = false;
+    for (int i = 0; i < 3; i++) {
+        tb.dut->tmsc_i = !tb.dut->tmsc_i;
+        for (int t = 0; t < 10; t++) tb.tick();
+    }
+    static const int frame[6] = {1, 0, 0, 1, 0, 1};  // target SHIFT_IR
+    for (int i = 0; i < 6; i++) {
+        tb.tckc_cycle(frame[i]);
+        entered_goto |= probe_bridge_state(tb.dut) == BRIDGE_GOTO;
+    }
+
+    ASSERT_TRUE(!entered_goto, "EC=0x8 should never enter GOTO");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Bridge should stay in OSCAN1");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "Missed frame should read as TMS=0 packets");
+}
+
+// =============================================================================
+// DR Polling (VCMD_POLL, EC=0x9)
+// =============================================================================
+
+static void poll_dmstatus_setup(TestHarness& tb) {
+    // EC=0x9 link, IR = DMI, then one hand-clocked DMI read of dmstatus
+    // (address 0x11) from RUN_TEST_IDLE: the DR scan the engine replays
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet(0, 1, nullptr);  // -> TEST_LOGIC_RESET
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_IR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_IR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> SHIFT_IR
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet((0x11 >> i) & 1, i == 4, nullptr);
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_IR -> UPDATE_IR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+
+    const uint64_t dmi_read = (0x11ULL << 34) | 1ULL;
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> SHIFT_DR
+    for (int i = 0; i < 40; i++) tb.send_oscan1_packet((dmi_read >> i) & 1, i == 39, nullptr);
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_DR -> UPDATE_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+}
+
+TEST_CASE(poll_matches_first_scan) {
+    // Wait for dmstatus.allhalted (bit 10, DMI DR bit 12): already set, so
+    // the first replayed scan matches and the frame returns its data
+    poll_dmstatus_setup(tb);
+    ASSERT_EQ(probe_scan_len(tb.dut), 40, "Bridge should have recorded the 40-bit DMI scan");
+    ASSERT_EQ(probe_scan_tdi(tb.dut), (0x11ULL << 34) | 1ULL, "Recorded TDI should be the DMI read");
+
+    int tcks = 0;
+    const uint64_t resp = tb.send_poll_frame(1u << 10, 1u << 10, 2, 0, 8, &tcks);
+    ASSERT_EQ(resp >> 32, 1, "First scan should match");
+    ASSERT_EQ(resp & 0xFFFFFFFF, 0x00180703, "TDO window should be the dmstatus data field");
+    ASSERT_EQ(tcks, 45, "Idle -> Capture-DR, 40 shifts, Update -> Idle is 45 TCKs");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Frame should return to OSCAN1");
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Frame should end on a packet boundary");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "Engine should leave the TAP in RUN_TEST_IDLE");
+    ASSERT_EQ(probe_tap_mirror(tb.dut), TAP_RUN_TEST_IDLE, "Mirror should agree with the TAP");
+    ASSERT_EQ(probe_poll_phase(tb.dut), POLL_OFF, "Engine should be idle after the frame");
+}
+
+TEST_CASE(poll_stops_at_limit) {
+    // dmstatus.allrunning (bit 11) never sets: `limit` scans with
+    // `interval` idle TCKs between them, and the last window is returned
+    poll_dmstatus_setup(tb);
+
+    int tcks = 0;
+    const uint64_t resp = tb.send_poll_frame(1u << 11, 1u << 11, 2, 5, 3, &tcks);
+    ASSERT_EQ(resp >> 32, 3, "Poll should give up after `limit` scans");
+    ASSERT_EQ(resp & 0xFFFFFFFF, 0x00180703, "TDO window should hold the last scan");
+    ASSERT_EQ(tcks, 3 * 45 + 2 * 5, "Each scan is 45 TCKs, with 5 idle TCKs between scans");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "Engine should leave the TAP in RUN_TEST_IDLE");
+
+    // The link carries on: the same DMI read by hand
+    int tdo = 0;
+    uint64_t dmi = 0;
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    for (int i = 0; i < 40; i++) {
+        tb.send_oscan1_packet(0, i == 39, &tdo);
+        dmi |= (uint64_t)tdo << i;
+    }
+    ASSERT_EQ((dmi >> 2) & 0xFFFFFFFF, 0x00180703, "Packets should read dmstatus after the poll");
+}
+
+TEST_CASE(poll_needs_replayable_scan) {
+    // No DR scan since activation, or one longer than 64 bits: nothing to
+    // replay, so the frame answers 0 scans without clocking the TAP
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+
+    int tcks = -1;
+    uint64_t resp = tb.send_poll_frame(0, 0, 0, 0, 4, &tcks);
+    ASSERT_EQ(resp, 0, "No recorded scan should answer 0 scans");
+    ASSERT_EQ(tcks, 0, "No recorded scan should issue no TCK");
+
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> SHIFT_DR
+    for (int i = 0; i < 70; i++) tb.send_oscan1_packet(i & 1, i == 69, nullptr);
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_DR -> UPDATE_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+    ASSERT_EQ(probe_scan_len(tb.dut), 65, "Over-long scan should be marked unreplayable");
+
+    resp = tb.send_poll_frame(0, 0, 0, 0, 4, &tcks);
+    ASSERT_EQ(resp, 0, "Over-long scan should answer 0 scans");
+    ASSERT_EQ(tcks, 0, "Over-long scan should issue no TCK");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "TAP should not have moved");
+}
+
+// =============================================================================
+// TDO Verification (VCMD_VERIFY_ON / VCMD_VERIFY_END, EC=0x9)
+// =============================================================================
+
+static void verify_capture_dr_setup(TestHarness& tb) {
+    // EC=0x9 link, TAP in CAPTURE_DR with IDCODE selected (after reset)
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet(0, 1, nullptr);  // -> TEST_LOGIC_RESET
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+}
+
+// Checks 32 IDCODE bits against `expected`, bit i masked in by `mask`:
+// packet 0 is CAPTURE_DR -> SHIFT_DR, the last one leaves SHIFT_DR
+static bool verify_idcode(TestHarness& tb, uint32_t expected, uint32_t mask) {
+    bool host_owned = true;
+    for (int i = 0; i < 32; i++) {
+        host_owned &= tb.send_verify_packet(0, i == 31, (expected >> i) & 1, (mask >> i) & 1);
+    }
+    return host_owned;
+}
+
+TEST_CASE(verify_idcode_matches) {
+    // The bridge compares IDCODE against the host's expected bits itself:
+    // TMSC never turns around, and VERIFY_END reports 32 clean packets
+    verify_capture_dr_setup(tb);
+    tb.send_vendor_frame(0x08, 0);
+    ASSERT_EQ(probe_verify_en(tb.dut), 1, "VERIFY_ON should start a verify session");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Frame should return to OSCAN1");
+
+    ASSERT_TRUE(verify_idcode(tb, 0x1DEAD3FF, 0xFFFFFFFF), "Bridge should never drive TMSC in a verify packet");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_EXIT1_DR, "Last bit should leave SHIFT_DR");
+    ASSERT_EQ(probe_verify_count(tb.dut), 32, "Each packet should be counted");
+
+    const uint64_t resp = tb.send_vendor_frame(0x0C, 33);
+    ASSERT_EQ(resp >> 32, 0, "Matching IDCODE should not flag a mismatch");
+    ASSERT_EQ((resp >> 16) & 0xFFFF, 32, "VERIFY_END should report 32 packets");
+    ASSERT_EQ(resp & 0xFFFF, 0, "No mismatch index without a mismatch");
+    ASSERT_EQ(probe_verify_en(tb.dut), 0, "VERIFY_END should end the session");
+
+    // Back to 3-slot packets with TDO on TMSC
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_DR -> UPDATE_DR
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Packets should be 3 slots again");
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_UPDATE_DR, "TAP should follow plain packets");
+}
+
+TEST_CASE(verify_reports_first_mismatch) {
+    // Expected bits 5 and 20 wrong: the flag is sticky and the index points
+    // at the first one; a cleared mask bit skips the compare
+    verify_capture_dr_setup(tb);
+    tb.send_vendor_frame(0x08, 0);
+    verify_idcode(tb, 0x1DEAD3FF ^ (1u << 5) ^ (1u << 20), 0xFFFFFFFF);
+    uint64_t resp = tb.send_vendor_frame(0x0C, 33);
+    ASSERT_EQ(resp >> 32, 1, "Wrong expected bits should flag a mismatch");
+    ASSERT_EQ((resp >> 16) & 0xFFFF, 32, "Mismatches should not stop the count");
+    ASSERT_EQ(resp & 0xFFFF, 5, "Index should point at the first mismatch");
+
+    // Same again with bit 5 masked out, from a fresh capture
+    tb.send_oscan1_packet(0, 1, nullptr); // EXIT1_DR -> UPDATE_DR
+    tb.send_oscan1_packet(0, 1, nullptr); // -> SELECT_DR
+    tb.send_oscan1_packet(0, 0, nullptr); // -> CAPTURE_DR
+    tb.send_vendor_frame(0x08, 0);
+    ASSERT_EQ(probe_verify_fail(tb.dut), 0, "VERIFY_ON should clear the mismatch flag");
+    verify_idcode(tb, 0x1DEAD3FF ^ (1u << 5) ^ (1u << 20), ~(1u << 5));
+    resp = tb.send_vendor_frame(0x0C, 33);
+    ASSERT_EQ(resp >> 32, 1, "Unmasked wrong bit should still flag a mismatch");
+    ASSERT_EQ(resp & 0xFFFF, 20, "Masked-out bit should not be compared");
+}
+
+TEST_CASE(verify_session_ends_offline) {
+    // Deselecting mid-session drops back to 3-slot packets on the next
+    // activation
+    verify_capture_dr_setup(tb);
+    tb.send_vendor_frame(0x08, 0);
+    tb.send_verify_packet(0, 0, 1, 1);
+    ASSERT_EQ(probe_verify_fail(tb.dut), 0, "IDCODE bit 0 is 1");
+    tb.send_escape_sequence(4);
+    for (int i = 0; i < 10; i++) tb.tick();  // OFFLINE clears the session on its first cycle
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OFFLINE, "4 toggles should deselect");
+    ASSERT_EQ(probe_verify_en(tb.dut), 0, "Going offline should end the session");
+
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    int tdo = 0;
+    tb.send_oscan1_packet(0, 0, &tdo); // SHIFT_DR, reads IDCODE bit 1
+    ASSERT_EQ(probe_bit_pos(tb.dut), 0, "Packets should be 3 slots after reactivation");
+    ASSERT_EQ(tdo, 1, "TDO should be driven on TMSC again");
+}
+
+// =============================================================================
+// Link Loopback (VCMD_LOOP_ECHO / VCMD_LOOP_PRBS / VCMD_LOOP_END, EC=0x9)
+// =============================================================================
+
+static void loop_rti_setup(TestHarness& tb) {
+    // EC=0x9 link, TAP in RUN_TEST_IDLE
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    for (int i = 0; i < 5; i++) tb.send_oscan1_packet(0, 1, nullptr);  // -> TEST_LOGIC_RESET
+    tb.send_oscan1_packet(0, 0, nullptr); // -> RUN_TEST_IDLE
+}
+
+TEST_CASE(loop_echo_returns_ntdi) {
+    // ECHO: every TDO slot returns the raw nTDI bit of its packet and the TAP
+    // clock stays parked, even with TMS=1
+    loop_rti_setup(tb);
+    tb.send_vendor_frame(0x20, 0);
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_ECHO, "LOOP_ECHO should start a loopback session");
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OSCAN1, "Frame should return to OSCAN1");
+
+    const uint32_t pattern = 0xA5C3961E;
+    for (int i = 0; i < 32; i++) {
+        const int tdi = (pattern >> i) & 1;
+        int tdo = -1;
+        tb.send_oscan1_packet(tdi, 1, &tdo);
+        ASSERT_EQ(tdo, !tdi, "TDO slot should echo the nTDI bit");
+    }
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_RUN_TEST_IDLE, "TMS=1 packets should not clock the TAP");
+    ASSERT_EQ(probe_loop_count(tb.dut), 32, "Each packet should be counted");
+
+    const uint64_t resp = tb.send_vendor_frame(0x24, 40);
+    ASSERT_EQ(resp & 0xFFFFFF, 32, "LOOP_END should report 32 packets");
+    ASSERT_EQ(resp >> 24, 0, "ECHO mode counts no errors");
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_OFF, "LOOP_END should end the session");
+
+    tb.send_oscan1_packet(0, 1, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_SELECT_DR_SCAN, "Plain packets should clock the TAP again");
+}
+
+TEST_CASE(loop_prbs_counts_errors) {
+    // PRBS: TDO slots carry the PRBS-15 whatever the host sends, and the
+    // bridge counts the nTDI slots that miss it (three flipped here)
+    loop_rti_setup(tb);
+    tb.send_vendor_frame(0x21, 0);
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_PRBS, "LOOP_PRBS should start a loopback session");
+    ASSERT_EQ(probe_loop_prbs(tb.dut), 0x7FFF, "PRBS should start from all ones");
+
+    uint16_t lfsr = 0x7FFF;
+    for (int i = 0; i < 100; i++) {
+        const int bit = prbs15_next(lfsr);
+        const int ntdi = bit ^ (i == 7 || i == 50 || i == 99);
+        int tdo = -1;
+        tb.send_oscan1_packet(!ntdi, 0, &tdo);
+        ASSERT_EQ(tdo, bit, "TDO slot should carry the PRBS");
+    }
+    ASSERT_EQ(probe_loop_errors(tb.dut), 3, "Flipped nTDI bits should be counted");
+
+    const uint64_t resp = tb.send_vendor_frame(0x24, 40);
+    ASSERT_EQ(resp & 0xFFFFFF, 100, "LOOP_END should report 100 packets");
+    ASSERT_EQ(resp >> 24, 3, "LOOP_END should report 3 errors");
+
+    // TDO is the TAP's again: SELECT_DR, CAPTURE_DR, SHIFT_DR reads IDCODE bit 0
+    int tdo = -1;
+    tb.send_oscan1_packet(0, 1, nullptr);
+    tb.send_oscan1_packet(0, 0, nullptr);
+    tb.send_oscan1_packet(0, 0, &tdo);
+    ASSERT_EQ(tdo, 1, "TDO should come from the TAP after LOOP_END");
+}
+
+TEST_CASE(loop_session_ends_on_verify_and_offline) {
+    // VERIFY_ON and LOOP_* end each other's session; deselecting ends both
+    loop_rti_setup(tb);
+    tb.send_vendor_frame(0x21, 0);
+    tb.send_vendor_frame(0x08, 0);
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_OFF, "VERIFY_ON should end the loopback session");
+    ASSERT_EQ(probe_verify_en(tb.dut), 1, "VERIFY_ON should start a verify session");
+
+    tb.send_vendor_frame(0x20, 0);
+    ASSERT_EQ(probe_verify_en(tb.dut), 0, "LOOP_ECHO should end the verify session");
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_ECHO, "LOOP_ECHO should start a loopback session");
+
+    tb.send_escape_sequence(4);
+    for (int i = 0; i < 10; i++) tb.tick();  // OFFLINE clears the session on its first cycle
+    ASSERT_EQ(probe_bridge_state(tb.dut), BRIDGE_OFFLINE, "4 toggles should deselect");
+    ASSERT_EQ(probe_loop_mode(tb.dut), LOOP_OFF, "Going offline should end the session");
+
+    tb.send_escape_sequence(6);
+    tb.send_oac_sequence(0x9);
+    tb.send_oscan1_packet(0, 1, nullptr);
+    ASSERT_EQ(probe_tap_state(tb.dut), TAP_SELECT_DR_SCAN, "TAP should be clocked after reactivation");
+}
+
 // =============================================================================
 // Main Test Runner
 // =============================================================================
@@ -4438,9 +5445,14 @@ int main(int argc, char** argv) {
             printf("Tracing enabled: cjtag.fst\n\n");
         }
     }
+    g_trace_all = trace;
+
+    // Runtime log categories (+log=SPEC / CJTAG_LOG=SPEC); tail is dumped on failure
+    cjtag_log_init(argc, argv);
 
     // Create global test harness with tracing enabled
     g_tb = new TestHarness(trace);
+    cjtag_log_set_clock(&g_tb->time);
 
     // Run all tests
     RUN_TEST(reset_state);
@@ -4600,14 +5612,16 @@ int main(int argc, char** argv) {
     RUN_TEST(ieee1149_7_selection_sequence);
     RUN_TEST(oac_ec_cp_field_values);
     RUN_TEST(cp_validation_all_bits_correct);
-    // DISABLED: CP validation no longer enforced for ftdi.c compatibility
-    // RUN_TEST(cp_validation_single_bit_errors);
-    // RUN_TEST(cp_validation_multiple_bit_errors);
     RUN_TEST(cp_validation_with_wrong_ec);  // Still validates EC field
-    // RUN_TEST(cp_validation_all_zeros);
-    // RUN_TEST(cp_validation_all_ones);
     RUN_TEST(cp_xor_calculation_verification);  // Math verification only
-    // RUN_TEST(cp_validation_stress_test);
+#ifdef CJTAG_STRICT_CP_CHECK
+    // CP enforced only in the strict build (make test-strict-cp)
+    RUN_TEST(cp_validation_single_bit_errors);
+    RUN_TEST(cp_validation_multiple_bit_errors);
+    RUN_TEST(cp_validation_all_zeros);
+    RUN_TEST(cp_validation_all_ones);
+    RUN_TEST(cp_validation_stress_test);
+#endif
     RUN_TEST(oscan1_format_compliance);
 
     // Debug Module Tests
@@ -4644,14 +5658,66 @@ int main(int argc, char** argv) {
     RUN_TEST(debug_module_all_registers);
     RUN_TEST(dmi_stress_test_100_operations);
 
+    // Internal-State Probes
+    RUN_TEST(probe_escape_toggle_count);
+    RUN_TEST(probe_activation_count_and_tap_ir);
+
+    // Direct 4-wire JTAG Path
+    RUN_TEST(direct_jtag_idcode_matches_oscan1);
+
+    // Adaptive Clocking (RTCK)
+    RUN_TEST(rtck_follows_tckc_when_offline);
+    RUN_TEST(rtck_paced_idcode_read);
+
+    // Vendor Frames & Link CRC
+    RUN_TEST(vendor_crc_read_matches_host_crc);
+    RUN_TEST(vendor_crc_detects_corrupted_tdi);
+    RUN_TEST(vendor_frame_ignored_without_ec9);
+
+    // Context Retention
+    RUN_TEST(context_resume_skips_activation);
+    RUN_TEST(context_not_retained_without_opt_in);
+    RUN_TEST(context_discarded_by_reset_and_full_select);
+    RUN_TEST(context_resume_restores_vendor_extensions);
+
+    // TAP Navigation
+    RUN_TEST(goto_mirror_tracks_tap);
+    RUN_TEST(goto_reaches_every_state);
+    RUN_TEST(goto_idcode_read);
+    RUN_TEST(goto_reset_ignores_mirror);
+    RUN_TEST(goto_rtck_waits_for_walk);
+    RUN_TEST(goto_frame_ignored_without_ec9);
+
+    // DR Polling
+    RUN_TEST(poll_matches_first_scan);
+    RUN_TEST(poll_stops_at_limit);
+    RUN_TEST(poll_needs_replayable_scan);
+
+    // TDO Verification
+    RUN_TEST(verify_idcode_matches);
+    RUN_TEST(verify_reports_first_mismatch);
+    RUN_TEST(verify_session_ends_offline);
+
+    // Link Loopback
+    RUN_TEST(loop_echo_returns_ntdi);
+    RUN_TEST(loop_prbs_counts_errors);
+    RUN_TEST(loop_session_ends_on_verify_and_offline);
+
     printf("\n========================================\n");
-    printf("Test Results: %d tests passed\n", tests_passed);
-    printf("========================================\n");
-    printf("✅ ALL TESTS PASSED!\n");
+    if (!g_failed.empty()) {
+        printf("Test Results: %d tests passed, %d failed\n", tests_passed, (int)g_failed.size());
+        printf("========================================\n");
+        for (const std::string& f : g_failed) printf("  FAILED: %s\n", f.c_str());
+        printf("❌ %d TEST(S) FAILED\n", (int)g_failed.size());
+    } else {
+        printf("Test Results: %d tests passed\n", tests_passed);
+        printf("========================================\n");
+        printf("✅ ALL TESTS PASSED!\n");
+    }
 
     // Cleanup
     delete g_tb;
     g_tb = nullptr;
 
-    return 0;
+    return g_failed.empty() ? 0 : 1;
 }
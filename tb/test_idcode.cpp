@@ -1,5 +1,6 @@
 // Simple IDCODE test - direct copy of working test_cjtag logic
 #include "Vtop.h"
+#include "cjtag_log.h"
 #include "verilated.h"
 #include "verilated_fst_c.h"
 #include <stdio.h>
@@ -31,6 +32,7 @@ public:
         dut->ntrst_i = 0;
         dut->tckc_i = 0;
         dut->tmsc_i = 1;
+        dut->jtag_sel_i = 0;  // TAP driven by the bridge
 
         // Run system clock during reset
         for (int i = 0; i < 100; i++) {
@@ -167,9 +169,10 @@ int main(int argc, char** argv) {
     const char* iter_env = getenv("IDCODE_ITERATIONS");
     int iterations = iter_env ? atoi(iter_env) : 100;  // Default: 100 iterations
 
-    if (argc > 1) {
+    if (argc > 1 && argv[1][0] != '+' && argv[1][0] != '-') {
         iterations = atoi(argv[1]);
     }
+    cjtag_log_init(argc, argv);
 
     printf("========================================\n");
     printf("JTAG IDCODE Stress Test via cJTAG Bridge\n");
@@ -177,6 +180,7 @@ int main(int argc, char** argv) {
     printf("========================================\n\n");
 
     TestHarness tb;
+    cjtag_log_set_clock(&tb.time);
 
     // Go online first
     printf("Sending escape sequence...\n");
@@ -195,6 +199,7 @@ int main(int argc, char** argv) {
     printf("online_o: %d\n", tb.dut->online_o);
     if (!tb.dut->online_o) {
         printf("❌ ERROR: Bridge did not go online after OAC!\n");
+        cjtag_log_dump_tail(stdout);
         return 1;
     }
 
@@ -227,6 +232,7 @@ int main(int argc, char** argv) {
         return 0;
     } else {
         printf("❌ FAILURE: %d iterations failed\n", failures);
+        cjtag_log_dump_tail(stdout);
         return 1;
     }
 }
@@ -0,0 +1,376 @@
+// =============================================================================
+// la2stim - Convert Logic-Analyser Captures of TCKC/TMSC to .stim
+// =============================================================================
+// Reads a capture of the two cJTAG wires taken with a real probe and writes
+// the harness replay format (.stim, see tb/sim_kernel.h) for
+// tb/replay_cjtag.cpp.
+//
+// Inputs:
+//   VCD         from PulseView "Export -> VCD", sigrok-cli -O vcd, or any
+//               simulator/LA that writes VCD
+//   sigrok CSV  from sigrok-cli -O csv (optionally csv:time=true) or the
+//               PulseView CSV export; without a time column the sample rate
+//               comes from the "; Samplerate:" comment or --samplerate
+//   (.sr session files: convert first with
+//    sigrok-cli -i capture.sr -O vcd > capture.vcd)
+//
+// Resampling: every transition is moved onto the clk_i grid used by the
+// replay (--clk-mhz, default 100 MHz), at the middle of the clk_i low phase
+// (3/4 of a period in: the clock rises at t=0 and falls at 1/2) so no pin
+// change coincides with a clk_i edge.  Transitions that land in the same
+// clk_i slot are merged; a pulse that disappears this way could not have
+// been seen by the bridge's synchronizer either, and is counted.
+//
+// Usage: la2stim [options] capture.{vcd,csv} out.stim
+//   --tckc NAME        TCKC channel name (default: first name containing "tck")
+//   --tmsc NAME        TMSC channel name (default: first name containing "tms")
+//   --clk-mhz F        replay clk_i frequency for resampling (default 100)
+//   --scale X          multiply capture times by X (e.g. 0.1 = 10x faster)
+//   --samplerate HZ    CSV sample rate when the file does not state it
+//   --time-unit U      CSV time column unit: s, ms, us, ns, ps (default s)
+// =============================================================================
+
+#include "sim_kernel.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// ─── Options ─────────────────────────────────────────────────────────────────
+struct Options {
+    const char* in          = nullptr;
+    const char* out         = nullptr;
+    std::string tckc_name;
+    std::string tmsc_name;
+    double      clk_mhz     = 100.0;
+    double      scale       = 1.0;
+    double      samplerate  = 0.0;
+    double      csv_unit_ps = 1e12;
+};
+
+// ─── Resampling writer ───────────────────────────────────────────────────────
+// Receives (time_ps, tckc, tmsc) level snapshots in time order, quantizes
+// them onto the clk_i grid and writes only real changes.
+class Resampler {
+public:
+    Resampler(StimWriter& w, double clk_ps, double scale) : w_(w), clk_ps_(clk_ps), scale_(scale) {}
+
+    void level(double t_ps, int tckc, int tmsc) {
+        if (!have_origin_) {
+            origin_ps_   = t_ps;
+            have_origin_ = true;
+        }
+        const double rel  = (t_ps - origin_ps_) * scale_;
+        const sim_ps_t slot = (sim_ps_t)llround(rel / clk_ps_);
+        const sim_ps_t tq   = (sim_ps_t)llround((double)slot * clk_ps_ + clk_ps_ * 0.75);
+
+        if (has_pending_ && tq == pending_.t) {
+            ++merged_;
+            pending_.tckc = (uint8_t)tckc;
+            pending_.tmsc = (uint8_t)tmsc;
+            return;
+        }
+        flush();
+        pending_     = StimEvent{tq, (uint8_t)tckc, (uint8_t)tmsc, 0};
+        has_pending_ = true;
+    }
+
+    void flush() {
+        if (!has_pending_) return;
+        has_pending_ = false;
+        if (has_written_ && pending_.tckc == last_.tckc && pending_.tmsc == last_.tmsc) {
+            ++dropped_;  // pulse narrower than one clk_i period
+            return;
+        }
+        w_.write(pending_);
+        if (has_written_ && pending_.tckc != last_.tckc && pending_.tckc) ++tckc_rises_;
+        last_        = pending_;
+        has_written_ = true;
+        ++written_;
+    }
+
+    uint64_t written() const { return written_; }
+    uint64_t merged() const { return merged_; }
+    uint64_t dropped() const { return dropped_; }
+    uint64_t tckc_rises() const { return tckc_rises_; }
+    sim_ps_t span_ps() const { return last_.t; }
+
+private:
+    StimWriter& w_;
+    double      clk_ps_;
+    double      scale_;
+    double      origin_ps_   = 0.0;
+    bool        have_origin_ = false;
+    StimEvent   pending_     = {};
+    StimEvent   last_        = {};
+    bool        has_pending_ = false;
+    bool        has_written_ = false;
+    uint64_t    written_     = 0;
+    uint64_t    merged_      = 0;
+    uint64_t    dropped_     = 0;
+    uint64_t    tckc_rises_  = 0;
+};
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+static std::string lower(std::string s) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+// Pick a channel: exact (case-insensitive) match on `want`, else the first
+// name containing `hint`.
+static int pick_channel(const std::vector<std::string>& names, const std::string& want, const char* hint) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (!want.empty() && strcasecmp(names[i].c_str(), want.c_str()) == 0) return (int)i;
+    }
+    if (!want.empty()) return -1;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (lower(names[i]).find(hint) != std::string::npos) return (int)i;
+    }
+    return -1;
+}
+
+static double unit_ps(const char* u) {
+    if (strcmp(u, "s") == 0) return 1e12;
+    if (strcmp(u, "ms") == 0) return 1e9;
+    if (strcmp(u, "us") == 0) return 1e6;
+    if (strcmp(u, "ns") == 0) return 1e3;
+    if (strcmp(u, "ps") == 0) return 1.0;
+    if (strcmp(u, "fs") == 0) return 1e-3;
+    return 0.0;
+}
+
+// ─── VCD ─────────────────────────────────────────────────────────────────────
+static bool convert_vcd(FILE* fp, const Options& opt, Resampler& rs) {
+    std::vector<std::string>           names;
+    std::vector<std::string>           ids;
+    double                             ts_ps = 1.0;
+    char                               tok[512];
+
+    // Header: read tokens up to $enddefinitions
+    while (fscanf(fp, "%511s", tok) == 1) {
+        if (strcmp(tok, "$timescale") == 0) {
+            std::string spec;
+            while (fscanf(fp, "%511s", tok) == 1 && strcmp(tok, "$end") != 0) spec += tok;
+            char   unit[8] = "";
+            double mult    = 1.0;
+            if (sscanf(spec.c_str(), "%lf%7s", &mult, unit) == 2) ts_ps = mult * unit_ps(unit);
+        } else if (strcmp(tok, "$var") == 0) {
+            char type[64], width[32], id[64], ref[256];
+            if (fscanf(fp, "%63s %31s %63s %255s", type, width, id, ref) != 4) return false;
+            names.push_back(ref);
+            ids.push_back(id);
+            while (fscanf(fp, "%511s", tok) == 1 && strcmp(tok, "$end") != 0) {}
+        } else if (strcmp(tok, "$enddefinitions") == 0) {
+            while (fscanf(fp, "%511s", tok) == 1 && strcmp(tok, "$end") != 0) {}
+            break;
+        }
+    }
+    if (ts_ps <= 0.0) {
+        fprintf(stderr, "la2stim: unsupported $timescale\n");
+        return false;
+    }
+
+    const int ci = pick_channel(names, opt.tckc_name, "tck");
+    const int mi = pick_channel(names, opt.tmsc_name, "tms");
+    if (ci < 0 || mi < 0 || ci == mi) {
+        fprintf(stderr, "la2stim: cannot find TCKC/TMSC among the VCD signals:");
+        for (const std::string& n : names) fprintf(stderr, " %s", n.c_str());
+        fprintf(stderr, "\n(use --tckc NAME --tmsc NAME)\n");
+        return false;
+    }
+    fprintf(stderr, "la2stim: TCKC = %s, TMSC = %s, timescale %g ps\n", names[ci].c_str(), names[mi].c_str(), ts_ps);
+
+    // Value changes; emit one snapshot per timestamp that touched a channel
+    int    tckc = 1, tmsc = 1;  // cJTAG idle levels until the dump says otherwise
+    double now_ps = 0.0;
+    bool   dirty = false, started = false, emitted = false;
+    while (fscanf(fp, "%511s", tok) == 1) {
+        if (tok[0] == '#') {
+            if (started && (dirty || !emitted)) {
+                rs.level(now_ps, tckc, tmsc);
+                emitted = true;
+            }
+            dirty   = false;
+            started = true;
+            now_ps  = strtod(tok + 1, nullptr) * ts_ps;
+            continue;
+        }
+        if (strcmp(tok, "$comment") == 0) {
+            while (fscanf(fp, "%511s", tok) == 1 && strcmp(tok, "$end") != 0) {}
+            continue;
+        }
+        std::string id;
+        int         v;
+        if (tok[0] == 'b' || tok[0] == 'B') {  // vector form: b<bits> <id>
+            v = tok[strlen(tok) - 1] == '1';
+            char idtok[64];
+            if (fscanf(fp, "%63s", idtok) != 1) break;
+            id = idtok;
+        } else if (strchr("01xXzZ", tok[0])) {
+            v  = tok[0] == '1';
+            id = tok + 1;
+        } else {
+            continue;  // $dumpvars, $end, $comment ...
+        }
+        if (id == ids[ci]) {
+            dirty |= tckc != v;
+            tckc = v;
+        } else if (id == ids[mi]) {
+            dirty |= tmsc != v;
+            tmsc = v;
+        }
+    }
+    if (started && (dirty || !emitted)) rs.level(now_ps, tckc, tmsc);
+    rs.flush();
+    return true;
+}
+
+// ─── sigrok CSV ──────────────────────────────────────────────────────────────
+static bool convert_csv(FILE* fp, const Options& opt, Resampler& rs) {
+    char                     line[4096];
+    double                   rate = opt.samplerate;
+    std::vector<std::string> names;
+    int                      time_col = -1, ci = -1, mi = -1;
+    uint64_t                 sample = 0;
+    int                      last_c = -1, last_m = -1;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == ';') {
+            double v;
+            char   unit[8] = "";
+            const char* p = strstr(line, "Samplerate:");
+            if (p && rate == 0.0 && sscanf(p + 11, "%lf %7s", &v, unit) >= 1) {
+                const double m = unit[0] == 'G' ? 1e9 : unit[0] == 'M' ? 1e6 : unit[0] == 'k' ? 1e3 : 1.0;
+                rate = v * m;
+            }
+            continue;
+        }
+        // Split on commas
+        std::vector<std::string> cols;
+        for (char* tokp = strtok(line, ",\r\n"); tokp; tokp = strtok(nullptr, ",\r\n")) {
+            while (*tokp == ' ') ++tokp;
+            cols.push_back(tokp);
+        }
+        if (cols.empty()) continue;
+
+        if (names.empty()) {
+            if (isalpha((unsigned char)cols[0][0])) {  // header row
+                names = cols;
+            } else {                                  // no header: D0, D1, ...
+                for (size_t i = 0; i < cols.size(); ++i) names.push_back("D" + std::to_string(i));
+            }
+            for (size_t i = 0; i < names.size(); ++i) {
+                const std::string n = lower(names[i]);
+                if (n == "time" || n == "t" || n.find("time") == 0) time_col = (int)i;
+            }
+            std::vector<std::string> chans = names;
+            if (time_col >= 0) chans[time_col] = "";
+            ci = pick_channel(chans, opt.tckc_name, "tck");
+            mi = pick_channel(chans, opt.tmsc_name, "tms");
+            if ((ci < 0 || mi < 0) && opt.tckc_name.empty() && opt.tmsc_name.empty()) {
+                // Fall back to the first two data columns
+                std::vector<int> data;
+                for (size_t i = 0; i < names.size(); ++i) if ((int)i != time_col) data.push_back((int)i);
+                if (data.size() >= 2) {
+                    ci = data[0];
+                    mi = data[1];
+                }
+            }
+            if (ci < 0 || mi < 0 || ci == mi) {
+                fprintf(stderr, "la2stim: cannot find TCKC/TMSC columns (use --tckc NAME --tmsc NAME)\n");
+                return false;
+            }
+            if (time_col < 0 && rate <= 0.0) {
+                fprintf(stderr, "la2stim: CSV has no time column and no sample rate (use --samplerate HZ)\n");
+                return false;
+            }
+            fprintf(stderr, "la2stim: TCKC = %s, TMSC = %s, %s\n", names[ci].c_str(), names[mi].c_str(),
+                    time_col >= 0 ? "time column" : "sample-rate timing");
+            if (isalpha((unsigned char)cols[0][0])) continue;
+        }
+
+        if ((int)cols.size() <= std::max(ci, mi)) continue;
+        const double t_ps = time_col >= 0 && (int)cols.size() > time_col
+                                ? strtod(cols[time_col].c_str(), nullptr) * opt.csv_unit_ps
+                                : (double)sample * 1e12 / rate;
+        ++sample;
+        const int c = atoi(cols[ci].c_str()) != 0;
+        const int m = atoi(cols[mi].c_str()) != 0;
+        if (c != last_c || m != last_m) {
+            rs.level(t_ps, c, m);
+            last_c = c;
+            last_m = m;
+        }
+    }
+    rs.flush();
+    return true;
+}
+
+// ─── Main ────────────────────────────────────────────────────────────────────
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--tckc") == 0 && i + 1 < argc) {
+            opt.tckc_name = argv[++i];
+        } else if (strcmp(argv[i], "--tmsc") == 0 && i + 1 < argc) {
+            opt.tmsc_name = argv[++i];
+        } else if (strcmp(argv[i], "--clk-mhz") == 0 && i + 1 < argc) {
+            opt.clk_mhz = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            opt.scale = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--samplerate") == 0 && i + 1 < argc) {
+            opt.samplerate = strtod(argv[++i], nullptr);
+        } else if (strcmp(argv[i], "--time-unit") == 0 && i + 1 < argc) {
+            opt.csv_unit_ps = unit_ps(argv[++i]);
+        } else if (!opt.in) {
+            opt.in = argv[i];
+        } else if (!opt.out) {
+            opt.out = argv[i];
+        }
+    }
+    if (!opt.in || !opt.out || opt.clk_mhz <= 0.0 || opt.scale <= 0.0 || opt.csv_unit_ps <= 0.0) {
+        fprintf(stderr, "usage: la2stim [--tckc NAME] [--tmsc NAME] [--clk-mhz F] [--scale X]\n"
+                        "               [--samplerate HZ] [--time-unit s|ms|us|ns|ps] capture.{vcd,csv} out.stim\n");
+        return 1;
+    }
+
+    FILE* fp = fopen(opt.in, "r");
+    if (!fp) {
+        fprintf(stderr, "la2stim: cannot open %s\n", opt.in);
+        return 1;
+    }
+    StimWriter w;
+    char note[512];
+    snprintf(note, sizeof(note), "la2stim: %s, resampled to clk_i %.3f MHz, time scale %g", opt.in, opt.clk_mhz,
+             opt.scale);
+    if (!w.open(opt.out, note)) {
+        fprintf(stderr, "la2stim: cannot create %s\n", opt.out);
+        fclose(fp);
+        return 1;
+    }
+
+    Resampler rs(w, 1e6 / opt.clk_mhz, opt.scale);
+    const char* ext = strrchr(opt.in, '.');
+    const bool  csv = ext && strcasecmp(ext, ".csv") == 0;
+    const bool  ok  = csv ? convert_csv(fp, opt, rs) : convert_vcd(fp, opt, rs);
+    fclose(fp);
+    if (!w.close() || !ok) return 1;
+
+    fprintf(stderr, "la2stim: %llu events, %llu TCKC cycles, %.3f ms of traffic -> %s\n",
+            (unsigned long long)rs.written(), (unsigned long long)rs.tckc_rises(), (double)rs.span_ps() / 1e9,
+            opt.out);
+    if (rs.merged() || rs.dropped()) {
+        fprintf(stderr, "la2stim: %llu transitions merged into one clk_i slot, %llu pulses narrower than a "
+                        "clk_i period dropped\n",
+                (unsigned long long)rs.merged(), (unsigned long long)rs.dropped());
+    }
+    return 0;
+}
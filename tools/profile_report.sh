@@ -0,0 +1,95 @@
+#!/usr/bin/env bash
+# =============================================================================
+# Profile Report for `make profile`
+# =============================================================================
+# Usage: tools/profile_report.sh PROFILE_DIR
+#
+# Each run directory under PROFILE_DIR (suite/, vpi/) holds the profiled
+# binary's gmon.out and Verilator's profile_exec.dat, and optionally a
+# perf.data recorded with frame-pointer call graphs.  For each run this
+# writes gprof.txt, cfuncs.txt (verilator_profcfunc, time per RTL
+# statement) and gantt.txt (verilator_gantt, time per model thread), then
+# prints a flat-profile breakdown by category:
+#
+#   rtl:<module>  model code, attributed to the Verilog module (--prof-cfuncs)
+#   rtl:eval      scheduler / eval glue generated by Verilator
+#   trace         FST/VCD dump code
+#   verilated     Verilator runtime library
+#   harness       testbench C++ (everything else)
+#
+# The VPI run is a --replay, which never touches the socket, so TCP I/O
+# does not show up here; profile a live test-openocd session for that.
+# =============================================================================
+
+set -u
+
+DIR=${1:?usage: $0 PROFILE_DIR}
+
+# Reads "percent symbol" lines, prints percentage per category.
+categorize() {
+    awk '
+    {
+        pct = $1; $1 = ""; name = $0
+        if      (name ~ /__PROF__/)                                   { m = name; sub(/.*__PROF__/, "", m); sub(/__l[0-9]+.*/, "", m); cat = "rtl:" m }
+        else if (name ~ /trace|Fst|fst|Vcd|vcd/)                      { cat = "trace" }
+        else if (name ~ /Verilated|VlThread|VlMT|VlDeleter|vl_/)      { cat = "verilated" }
+        else if (name ~ /Vtop/)                                       { cat = "rtl:eval" }
+        else                                                          { cat = "harness" }
+        sum[cat] += pct; total += pct
+    }
+    END {
+        for (c in sum) printf "  %-24s %6.1f%%\n", c, (total > 0 ? 100.0 * sum[c] / total : 0)
+    }' | sort -k2 -rn
+}
+
+# gprof flat profile rows -> "percent symbol" (symbols may contain spaces).
+flat_profile() {
+    awk '/^Flat profile/ { f = 1; next }
+         /^Call graph/   { f = 0 }
+         f && /^ *[0-9.]+ +[0-9.]+ +[0-9.]+ / {
+             pct = $1
+             sub(/^ *[0-9.]+ +[0-9.]+ +[0-9.]+ +([0-9]+ +[0-9.]+ +[0-9.]+ +)?/, "")
+             print pct, $0
+         }' "$1"
+}
+
+for run in "$DIR"/*/; do
+    run=${run%/}
+    name=$(basename "$run")
+    bin=$(find "$run" -maxdepth 1 -type f -perm -u+x | head -n 1)
+    [ -n "$bin" ] || continue
+
+    echo "=========================================="
+    echo "Profile: $name ($(basename "$bin"))"
+    echo "=========================================="
+
+    if [ -f "$run/gmon.out" ]; then
+        gprof -b "$bin" "$run/gmon.out" > "$run/gprof.txt" 2>/dev/null
+        if command -v verilator_profcfunc > /dev/null; then
+            verilator_profcfunc "$run/gprof.txt" > "$run/cfuncs.txt" 2>/dev/null
+        fi
+        echo "CPU time by category (gprof, executable code only):"
+        flat_profile "$run/gprof.txt" | categorize
+        echo ""
+        echo "Top functions:"
+        flat_profile "$run/gprof.txt" | head -n 15 | awk '{ p = $1; $1 = ""; printf "  %6s%% %s\n", p, $0 }'
+        echo ""
+    fi
+
+    if [ -f "$run/perf.data" ] && command -v perf > /dev/null; then
+        echo "Wall-clock samples by category (perf, incl. libc/kernel):"
+        perf report -i "$run/perf.data" --no-children --sort sym --stdio 2>/dev/null |
+            awk '/^ *[0-9.]+%/ { p = $1; sub(/%/, "", p); $1 = ""; $2 = ""; print p, $0 }' | categorize
+        echo ""
+    fi
+
+    if [ -f "$run/profile_exec.dat" ] && command -v verilator_gantt > /dev/null; then
+        (cd "$run" && verilator_gantt --no-vcd profile_exec.dat > gantt.txt 2>&1)
+        echo "Model threads (verilator_gantt):"
+        sed -n '1,25s/^/  /p' "$run/gantt.txt"
+        echo ""
+    fi
+
+    echo "Details: $run/{gprof,cfuncs,gantt}.txt"
+    echo ""
+done